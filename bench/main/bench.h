@@ -0,0 +1,80 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include <sdkconfig.h>
+#endif
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#else
+#include <esp_cpu.h>
+#include <esp_timer.h>
+#endif
+
+#define BENCH_ITERATIONS 200  // Timed runs per measurement
+#define BENCH_FRAME_MS 20     // Frame length used for per-frame figures
+
+// Free-running counter for timing: CPU cycles on target and x86 hosts,
+// nanoseconds elsewhere (see BENCH_UNIT). Differences are taken with
+// bench_elapsed so the 32-bit target counter may wrap between samples
+#if CONFIG_IDF_TARGET_LINUX && !(defined(__x86_64__) || defined(__i386__))
+#define BENCH_UNIT "ns"
+static inline uint64_t bench_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline uint64_t bench_elapsed(uint64_t start) {
+  return bench_now() - start;
+}
+#elif CONFIG_IDF_TARGET_LINUX
+#define BENCH_UNIT "cycles"
+static inline uint64_t bench_now() {
+  return __rdtsc();
+}
+
+static inline uint64_t bench_elapsed(uint64_t start) {
+  return bench_now() - start;
+}
+#else
+#define BENCH_UNIT "cycles"
+static inline uint64_t bench_now() {
+  return esp_cpu_get_cycle_count();
+}
+
+static inline uint64_t bench_elapsed(uint64_t start) {
+  return (uint32_t)(esp_cpu_get_cycle_count() - (uint32_t)start);
+}
+#endif
+
+// Wall clock in microseconds, for figures relative to real time
+static inline int64_t bench_us() {
+#if CONFIG_IDF_TARGET_LINUX
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+  return esp_timer_get_time();
+#endif
+}
+
+void bench_pcm();
+void bench_aec();
+void bench_rate();
+void bench_signaling();
+void bench_events();
+void bench_mem();
+void bench_resample();
+void bench_dsp();
+void bench_ns();
+void bench_kws();
+void bench_codec();
+
+#endif  // BENCH_H
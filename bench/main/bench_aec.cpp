@@ -0,0 +1,166 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aec.h"
+#include "bench.h"
+#include "pcm.h"
+#include "synth.h"
+#include "wav.h"
+
+// Echo canceller benchmark, run on a recording or a simulated room:
+//   AEC_MIC  microphone recording containing speaker echo (16-bit WAV)
+//   AEC_REF  far-end audio as written to the speaker, sample-aligned with
+//            AEC_MIC (a constant offset is fine, the AEC estimates it)
+//   AEC_OUT  optional WAV receiving the echo-cancelled microphone signal
+// ERLE is measured on frames where only the far end is active; recordings
+// should not contain near-end speech while the far end talks
+#define AEC_BENCH_RATE 8000        // Simulated room sample rate
+#define AEC_BENCH_SECONDS 20       // Simulated room length
+#define AEC_BENCH_ECHO_DELAY_MS 70  // Speaker-to-microphone bulk delay
+#define AEC_BENCH_TAIL_MS 30        // Simulated room impulse response length
+#define AEC_BENCH_FAR_LEVEL 100     // Reference RMS that counts as active
+
+// Near-end talk in the simulated room, left out of the ERLE figures
+static size_t near_start = 0;
+static size_t near_end = 0;
+
+// Far end talking through a simulated speaker and room with a quiet
+// near-end noise floor, plus one second of double talk at 3/4 of the run
+static void synth_room(WavAudio* mic, WavAudio* ref) {
+  uint32_t rate = AEC_BENCH_RATE;
+  size_t count = rate * AEC_BENCH_SECONDS;
+  mic->samples = (int16_t*)calloc(count, sizeof(int16_t));
+  ref->samples = (int16_t*)calloc(count, sizeof(int16_t));
+  mic->count = ref->count = count;
+  mic->sample_rate = ref->sample_rate = rate;
+  synth_seed(1);
+  synth_speech(ref->samples, count, rate, 6000);
+
+  size_t delay = rate * AEC_BENCH_ECHO_DELAY_MS / 1000;
+  size_t tail = rate * AEC_BENCH_TAIL_MS / 1000;
+  float* ir = (float*)malloc(tail * sizeof(float));
+  for (size_t k = 0; k < tail; k++) {
+    ir[k] = 0.25f * expf(-6.0f * k / tail) * (float)synth_random();
+  }
+
+  near_start = count * 3 / 4;
+  near_end = near_start + rate;
+  int16_t* near = (int16_t*)calloc(rate, sizeof(int16_t));
+  synth_speech(near, rate, rate, 4000);
+  for (size_t i = 0; i < count; i++) {
+    float echo = 0;
+    for (size_t k = 0; k < tail && k + delay <= i; k++) {
+      echo += ir[k] * ref->samples[i - delay - k];
+    }
+    float sample = echo + 32 * (float)synth_random();
+    if (i >= near_start && i < near_end) {
+      sample += near[i - near_start];
+    }
+    mic->samples[i] = (int16_t)fmaxf(-32768.0f, fminf(32767.0f, sample));
+  }
+  free(near);
+  free(ir);
+}
+
+void bench_aec() {
+  WavAudio mic;
+  WavAudio ref;
+  const char* mic_path = getenv("AEC_MIC");
+  const char* ref_path = getenv("AEC_REF");
+  if (mic_path != NULL && ref_path != NULL) {
+    if (!wav_read(mic_path, &mic)) {
+      return;
+    }
+    if (!wav_read(ref_path, &ref)) {
+      wav_free(&mic);
+      return;
+    }
+    if (mic.sample_rate != ref.sample_rate) {
+      printf("aec: %s and %s differ in sample rate\n", mic_path, ref_path);
+      wav_free(&mic);
+      wav_free(&ref);
+      return;
+    }
+  } else {
+    synth_room(&mic, &ref);
+  }
+
+  uint32_t rate = mic.sample_rate;
+  size_t frame = rate * BENCH_FRAME_MS / 1000;
+  size_t frames = (mic.count < ref.count ? mic.count : ref.count) / frame;
+  int64_t frame_us = BENCH_FRAME_MS * 1000;
+
+  Aec* aec = (Aec*)malloc(sizeof(Aec));
+  int16_t* out = (int16_t*)malloc(frames * frame * sizeof(int16_t));
+  if (aec == NULL || out == NULL ||
+      !aec_init(aec, rate, frame)) {
+    printf("aec: out of memory\n");
+    return;
+  }
+
+  // ERLE accumulated per half so convergence shows up
+  double mic_energy[2] = {0, 0};
+  double out_energy[2] = {0, 0};
+  uint64_t total = 0;
+  uint64_t worst = 0;
+  int64_t wall_us = 0;
+  for (size_t f = 0; f < frames; f++) {
+    const int16_t* far = ref.samples + f * frame;
+    const int16_t* in = mic.samples + f * frame;
+    int16_t* cancelled = out + f * frame;
+
+    // Both ends stamped at the end of their frame, as in the firmware
+    int64_t now_us = (int64_t)(f + 1) * frame_us;
+    int64_t start_us = bench_us();
+    uint64_t start = bench_now();
+    aec_reference(aec, far, frame, now_us);
+    aec_process(aec, in, cancelled, now_us);
+    uint64_t elapsed = bench_elapsed(start);
+    wall_us += bench_us() - start_us;
+    total += elapsed;
+    if (elapsed > worst) {
+      worst = elapsed;
+    }
+
+    PcmLevel far_level;
+    pcm_level(far, frame, &far_level);
+    size_t sample = f * frame;
+    if (far_level.rms < AEC_BENCH_FAR_LEVEL ||
+        (sample + frame > near_start && sample < near_end)) {
+      continue;
+    }
+    int half = f < frames / 2 ? 0 : 1;
+    for (size_t i = 0; i < frame; i++) {
+      mic_energy[half] += (double)in[i] * in[i];
+      out_energy[half] += (double)cancelled[i] * cancelled[i];
+    }
+  }
+
+  AecStats stats;
+  aec_stats(aec, &stats);
+  printf("\naec: %s, %lu Hz, %lu frames, %lu taps\n",
+         mic_path != NULL && ref_path != NULL ? mic_path : "simulated room",
+         (unsigned long)rate, (unsigned long)frames, (unsigned long)aec->taps);
+  printf("aec: erle first half %.1f dB, second half %.1f dB (filter %.1f dB)\n",
+         10 * log10((mic_energy[0] + 1) / (out_energy[0] + 1)),
+         10 * log10((mic_energy[1] + 1) / (out_energy[1] + 1)), stats.erle_db);
+  printf("aec: delay %lu ms, far frames %lu, double talk %lu, rollbacks %lu\n",
+         (unsigned long)stats.delay_ms, (unsigned long)stats.far_frames,
+         (unsigned long)stats.double_talk, (unsigned long)stats.rollbacks);
+  printf("aec: %s per frame mean %llu max %llu, %.1f%% of real time\n",
+         BENCH_UNIT, (unsigned long long)(frames ? total / frames : 0),
+         (unsigned long long)worst,
+         frames ? 100.0 * wall_us / (frames * frame_us) : 0.0);
+
+  const char* out_path = getenv("AEC_OUT");
+  if (out_path != NULL) {
+    wav_write(out_path, out, frames * frame, rate);
+  }
+
+  free(out);
+  free(aec);
+  wav_free(&mic);
+  wav_free(&ref);
+}
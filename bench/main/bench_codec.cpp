@@ -0,0 +1,557 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <math.h>
+#include <opus.h>
+#include <string.h>
+
+#include "resample.h"
+#include "synth.h"
+#include "wav.h"
+
+// Opus settings sweep over a speech corpus, so encoder settings are picked
+// from numbers rather than by ear:
+//   CODEC_CORPUS    WAV files separated by commas, or a directory of them
+//                   (16-bit PCM at 8/16/24/48kHz; synthetic speech if unset)
+//   CODEC_SWEEP     "quick" (default) or "full" grid of settings
+//   CODEC_LOSS      Packet loss in percent applied before decoding (0)
+//   CODEC_RESULTS   CSV file receiving one line per setting
+//   CODEC_BASELINE  CSV from an earlier run; settings whose quality or size
+//                   got worse are reported as regressions
+// Each setting encodes every file at the swept rate with the firmware's
+// application (VOIP) and signal type, decodes it like the playout task
+// (FEC from the next packet, PLC otherwise) and scores the decoded speech
+// against the input with a PESQ-like proxy: band levels on a Bark scale
+// compared per 32ms frame, 4.5 for a transparent codec down to 1.0. It is
+// not calibrated against PESQ; compare settings at the same sample rate
+#define CODEC_BENCH_SECONDS 5          // Synthetic corpus length
+#define CODEC_BENCH_MAX_FILES 16       // Corpus files used
+#define CODEC_BENCH_MAX_RATES 5        // Values on the sample rate axis
+#define CODEC_BENCH_PACKET 1276        // Largest Opus packet
+#define CODEC_BENCH_FEC_LOSS 10        // Loss the encoder plans FEC for
+#define CODEC_BENCH_WINDOW_MS 32       // Quality analysis frame
+#define CODEC_BENCH_MAX_FFT 2048       // Analysis frame at 48kHz, power of two
+#define CODEC_BENCH_ACTIVE_DB 40       // Frames this far below the peak ignored
+#define CODEC_BENCH_MASK_DB 30         // Bands this far below the frame ignored
+#define CODEC_BENCH_DEADZONE_DB 1.0    // Band level error that is not heard
+#define CODEC_BENCH_SCORE_SLOPE 0.3    // Score lost per dB of band error
+#define CODEC_BENCH_QUALITY_DROP 0.05  // Score drop reported as a regression
+#define CODEC_BENCH_SIZE_GROWTH 5      // Percent more bytes reported as one
+
+// Swept settings, one value per axis
+enum {
+  CODEC_RATE,
+  CODEC_FRAME_MS,
+  CODEC_COMPLEXITY,
+  CODEC_BITRATE,
+  CODEC_DTX,
+  CODEC_FEC,
+  CODEC_AXES,
+};
+
+typedef struct {
+  const int32_t* values;
+  size_t count;
+} CodecAxis;
+
+#define CODEC_AXIS(values) {values, sizeof(values) / sizeof(values[0])}
+
+static const int32_t quick_rates[] = {8000, 16000};
+static const int32_t quick_frames[] = {20, 60};
+static const int32_t quick_complexities[] = {0, 5, 10};
+static const int32_t quick_bitrates[] = {16000, 30000, 64000};
+static const int32_t full_rates[] = {8000, 12000, 16000, 24000, 48000};
+static const int32_t full_frames[] = {10, 20, 40, 60};
+static const int32_t full_complexities[] = {0, 2, 5, 8, 10};
+static const int32_t full_bitrates[] = {8000,  12000, 16000, 24000,
+                                        30000, 48000, 64000};
+static const int32_t switches[] = {0, 1};
+
+// Quick covers the firmware (8kHz, complexity 0-10, 30kbps, DTX, FEC) and
+// mic_debug (16kHz, complexity 10, 64kbps) with their neighbours
+static const CodecAxis quick_sweep[CODEC_AXES] = {
+    CODEC_AXIS(quick_rates),
+    CODEC_AXIS(quick_frames),
+    CODEC_AXIS(quick_complexities),
+    CODEC_AXIS(quick_bitrates),
+    CODEC_AXIS(switches),  // DTX
+    CODEC_AXIS(switches),  // FEC
+};
+
+static const CodecAxis full_sweep[CODEC_AXES] = {
+    CODEC_AXIS(full_rates),
+    CODEC_AXIS(full_frames),
+    CODEC_AXIS(full_complexities),
+    CODEC_AXIS(full_bitrates),
+    CODEC_AXIS(switches),  // DTX
+    CODEC_AXIS(switches),  // FEC
+};
+
+// Corpus file converted to every rate on the sweep's rate axis
+typedef struct {
+  char name[64];
+  int16_t* samples[CODEC_BENCH_MAX_RATES];
+  size_t count[CODEC_BENCH_MAX_RATES];
+} CodecFile;
+
+// One setting summed over the corpus
+typedef struct {
+  double encode_us;  // Wall time of all opus_encode calls
+  double decode_us;  // Wall time of all opus_decode calls
+  uint64_t bytes;    // Packet bytes, DTX frames included
+  size_t frames;     // Packets encoded
+  double seconds;    // Audio encoded
+  double score;      // Quality proxy weighted by active analysis frames
+  double lsd_db;     // Log-spectral distance, same weighting
+  size_t active;     // Active analysis frames
+  bool ok;
+} CodecResult;
+
+static CodecFile codec_files[CODEC_BENCH_MAX_FILES];
+static size_t codec_file_count = 0;
+
+// Convert one file to every rate on the axis; false if a rate pair is not
+// supported by the resampler
+static bool codec_add(const char* name, const WavAudio* wav,
+                      const CodecAxis* rates) {
+  if (codec_file_count == CODEC_BENCH_MAX_FILES) {
+    return false;
+  }
+  CodecFile* file = &codec_files[codec_file_count];
+  snprintf(file->name, sizeof(file->name), "%s", name);
+  size_t block = wav->sample_rate * BENCH_FRAME_MS / 1000;
+  for (size_t r = 0; r < rates->count; r++) {
+    Resampler resampler;
+    if (!resample_init(&resampler, wav->sample_rate, rates->values[r],
+                       RESAMPLE_HIGH, block)) {
+      printf("codec: %s: cannot convert %luHz to %ldHz\n", name,
+             (unsigned long)wav->sample_rate, (long)rates->values[r]);
+      return false;
+    }
+    size_t blocks = wav->count / block;
+    file->samples[r] = (int16_t*)malloc(
+        (blocks * resample_output_max(&resampler, block) + 1) *
+        sizeof(int16_t));
+    file->count[r] = 0;
+    for (size_t b = 0; b < blocks; b++) {
+      file->count[r] +=
+          resample_process(&resampler, wav->samples + b * block, block,
+                           file->samples[r] + file->count[r]);
+    }
+  }
+  codec_file_count++;
+  return true;
+}
+
+static void codec_load(const char* path, const CodecAxis* rates) {
+  WavAudio wav;
+  if (wav_read(path, &wav)) {
+    const char* name = strrchr(path, '/');
+    codec_add(name != NULL ? name + 1 : path, &wav, rates);
+    wav_free(&wav);
+  }
+}
+
+static void codec_load_entry(const char* path, void* rates) {
+  codec_load(path, (const CodecAxis*)rates);
+}
+
+// In-place radix-2 complex FFT, n a power of two
+static void codec_fft(float* re, float* im, size_t n) {
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      float t = re[i];
+      re[i] = re[j];
+      re[j] = t;
+      t = im[i];
+      im[i] = im[j];
+      im[j] = t;
+    }
+  }
+  for (size_t length = 2; length <= n; length <<= 1) {
+    double angle = -2 * M_PI / length;
+    for (size_t i = 0; i < n; i += length) {
+      for (size_t k = 0; k < length / 2; k++) {
+        float wr = (float)cos(angle * k);
+        float wi = (float)sin(angle * k);
+        size_t a = i + k;
+        size_t b = a + length / 2;
+        float xr = re[b] * wr - im[b] * wi;
+        float xi = re[b] * wi + im[b] * wr;
+        re[b] = re[a] - xr;
+        im[b] = im[a] - xi;
+        re[a] += xr;
+        im[a] += xi;
+      }
+    }
+  }
+}
+
+// Critical band edges in Hz (Zwicker); bands above min(rate / 2, 8kHz) are
+// left out, so narrowband settings are scored on the narrow band
+static const int codec_band_edges[] = {100,  200,  300,  400,  510,  630,
+                                       770,  920,  1080, 1270, 1480, 1720,
+                                       2000, 2320, 2700, 3150, 3700, 4400,
+                                       5300, 6400, 7700};
+
+#define CODEC_BANDS \
+  (sizeof(codec_band_edges) / sizeof(codec_band_edges[0]) - 1)
+
+static float codec_re[CODEC_BENCH_MAX_FFT];
+static float codec_im[CODEC_BENCH_MAX_FFT];
+
+// Hann-windowed band energies of one analysis frame
+static void codec_bands(const int16_t* in, size_t n, uint32_t rate,
+                        size_t bands, double* energy) {
+  for (size_t i = 0; i < n; i++) {
+    float window = 0.5f - 0.5f * cosf(2 * (float)M_PI * i / n);
+    codec_re[i] = in[i] * window;
+    codec_im[i] = 0;
+  }
+  codec_fft(codec_re, codec_im, n);
+  for (size_t b = 0; b < bands; b++) {
+    size_t low = codec_band_edges[b] * n / rate;
+    size_t high = codec_band_edges[b + 1] * n / rate;
+    energy[b] = 0;
+    for (size_t k = low; k < high; k++) {
+      energy[b] += (double)codec_re[k] * codec_re[k] +
+                   (double)codec_im[k] * codec_im[k];
+    }
+  }
+}
+
+// Score decoded against reference (already aligned) into result, weighted
+// by the number of active analysis frames
+static void codec_score(const int16_t* ref, const int16_t* dec, size_t count,
+                        uint32_t rate, CodecResult* result) {
+  size_t n = 1;
+  while (n < rate * CODEC_BENCH_WINDOW_MS / 1000) {
+    n <<= 1;
+  }
+  size_t bands = 0;
+  uint32_t top = rate / 2 < 8000 ? rate / 2 : 8000;
+  while (bands < CODEC_BANDS && (uint32_t)codec_band_edges[bands + 1] <= top) {
+    bands++;
+  }
+
+  // Loudest frame of the reference, for the activity threshold
+  double peak = 0;
+  for (size_t start = 0; start + n <= count; start += n / 2) {
+    double energy = 0;
+    for (size_t i = 0; i < n; i++) {
+      energy += (double)ref[start + i] * ref[start + i];
+    }
+    peak = energy > peak ? energy : peak;
+  }
+  double active_floor = peak * pow(10, -CODEC_BENCH_ACTIVE_DB / 10.0);
+
+  double ref_energy[CODEC_BANDS];
+  double dec_energy[CODEC_BANDS];
+  for (size_t start = 0; start + n <= count; start += n / 2) {
+    double energy = 0;
+    for (size_t i = 0; i < n; i++) {
+      energy += (double)ref[start + i] * ref[start + i];
+    }
+    if (energy <= active_floor || energy == 0) {
+      continue;
+    }
+    codec_bands(ref + start, n, rate, bands, ref_energy);
+    codec_bands(dec + start, n, rate, bands, dec_energy);
+    double total = 0;
+    for (size_t b = 0; b < bands; b++) {
+      total += ref_energy[b];
+    }
+    // Quiet bands sit under the louder ones and count at the mask level
+    double mask = total / bands * pow(10, -CODEC_BENCH_MASK_DB / 10.0) + 1;
+    double error = 0;
+    double squared = 0;
+    for (size_t b = 0; b < bands; b++) {
+      double diff = 10 * log10((dec_energy[b] + mask) / (ref_energy[b] + mask));
+      double heard = fabs(diff) - CODEC_BENCH_DEADZONE_DB;
+      error += heard > 0 ? heard : 0;
+      squared += diff * diff;
+    }
+    double score = 4.5 - CODEC_BENCH_SCORE_SLOPE * error / bands;
+    result->score += score > 1.0 ? score : 1.0;
+    result->lsd_db += sqrt(squared / bands);
+    result->active++;
+  }
+}
+
+// Encode and decode one file at one setting, adding to result
+static bool codec_run(const CodecFile* file, size_t rate_index,
+                      const int32_t* setting, int loss, CodecResult* result) {
+  uint32_t rate = setting[CODEC_RATE];
+  size_t frame = rate * setting[CODEC_FRAME_MS] / 1000;
+  size_t frames = file->count[rate_index] / frame;
+  const int16_t* pcm = file->samples[rate_index];
+  if (frames < 2) {
+    return true;
+  }
+
+  int error = 0;
+  OpusEncoder* encoder =
+      opus_encoder_create(rate, 1, OPUS_APPLICATION_VOIP, &error);
+  OpusDecoder* decoder = opus_decoder_create(rate, 1, &error);
+  uint8_t* packets = (uint8_t*)malloc(frames * CODEC_BENCH_PACKET);
+  int* lengths = (int*)malloc(frames * sizeof(int));
+  int16_t* decoded = (int16_t*)malloc(frames * frame * sizeof(int16_t));
+  bool ok = encoder != NULL && decoder != NULL && packets != NULL &&
+            lengths != NULL && decoded != NULL;
+
+  if (ok) {
+    int expected = loss;
+    if (expected == 0 && setting[CODEC_FEC]) {
+      expected = CODEC_BENCH_FEC_LOSS;  // FEC is only added for expected loss
+    }
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(setting[CODEC_BITRATE]));
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(setting[CODEC_COMPLEXITY]));
+    opus_encoder_ctl(encoder, OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE));
+    opus_encoder_ctl(encoder, OPUS_SET_DTX(setting[CODEC_DTX]));
+    opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(setting[CODEC_FEC]));
+    opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(expected));
+
+    int64_t start_us = bench_us();
+    for (size_t f = 0; f < frames && ok; f++) {
+      lengths[f] = opus_encode(encoder, pcm + f * frame, frame,
+                               packets + f * CODEC_BENCH_PACKET,
+                               CODEC_BENCH_PACKET);
+      ok = lengths[f] > 0;
+      result->bytes += lengths[f];
+    }
+    result->encode_us += bench_us() - start_us;
+  }
+
+  if (ok) {
+    // Same loss pattern for every setting of the sweep
+    synth_seed(1);
+    bool lost_next = loss > 0 && synth_bits() % 100 < (uint32_t)loss;
+    int64_t start_us = bench_us();
+    for (size_t f = 0; f < frames && ok; f++) {
+      bool lost = lost_next;
+      lost_next = loss > 0 && synth_bits() % 100 < (uint32_t)loss;
+      int16_t* out = decoded + f * frame;
+      int samples;
+      if (!lost) {
+        samples = opus_decode(decoder, packets + f * CODEC_BENCH_PACKET,
+                              lengths[f], out, frame, 0);
+      } else if (f + 1 < frames && !lost_next) {
+        samples = opus_decode(decoder, packets + (f + 1) * CODEC_BENCH_PACKET,
+                              lengths[f + 1], out, frame, 1);
+      } else {
+        samples = opus_decode(decoder, NULL, 0, out, frame, 0);
+      }
+      ok = samples == (int)frame;
+    }
+    result->decode_us += bench_us() - start_us;
+  }
+
+  if (ok) {
+    // The decoded stream lags the input by the encoder's lookahead
+    opus_int32 lookahead = 0;
+    opus_encoder_ctl(encoder, OPUS_GET_LOOKAHEAD(&lookahead));
+    size_t count = frames * frame;
+    if ((size_t)lookahead < count) {
+      codec_score(pcm, decoded + lookahead, count - lookahead, rate, result);
+    }
+    result->frames += frames;
+    result->seconds += (double)count / rate;
+  }
+
+  opus_encoder_destroy(encoder);
+  opus_decoder_destroy(decoder);
+  free(packets);
+  free(lengths);
+  free(decoded);
+  return ok;
+}
+
+#define CODEC_CSV_HEADER                                                    \
+  "rate,frame_ms,complexity,bitrate,dtx,fec,encode_us,decode_us,"          \
+  "bytes_per_second,score,lsd_db"
+
+typedef struct {
+  int32_t setting[CODEC_AXES];
+  double bytes_per_second;
+  double score;
+} CodecBaseline;
+
+static CodecBaseline* codec_baseline = NULL;
+static size_t codec_baseline_count = 0;
+
+static void codec_load_baseline(const char* path) {
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    printf("codec: cannot open baseline %s\n", path);
+    return;
+  }
+  size_t capacity = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    CodecBaseline entry;
+    long v[CODEC_AXES];
+    double encode_us, decode_us, lsd_db;
+    if (sscanf(line, "%ld,%ld,%ld,%ld,%ld,%ld,%lf,%lf,%lf,%lf,%lf", &v[0],
+               &v[1], &v[2], &v[3], &v[4], &v[5], &encode_us, &decode_us,
+               &entry.bytes_per_second, &entry.score, &lsd_db) != 11) {
+      continue;  // Header or malformed
+    }
+    for (int a = 0; a < CODEC_AXES; a++) {
+      entry.setting[a] = (int32_t)v[a];
+    }
+    if (codec_baseline_count == capacity) {
+      capacity = capacity ? capacity * 2 : 64;
+      codec_baseline = (CodecBaseline*)realloc(
+          codec_baseline, capacity * sizeof(CodecBaseline));
+    }
+    codec_baseline[codec_baseline_count++] = entry;
+  }
+  fclose(file);
+}
+
+static const CodecBaseline* codec_find_baseline(const int32_t* setting) {
+  for (size_t i = 0; i < codec_baseline_count; i++) {
+    if (memcmp(codec_baseline[i].setting, setting,
+               sizeof(codec_baseline[i].setting)) == 0) {
+      return &codec_baseline[i];
+    }
+  }
+  return NULL;
+}
+
+void bench_codec() {
+  const char* sweep_name = getenv("CODEC_SWEEP");
+  bool full = sweep_name != NULL && strcmp(sweep_name, "full") == 0;
+  const CodecAxis* sweep = full ? full_sweep : quick_sweep;
+  const char* loss_env = getenv("CODEC_LOSS");
+  int loss = loss_env != NULL ? atoi(loss_env) : 0;
+
+  const char* corpus = getenv("CODEC_CORPUS");
+  if (corpus != NULL) {
+    wav_list(corpus, CODEC_BENCH_MAX_FILES, codec_load_entry,
+             (void*)&sweep[CODEC_RATE]);
+  } else {
+    // Synthetic speech at 16kHz
+    WavAudio wav;
+    wav.sample_rate = 16000;
+    wav.count = wav.sample_rate * CODEC_BENCH_SECONDS;
+    wav.samples = (int16_t*)malloc(wav.count * sizeof(int16_t));
+    synth_seed(1);
+    synth_speech(wav.samples, wav.count, wav.sample_rate, 9000);
+    codec_add("synthetic", &wav, &sweep[CODEC_RATE]);
+    wav_free(&wav);
+  }
+  if (codec_file_count == 0) {
+    printf("codec: empty corpus\n");
+    return;
+  }
+
+  const char* baseline_path = getenv("CODEC_BASELINE");
+  if (baseline_path != NULL) {
+    codec_load_baseline(baseline_path);
+  }
+  const char* results_path = getenv("CODEC_RESULTS");
+  FILE* results = NULL;
+  if (results_path != NULL) {
+    results = fopen(results_path, "w");
+    if (results == NULL) {
+      printf("codec: cannot create %s\n", results_path);
+    } else {
+      fprintf(results, "%s\n", CODEC_CSV_HEADER);
+    }
+  }
+
+  // OPUS_SET_GAIN is a decoder control; report what the encoder makes of it
+  OpusEncoder* probe = opus_encoder_create(8000, 1, OPUS_APPLICATION_VOIP,
+                                           NULL);
+  int gain = probe != NULL ? opus_encoder_ctl(probe, OPUS_SET_GAIN(500)) : 0;
+  opus_encoder_destroy(probe);
+
+  printf("\ncodec: %s sweep, %lu files, %d%% loss\n", full ? "full" : "quick",
+         (unsigned long)codec_file_count, loss);
+  printf("codec: OPUS_SET_GAIN(500) on the encoder: %s\n", opus_strerror(gain));
+  printf("codec: %6s %5s %4s %7s %3s %3s %9s %9s %8s %6s %7s\n", "rate",
+         "frame", "cplx", "bitrate", "dtx", "fec", "enc us/f", "dec us/f",
+         "bytes/s", "score", "lsd dB");
+
+  size_t index[CODEC_AXES] = {};
+  size_t regressions = 0;
+  while (true) {
+    int32_t setting[CODEC_AXES];
+    for (int a = 0; a < CODEC_AXES; a++) {
+      setting[a] = sweep[a].values[index[a]];
+    }
+
+    CodecResult result = {};
+    result.ok = true;
+    for (size_t f = 0; f < codec_file_count && result.ok; f++) {
+      result.ok = codec_run(&codec_files[f], index[CODEC_RATE], setting, loss,
+                            &result);
+    }
+    if (!result.ok || result.frames == 0) {
+      printf("codec: %ldHz %ldms %ldbps failed\n", (long)setting[CODEC_RATE],
+             (long)setting[CODEC_FRAME_MS], (long)setting[CODEC_BITRATE]);
+    } else {
+      double encode_us = result.encode_us / result.frames;
+      double decode_us = result.decode_us / result.frames;
+      double bytes_per_second = result.bytes / result.seconds;
+      double score = result.active ? result.score / result.active : 0;
+      double lsd_db = result.active ? result.lsd_db / result.active : 0;
+      printf("codec: %6ld %5ld %4ld %7ld %3ld %3ld %9.1f %9.1f %8.0f %6.2f "
+             "%7.2f\n",
+             (long)setting[CODEC_RATE], (long)setting[CODEC_FRAME_MS],
+             (long)setting[CODEC_COMPLEXITY], (long)setting[CODEC_BITRATE],
+             (long)setting[CODEC_DTX], (long)setting[CODEC_FEC], encode_us,
+             decode_us, bytes_per_second, score, lsd_db);
+      if (results != NULL) {
+        fprintf(results, "%ld,%ld,%ld,%ld,%ld,%ld,%.1f,%.1f,%.0f,%.3f,%.3f\n",
+                (long)setting[CODEC_RATE], (long)setting[CODEC_FRAME_MS],
+                (long)setting[CODEC_COMPLEXITY], (long)setting[CODEC_BITRATE],
+                (long)setting[CODEC_DTX], (long)setting[CODEC_FEC], encode_us,
+                decode_us, bytes_per_second, score, lsd_db);
+      }
+
+      const CodecBaseline* base = codec_find_baseline(setting);
+      if (base != NULL &&
+          (score < base->score - CODEC_BENCH_QUALITY_DROP ||
+           bytes_per_second > base->bytes_per_second *
+                                  (100 + CODEC_BENCH_SIZE_GROWTH) / 100)) {
+        printf("codec: regression at the setting above: score %.2f -> %.2f, "
+               "bytes/s %.0f -> %.0f\n",
+               base->score, score, base->bytes_per_second, bytes_per_second);
+        regressions++;
+      }
+    }
+
+    // Next setting, last axis fastest
+    int a = CODEC_AXES - 1;
+    while (a >= 0 && ++index[a] == sweep[a].count) {
+      index[a--] = 0;
+    }
+    if (a < 0) {
+      break;
+    }
+  }
+
+  if (results != NULL) {
+    fclose(results);
+  }
+  if (baseline_path != NULL) {
+    printf("codec: %lu regressions against %s\n", (unsigned long)regressions,
+           baseline_path);
+  }
+}
+#else
+void bench_codec() {
+  // A sweep takes minutes of encoding; run it on the host
+  printf("\ncodec: linux target only\n");
+}
+#endif
@@ -0,0 +1,93 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "dsp.h"
+#include "pcm.h"
+
+// Cost of each microphone front-end stage per 20ms block at the rates the
+// capture path can run at. The input alternates half a second of a voiced
+// tone burst with half a second of background noise on a DC offset, so the
+// gate opens and closes and the AGC ramps, as it does on speech; each stage
+// is timed on its own, in chain order, over the same sequence
+#define DSP_BENCH_MAX_FRAME 960  // 20ms at 48kHz
+#define DSP_BENCH_FRAMES 50      // Blocks per pass (1s)
+#define DSP_BENCH_DC 1500        // INMP441-like DC offset
+#define DSP_BENCH_NOISE 60       // Background amplitude
+#define DSP_BENCH_SPEECH 1200    // Burst amplitude
+
+static const uint32_t dsp_rates[] = {8000, 16000, 48000};
+
+static int16_t dsp_input[DSP_BENCH_MAX_FRAME * DSP_BENCH_FRAMES];
+static int16_t dsp_frame[DSP_BENCH_MAX_FRAME] __attribute__((aligned(16)));
+
+static void dsp_bench_signal(uint32_t rate, size_t samples) {
+  uint32_t seed = 1;
+  for (size_t i = 0; i < samples; i++) {
+    seed = seed * 1103515245 + 12345;
+    double noise = (int32_t)(seed >> 16) % (2 * DSP_BENCH_NOISE + 1) -
+                   DSP_BENCH_NOISE;
+    double t = (double)i / rate;
+    double voiced = 0;
+    if ((i / (rate / 2)) % 2 == 0) {
+      voiced = DSP_BENCH_SPEECH * (sin(2 * M_PI * 140 * t) +
+                                   0.5 * sin(2 * M_PI * 700 * t) +
+                                   0.25 * sin(2 * M_PI * 2300 * t));
+    }
+    dsp_input[i] = (int16_t)lrint(DSP_BENCH_DC + noise + voiced);
+  }
+}
+
+void bench_dsp() {
+  printf("\ndsp: %s per 20ms block, each stage in chain order\n", BENCH_UNIT);
+  printf("%-6s %-9s %10s %8s\n", "rate", "stage", BENCH_UNIT, "/sample");
+  for (size_t r = 0; r < sizeof(dsp_rates) / sizeof(dsp_rates[0]); r++) {
+    uint32_t rate = dsp_rates[r];
+    size_t frame = rate * BENCH_FRAME_MS / 1000;
+    dsp_bench_signal(rate, frame * DSP_BENCH_FRAMES);
+
+    DspHighpass highpass;
+    DspGate gate;
+    DspAgc agc;
+    dsp_highpass_init(&highpass, rate, DSP_HIGHPASS_CUTOFF);
+    dsp_gate_init(&gate, rate, frame);
+    dsp_agc_init(&agc, rate, frame);
+    DspChain chain;
+    dsp_chain_init(&chain);
+    dsp_chain_add(&chain, "highpass", dsp_highpass_process, &highpass);
+    dsp_chain_add(&chain, "gate", dsp_gate_process, &gate);
+    dsp_chain_add(&chain, "agc", dsp_agc_process, &agc);
+
+    uint64_t elapsed[DSP_MAX_STAGES] = {0};
+    int passes = BENCH_ITERATIONS / DSP_BENCH_FRAMES;
+    for (int p = 0; p < passes; p++) {
+      for (size_t f = 0; f < DSP_BENCH_FRAMES; f++) {
+        memcpy(dsp_frame, dsp_input + f * frame, frame * sizeof(int16_t));
+        for (size_t s = 0; s < chain.count; s++) {
+          DspStage* stage = &chain.stages[s];
+          uint64_t start = bench_now();
+          stage->process(stage->state, dsp_frame, frame);
+          elapsed[s] += bench_elapsed(start);
+        }
+      }
+    }
+
+    char name[16];
+    snprintf(name, sizeof(name), "%luk", (unsigned long)(rate / 1000));
+    uint64_t blocks = (uint64_t)passes * DSP_BENCH_FRAMES;
+    uint64_t total = 0;
+    for (size_t s = 0; s < chain.count; s++) {
+      total += elapsed[s];
+      printf("%-6s %-9s %10llu %8.2f\n", name, chain.stages[s].name,
+             (unsigned long long)(elapsed[s] / blocks),
+             (double)elapsed[s] / blocks / frame);
+    }
+    printf("%-6s %-9s %10llu %8.2f\n", name, "chain",
+           (unsigned long long)(total / blocks),
+           (double)total / blocks / frame);
+    printf("%-6s gate closed %lu/%lu blocks, agc gain %.2fx\n", name,
+           (unsigned long)gate.closed, (unsigned long)gate.blocks,
+           (double)agc.gain / PCM_GAIN_UNITY);
+  }
+}
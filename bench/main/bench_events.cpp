@@ -0,0 +1,208 @@
+#include <cJSON.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "events.h"
+
+// Data-channel event handling throughput: a mix of Realtime API events,
+// dominated by transcript deltas, is routed through the firmware's
+// dispatcher and, for comparison, through a full cJSON parse of each
+// message. Reports messages per second, input bandwidth and the heap
+// allocations made per message. Allocations are counted by interposing
+// malloc on linux hosts and through the heap hooks on target
+// (CONFIG_HEAP_USE_HOOKS, set in bench/sdkconfig.defaults)
+#define EVENTS_BENCH_MESSAGES 20000  // Messages routed per method
+#define EVENTS_BENCH_TEXT 256        // Unescaped delta buffer
+
+static const char* const events_messages[] = {
+    "{\"type\":\"response.audio_transcript.delta\",\"event_id\":\"event_"
+    "AjFqS1dGQ3Bx\",\"response_id\":\"resp_AjFqRzKpLm9\",\"item_id\":\"item_"
+    "AjFqRzY2d4Bc\",\"output_index\":0,\"content_index\":0,\"delta\":\" "
+    "Hello\"}",
+    "{\"type\":\"response.audio_transcript.delta\",\"event_id\":\"event_"
+    "AjFqS1dGQ3By\",\"response_id\":\"resp_AjFqRzKpLm9\",\"item_id\":\"item_"
+    "AjFqRzY2d4Bc\",\"output_index\":0,\"content_index\":0,\"delta\":\" "
+    "there,\"}",
+    "{\"type\":\"response.audio_transcript.delta\",\"event_id\":\"event_"
+    "AjFqS1dGQ3Bz\",\"response_id\":\"resp_AjFqRzKpLm9\",\"item_id\":\"item_"
+    "AjFqRzY2d4Bc\",\"output_index\":0,\"content_index\":0,\"delta\":\" "
+    "I\\u2019m \\\"your\\\" assistant\"}",
+    "{\"type\":\"response.audio_transcript.delta\",\"event_id\":\"event_"
+    "AjFqS1dGQ3C0\",\"response_id\":\"resp_AjFqRzKpLm9\",\"item_id\":\"item_"
+    "AjFqRzY2d4Bc\",\"output_index\":0,\"content_index\":0,\"delta\":\" "
+    "running on an ESP32-S3.\"}",
+    "{\"type\":\"input_audio_buffer.speech_started\",\"event_id\":\"event_"
+    "AjFqT0aBc1De\",\"audio_start_ms\":10240,\"item_id\":\"item_"
+    "AjFqT0Zz9yXw\"}",
+    "{\"type\":\"response.done\",\"event_id\":\"event_AjFqT3nQ8rSt\","
+    "\"response\":{\"object\":\"realtime.response\",\"id\":\"resp_"
+    "AjFqRzKpLm9\",\"status\":\"completed\",\"status_details\":null,"
+    "\"output\":[{\"id\":\"item_AjFqRzY2d4Bc\",\"object\":\"realtime.item\","
+    "\"type\":\"message\",\"status\":\"completed\",\"role\":\"assistant\","
+    "\"content\":[{\"type\":\"audio\",\"transcript\":\"Hello there, I\\u2019m "
+    "your assistant running on an ESP32-S3.\"}]}],\"usage\":{\"total_"
+    "tokens\":412,\"input_tokens\":187,\"output_tokens\":225}}}",
+    "{\"type\":\"rate_limits.updated\",\"event_id\":\"event_AjFqT4pQ\","
+    "\"rate_limits\":[{\"name\":\"requests\",\"limit\":5000,\"remaining\":"
+    "4999,\"reset_seconds\":0.012},{\"name\":\"tokens\",\"limit\":400000,"
+    "\"remaining\":399588,\"reset_seconds\":0.061}]}",
+    "{\"type\":\"response.audio_transcript.delta\",\"event_id\":\"event_"
+    "AjFqS1dGQ3C1\",\"response_id\":\"resp_AjFqRzKpLm9\",\"item_id\":\"item_"
+    "AjFqRzY2d4Bc\",\"output_index\":0,\"content_index\":0,\"delta\":\" "
+    "How can I help?\"}",
+};
+
+#define EVENTS_BENCH_KINDS \
+  (sizeof(events_messages) / sizeof(events_messages[0]))
+
+// Heap allocations made while events_counting is set
+static bool events_counting = false;
+static uint64_t events_allocations = 0;
+static uint64_t events_allocated = 0;
+
+#if CONFIG_IDF_TARGET_LINUX && defined(__GLIBC__)
+#define EVENTS_BENCH_COUNTS 1
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+extern "C" void* malloc(size_t size) {
+  if (events_counting) {
+    events_allocations++;
+    events_allocated += size;
+  }
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  if (events_counting) {
+    events_allocations++;
+    events_allocated += count * size;
+  }
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  if (events_counting) {
+    events_allocations++;
+    events_allocated += size;
+  }
+  return __libc_realloc(ptr, size);
+}
+#elif CONFIG_HEAP_USE_HOOKS
+#define EVENTS_BENCH_COUNTS 1
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size,
+                                          uint32_t caps) {
+  if (events_counting) {
+    events_allocations++;
+    events_allocated += size;
+  }
+}
+#else
+#define EVENTS_BENCH_COUNTS 0
+#endif
+
+// Work a handler would do with the fields, kept so it is not optimized out
+static size_t events_sink = 0;
+
+static void events_on_delta(const JsonSlice* fields, void* user_data) {
+  char text[EVENTS_BENCH_TEXT];
+  events_sink += json_unescape(&fields[0], text, sizeof(text));
+}
+
+static void events_on_field(const JsonSlice* fields, void* user_data) {
+  events_sink += fields[0].length;
+}
+
+static void events_on_event(const JsonSlice* fields, void* user_data) {
+  events_sink++;
+}
+
+// Same routes as the firmware's table
+static const EventRoute events_routes[] = {
+    {"response.audio_transcript.delta", events_on_delta, {"delta"}},
+    {"response.audio_transcript.done", events_on_event, {}},
+    {"conversation.item.input_audio_transcription.completed",
+     events_on_field,
+     {"transcript"}},
+    {"input_audio_buffer.speech_started", events_on_event, {}},
+    {"input_audio_buffer.speech_stopped", events_on_event, {}},
+    {"response.done", events_on_field, {"response.status"}},
+    {"error", events_on_field, {"error.code", "error.message"}},
+};
+
+// Full parse and tree lookup of the same fields
+static void events_cjson(const char* msg, size_t length) {
+  cJSON* root = cJSON_ParseWithLength(msg, length);
+  if (root == NULL) {
+    return;
+  }
+  const char* type = cJSON_GetStringValue(cJSON_GetObjectItem(root, "type"));
+  if (type != NULL && strcmp(type, "response.audio_transcript.delta") == 0) {
+    const char* delta =
+        cJSON_GetStringValue(cJSON_GetObjectItem(root, "delta"));
+    events_sink += delta != NULL ? strlen(delta) : 0;
+  } else if (type != NULL && strcmp(type, "response.done") == 0) {
+    cJSON* response = cJSON_GetObjectItem(root, "response");
+    const char* status =
+        cJSON_GetStringValue(cJSON_GetObjectItem(response, "status"));
+    events_sink += status != NULL ? strlen(status) : 0;
+  }
+  cJSON_Delete(root);
+}
+
+static void events_run(const char* name, bool scanner) {
+  size_t lengths[EVENTS_BENCH_KINDS];
+  for (size_t i = 0; i < EVENTS_BENCH_KINDS; i++) {
+    lengths[i] = strlen(events_messages[i]);
+  }
+
+  EventStats stats = {};
+  events_allocations = 0;
+  events_allocated = 0;
+  events_counting = true;
+  int64_t start_us = bench_us();
+  uint64_t start = bench_now();
+  for (uint32_t n = 0; n < EVENTS_BENCH_MESSAGES; n++) {
+    size_t kind = n % EVENTS_BENCH_KINDS;
+    if (scanner) {
+      events_dispatch(events_routes,
+                      sizeof(events_routes) / sizeof(events_routes[0]),
+                      events_messages[kind], lengths[kind], &stats, NULL);
+    } else {
+      stats.bytes += lengths[kind];
+      events_cjson(events_messages[kind], lengths[kind]);
+    }
+  }
+  uint64_t elapsed = bench_elapsed(start);
+  int64_t elapsed_us = bench_us() - start_us;
+  events_counting = false;
+
+  if (elapsed_us <= 0) {
+    elapsed_us = 1;
+  }
+  uint64_t rate = (uint64_t)EVENTS_BENCH_MESSAGES * 1000000 / elapsed_us;
+  uint64_t bandwidth = stats.bytes * 1000000 / elapsed_us / 1024;
+#if EVENTS_BENCH_COUNTS
+  printf("%-8s %12llu %10llu %12llu %10llu %10llu\n", name,
+         (unsigned long long)rate, (unsigned long long)bandwidth,
+         (unsigned long long)(elapsed / EVENTS_BENCH_MESSAGES),
+         (unsigned long long)(events_allocations / EVENTS_BENCH_MESSAGES),
+         (unsigned long long)(events_allocated / EVENTS_BENCH_MESSAGES));
+#else
+  printf("%-8s %12llu %10llu %12llu %10s %10s\n", name,
+         (unsigned long long)rate, (unsigned long long)bandwidth,
+         (unsigned long long)(elapsed / EVENTS_BENCH_MESSAGES), "-", "-");
+#endif
+}
+
+void bench_events() {
+  printf("\nevents: %d messages, %d kinds\n", EVENTS_BENCH_MESSAGES,
+         (int)EVENTS_BENCH_KINDS);
+  printf("%-8s %12s %10s %12s %10s %10s\n", "method", "msgs/s", "KB/s",
+         BENCH_UNIT "/msg", "allocs/msg", "bytes/msg");
+  events_run("scan", true);
+  events_run("cjson", false);
+}
@@ -0,0 +1,742 @@
+#include <stdio.h>
+
+#include "bench.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "kws.h"
+#include "resample.h"
+#include "synth.h"
+#include "wav.h"
+
+// Wake-word benchmark: trains the keyword spotter's network on features
+// from the firmware's fixed-point front end, quantizes it like kws_score
+// runs it, then streams held-out clips through kws_process in 20ms blocks
+// as on the capture path:
+//   KWS_POSITIVE   clips of the wake word, a directory of WAVs or a
+//                  comma-separated list (16-bit PCM at 8/16/24/48kHz;
+//                  a synthetic three-syllable keyword if unset)
+//   KWS_NEGATIVE   clips without it: other speech, room and street noise
+//   KWS_KEYWORD    name stored in the exported model ("synthetic")
+//   KWS_MODEL_OUT  writes the quantized model as a kws_model.cpp source
+// Every fifth clip of each set is held out of training. A held-out keyword
+// clip that never fires is a false reject; detections anywhere in held-out
+// negative audio are false accepts, reported per hour of audio
+#define KWS_BENCH_RATE 8000         // Network input rate (the codec rate)
+#define KWS_BENCH_CLIPS 500         // Synthetic clips per set
+#define KWS_BENCH_KEYWORD_MS 1200   // Synthetic keyword clip length
+#define KWS_BENCH_OTHER_MS 4000     // Synthetic negative clip length
+#define KWS_BENCH_MAX_FILES 8192    // Corpus files used per set
+#define KWS_BENCH_HOLD_OUT 5        // Every fifth clip is held out
+#define KWS_BENCH_PAD 8             // Padding noise amplitude around clips
+#define KWS_BENCH_TAIL 25           // Blocks streamed after a clip (0.5s)
+#define KWS_BENCH_END_DB 15         // Keyword ends this far below the peak
+#define KWS_BENCH_LABELS 4          // Windows from the keyword's end, labeled
+#define KWS_BENCH_STRIDE 2          // Negative training windows every 2 blocks
+#define KWS_BENCH_EPOCHS 30         // Passes over the training windows
+#define KWS_BENCH_BATCH 32          // Windows per update
+#define KWS_BENCH_LEARN 0.002       // Adam step size
+#define KWS_BENCH_SCALE 16.0        // int8 inputs to the float inputs
+#define KWS_BENCH_RECALL 0.9        // Training keywords kept by the threshold
+#define KWS_BENCH_MAX_RESAMPLERS 4  // Input rates converted
+
+typedef struct {
+  int16_t* samples;  // Padding noise, the clip, KWS_BENCH_TAIL blocks
+  size_t blocks;     // Blocks streamed
+  size_t end;        // Block where the keyword ends, keyword clips only
+  bool positive;
+  bool held_out;
+} KwsClip;
+
+// One syllable of the synthetic voice; pitch 0 is a fricative
+typedef struct {
+  double ms;
+  double pitch[2];  // Start and end, Hz
+  double f1[2];     // First formant
+  double f2[2];     // Second formant
+} KwsSyllable;
+
+// Float network trained with Adam; W1 sees inputs / KWS_BENCH_SCALE
+typedef struct {
+  double w1[KWS_HIDDEN][KWS_INPUTS];
+  double b1[KWS_HIDDEN];
+  double w2[KWS_HIDDEN];
+  double b2;
+} KwsNet;
+
+// Streaming results over the held-out clips
+typedef struct {
+  size_t keywords;  // Held-out keyword clips
+  size_t rejected;  // Of them never detected
+  size_t accepts;   // Detections in held-out negative audio
+  double hours;     // Held-out negative audio
+  uint64_t cycles;  // kws_process time over all blocks
+  uint64_t worst;   // Slowest block
+  size_t blocks;    // Blocks processed
+  int64_t wall_us;  // Wall time of the same
+} KwsResult;
+
+static const KwsSyllable kws_keyword[] = {
+    {220, {150, 185}, {700, 450}, {1700, 2200}},
+    {90, {0, 0}, {2500, 2500}, {3300, 3300}},
+    {200, {175, 120}, {500, 420}, {950, 800}},
+};
+
+static KwsClip* kws_clips = NULL;
+static size_t kws_clip_count = 0;
+static size_t kws_set_count[2] = {};
+static Resampler kws_resamplers[KWS_BENCH_MAX_RESAMPLERS];
+static size_t kws_resampler_count = 0;
+static double kws_uniform(double low, double high) {
+  return low + (high - low) * (0.5 + 0.5 * synth_random());
+}
+
+// Pad a clip at the network rate and store it; a keyword clip's end is
+// the last block within KWS_BENCH_END_DB of its loudest block
+static void kws_add(const int16_t* pcm, size_t count, bool positive) {
+  size_t block = KWS_BENCH_RATE * BENCH_FRAME_MS / 1000;
+  size_t lead = KWS_STEPS;
+  size_t body = (count + block - 1) / block;
+  size_t blocks = lead + body + KWS_BENCH_TAIL;
+  int16_t* samples = (int16_t*)malloc(blocks * block * sizeof(int16_t));
+  if (samples == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < blocks * block; i++) {
+    samples[i] = (int16_t)lrint(KWS_BENCH_PAD * synth_random());
+  }
+  memcpy(samples + lead * block, pcm, count * sizeof(int16_t));
+
+  double peak = 0;
+  double* energy = (double*)calloc(body, sizeof(double));
+  for (size_t b = 0; energy != NULL && b < body; b++) {
+    for (size_t i = b * block; i < (b + 1) * block && i < count; i++) {
+      energy[b] += (double)pcm[i] * pcm[i];
+    }
+    peak = energy[b] > peak ? energy[b] : peak;
+  }
+  size_t end = 0;
+  for (size_t b = 0; energy != NULL && b < body; b++) {
+    if (energy[b] >= peak * pow(10, -KWS_BENCH_END_DB / 10.0)) {
+      end = b;
+    }
+  }
+  free(energy);
+
+  if (kws_clip_count % 256 == 0) {
+    kws_clips = (KwsClip*)realloc(kws_clips,
+                                  (kws_clip_count + 256) * sizeof(KwsClip));
+  }
+  KwsClip* clip = &kws_clips[kws_clip_count++];
+  clip->samples = samples;
+  clip->blocks = blocks;
+  clip->end = lead + end;
+  clip->positive = positive;
+  clip->held_out = kws_set_count[positive] % KWS_BENCH_HOLD_OUT ==
+                   KWS_BENCH_HOLD_OUT - 1;
+  kws_set_count[positive]++;
+}
+
+// Convert one file to the network rate; resamplers are kept per rate
+static void kws_load(const char* path, bool positive) {
+  WavAudio wav;
+  if (!wav_read(path, &wav)) {
+    return;
+  }
+  size_t block = wav.sample_rate * BENCH_FRAME_MS / 1000;
+  Resampler* resampler = NULL;
+  for (size_t r = 0; r < kws_resampler_count; r++) {
+    if (kws_resamplers[r].in_rate == wav.sample_rate) {
+      resampler = &kws_resamplers[r];
+    }
+  }
+  if (resampler == NULL && kws_resampler_count < KWS_BENCH_MAX_RESAMPLERS &&
+      resample_init(&kws_resamplers[kws_resampler_count], wav.sample_rate,
+                    KWS_BENCH_RATE, RESAMPLE_HIGH, block)) {
+    resampler = &kws_resamplers[kws_resampler_count++];
+  }
+  if (resampler == NULL) {
+    printf("kws: %s: cannot convert %luHz\n", path,
+           (unsigned long)wav.sample_rate);
+    wav_free(&wav);
+    return;
+  }
+  resample_reset(resampler);
+  size_t blocks = wav.count / block;
+  int16_t* pcm = (int16_t*)malloc(
+      (blocks * resample_output_max(resampler, block) + 1) * sizeof(int16_t));
+  size_t count = 0;
+  for (size_t b = 0; pcm != NULL && b < blocks; b++) {
+    count += resample_process(resampler, wav.samples + b * block, block,
+                              pcm + count);
+  }
+  if (count > 0) {
+    kws_add(pcm, count, positive);
+  }
+  free(pcm);
+  wav_free(&wav);
+}
+
+static void kws_load_entry(const char* path, void* positive) {
+  kws_load(path, *(bool*)positive);
+}
+
+// Two-pole resonator at hz with a 120Hz bandwidth
+static double kws_resonate(double x, double hz, double* state) {
+  double r = exp(-M_PI * 120 / KWS_BENCH_RATE);
+  double c = 2 * r * cos(2 * M_PI * hz / KWS_BENCH_RATE);
+  double y = (1 - r) * x + c * state[0] - r * r * state[1];
+  state[1] = state[0];
+  state[0] = y;
+  return y;
+}
+
+// Cascade formant voice: a harmonic source for voiced syllables, noise for
+// fricatives, through resonators gliding between each syllable's targets.
+// speed, pitch and formant scale the syllables; returns samples written
+static size_t kws_render(const KwsSyllable* syllables, size_t count,
+                         double speed, double pitch, double formant,
+                         double* out, size_t max) {
+  double phase = 0;
+  double first[2] = {};
+  double second[2] = {};
+  size_t n = 0;
+  for (size_t s = 0; s < count; s++) {
+    const KwsSyllable* syllable = &syllables[s];
+    size_t length = (size_t)(syllable->ms * speed * KWS_BENCH_RATE / 1000);
+    for (size_t i = 0; i < length && n < max; i++, n++) {
+      double t = (double)i / length;
+      double f1 = formant * (syllable->f1[0] * (1 - t) + syllable->f1[1] * t);
+      double f2 = formant * (syllable->f2[0] * (1 - t) + syllable->f2[1] * t);
+      double source;
+      if (syllable->pitch[0] > 0) {
+        double hz =
+            pitch * (syllable->pitch[0] * (1 - t) + syllable->pitch[1] * t);
+        phase += 2 * M_PI * hz / KWS_BENCH_RATE;
+        source = 0;
+        for (int k = 1; k * hz < KWS_BENCH_RATE / 2; k++) {
+          source += sin(k * phase) / k;
+        }
+      } else {
+        source = 3 * synth_random();
+      }
+      double y = kws_resonate(kws_resonate(source, f1, first), f2, second);
+      out[n] = y * sin(M_PI * t);
+    }
+    // A short closure between syllables
+    size_t gap = (size_t)(30 * speed * KWS_BENCH_RATE / 1000);
+    for (size_t i = 0; i < gap && n < max; i++, n++) {
+      out[n] = 0;
+    }
+  }
+  return n;
+}
+
+static void kws_random_syllable(KwsSyllable* syllable) {
+  syllable->ms = kws_uniform(80, 260);
+  bool fricative = synth_random() > 0.6;
+  syllable->pitch[0] = fricative ? 0 : kws_uniform(100, 220);
+  syllable->pitch[1] = fricative ? 0 : kws_uniform(100, 220);
+  for (int i = 0; i < 2; i++) {
+    syllable->f1[i] = fricative ? 2500 : kws_uniform(300, 800);
+    syllable->f2[i] = fricative ? 3300 : kws_uniform(800, 2500);
+  }
+}
+
+// One synthetic clip: the keyword at a random place, or for negatives
+// random words, pieces of the keyword, near misses or noise alone, under
+// low-passed background noise at 5-25dB SNR
+static void kws_synth_clip(bool positive, size_t index) {
+  size_t count = (positive ? KWS_BENCH_KEYWORD_MS : KWS_BENCH_OTHER_MS) *
+                 KWS_BENCH_RATE / 1000;
+  double* mix = (double*)calloc(count, sizeof(double));
+  double* word = (double*)calloc(count, sizeof(double));
+  int16_t* pcm = (int16_t*)malloc(count * sizeof(int16_t));
+  if (mix == NULL || word == NULL || pcm == NULL) {
+    free(mix);
+    free(word);
+    free(pcm);
+    return;
+  }
+  double speed = kws_uniform(0.8, 1.25);
+  double pitch = kws_uniform(0.8, 1.25);
+  double formant = kws_uniform(0.85, 1.15);
+  size_t kind = index % 4;
+  size_t position = (size_t)(kws_uniform(0.05, 0.3) * KWS_BENCH_RATE);
+  while (!(kind == 2 && !positive) && position < count) {
+    KwsSyllable syllables[6];
+    size_t syllable_count;
+    if (positive) {
+      memcpy(syllables, kws_keyword, sizeof(kws_keyword));
+      syllable_count = 3;
+    } else if (kind == 1) {
+      // Pieces of the keyword: the first syllable alone, reversed, or
+      // without the fricative
+      size_t piece = (size_t)kws_uniform(0, 2.99);
+      syllables[0] = kws_keyword[piece == 1 ? 2 : 0];
+      syllables[1] = kws_keyword[piece == 1 ? 1 : 2];
+      syllables[2] = kws_keyword[0];
+      syllable_count = piece + 1;
+    } else if (kind == 3) {
+      // Near misses: the keyword with one syllable swapped
+      memcpy(syllables, kws_keyword, sizeof(kws_keyword));
+      kws_random_syllable(&syllables[(size_t)kws_uniform(0, 2.99)]);
+      syllable_count = 3;
+    } else {
+      syllable_count = 1 + (size_t)kws_uniform(0, 3.99);
+      for (size_t s = 0; s < syllable_count; s++) {
+        kws_random_syllable(&syllables[s]);
+      }
+    }
+    size_t length = kws_render(syllables, syllable_count, speed, pitch,
+                               formant, word, count - position);
+    double peak = 1e-9;
+    for (size_t i = 0; i < length; i++) {
+      peak = fmax(peak, fabs(word[i]));
+    }
+    double level = kws_uniform(1500, 12000) / peak;
+    for (size_t i = 0; i < length; i++) {
+      mix[position + i] += word[i] * level;
+    }
+    if (positive) {
+      break;
+    }
+    position += length + (size_t)(kws_uniform(0.1, 0.6) * KWS_BENCH_RATE);
+  }
+
+  double speech = 0;
+  for (size_t i = 0; i < count; i++) {
+    speech += mix[i] * mix[i];
+  }
+  double noise_level = speech > 0
+                           ? sqrt(speech / count) *
+                                 pow(10, -kws_uniform(5, 25) / 20) * 3
+                           : kws_uniform(300, 3000);
+  double tilt = kws_uniform(0.05, 0.5);
+  double wobble = kws_uniform(0.1, 2);
+  double low = 0;
+  for (size_t i = 0; i < count; i++) {
+    low += tilt * (synth_random() - low);
+    double t = (double)i / KWS_BENCH_RATE;
+    double noise = low * (0.7 + 0.3 * sin(2 * M_PI * wobble * t));
+    double v = mix[i] + noise * noise_level;
+    pcm[i] = (int16_t)fmax(-32768.0, fmin(32767.0, lrint(v)));
+  }
+  kws_add(pcm, count, positive);
+  free(pcm);
+  free(word);
+  free(mix);
+}
+
+// Training windows: KWS_BENCH_LABELS from the end of every keyword and
+// every KWS_BENCH_STRIDE-th window of the negatives
+static size_t kws_windows(Kws* kws, int8_t** inputs, uint8_t** labels,
+                          size_t** owners) {
+  size_t block = kws->block;
+  size_t capacity = 0;
+  size_t count = 0;
+  for (size_t c = 0; c < kws_clip_count; c++) {
+    const KwsClip* clip = &kws_clips[c];
+    if (clip->held_out) {
+      continue;
+    }
+    kws_reset(kws);
+    for (size_t b = 0; b < clip->blocks; b++) {
+      if (!kws_push(kws, clip->samples + b * block)) {
+        continue;
+      }
+      bool take = clip->positive
+                      ? b >= clip->end && b < clip->end + KWS_BENCH_LABELS
+                      : b % KWS_BENCH_STRIDE == 0;
+      if (!take) {
+        continue;
+      }
+      if (count == capacity) {
+        capacity = capacity ? capacity * 2 : 4096;
+        *inputs = (int8_t*)realloc(*inputs, capacity * KWS_INPUTS);
+        *labels = (uint8_t*)realloc(*labels, capacity);
+        *owners = (size_t*)realloc(*owners, capacity * sizeof(size_t));
+      }
+      kws_input(kws, *inputs + count * KWS_INPUTS);
+      (*labels)[count] = clip->positive;
+      (*owners)[count] = c;
+      count++;
+    }
+  }
+  return count;
+}
+
+// Hidden activations and the output logit of the float network
+static double kws_forward(const KwsNet* net, const int8_t* input,
+                          double* hidden) {
+  double output = net->b2;
+  for (int h = 0; h < KWS_HIDDEN; h++) {
+    double sum = 0;
+    for (int i = 0; i < KWS_INPUTS; i++) {
+      sum += net->w1[h][i] * input[i];
+    }
+    sum = net->b1[h] + sum / KWS_BENCH_SCALE;
+    hidden[h] = sum > 0 ? sum : 0;
+    output += net->w2[h] * hidden[h];
+  }
+  return output;
+}
+
+// Adam on class-weighted cross-entropy; returns the last epoch's loss
+static double kws_train(KwsNet* net, const int8_t* inputs,
+                        const uint8_t* labels, size_t count) {
+  const size_t params = sizeof(KwsNet) / sizeof(double);
+  double* grad = (double*)calloc(params, sizeof(double));
+  double* m = (double*)calloc(params, sizeof(double));
+  double* v = (double*)calloc(params, sizeof(double));
+  size_t* order = (size_t*)malloc(count * sizeof(size_t));
+  if (grad == NULL || m == NULL || v == NULL || order == NULL) {
+    free(grad);
+    free(m);
+    free(v);
+    free(order);
+    return 0;
+  }
+
+  size_t positives = 0;
+  for (size_t i = 0; i < count; i++) {
+    positives += labels[i];
+    order[i] = i;
+  }
+  double positive_weight =
+      positives ? (double)(count - positives) / positives : 1;
+  double init = sqrt(6.0 / (KWS_INPUTS + KWS_HIDDEN));
+  for (int h = 0; h < KWS_HIDDEN; h++) {
+    for (int i = 0; i < KWS_INPUTS; i++) {
+      net->w1[h][i] = init * synth_random();
+    }
+    net->b1[h] = 0.1;
+    net->w2[h] = sqrt(6.0 / (KWS_HIDDEN + 1)) * synth_random();
+  }
+  net->b2 = 0;
+
+  double loss = 0;
+  size_t step = 0;
+  double* params_base = (double*)net;
+  for (int epoch = 0; epoch < KWS_BENCH_EPOCHS; epoch++) {
+    for (size_t i = count; i > 1; i--) {
+      size_t j = (size_t)((0.5 + 0.5 * synth_random()) * (i - 1) + 0.5);
+      size_t t = order[i - 1];
+      order[i - 1] = order[j];
+      order[j] = t;
+    }
+    loss = 0;
+    for (size_t start = 0; start < count; start += KWS_BENCH_BATCH) {
+      memset(grad, 0, params * sizeof(double));
+      KwsNet* g = (KwsNet*)grad;
+      size_t end = start + KWS_BENCH_BATCH < count ? start + KWS_BENCH_BATCH
+                                                   : count;
+      for (size_t n = start; n < end; n++) {
+        const int8_t* input = inputs + order[n] * KWS_INPUTS;
+        double label = labels[order[n]];
+        double weight = label > 0 ? positive_weight : 1;
+        double hidden[KWS_HIDDEN];
+        double logit = kws_forward(net, input, hidden);
+        double p = 1 / (1 + exp(-logit));
+        loss -= weight * log(label > 0 ? p + 1e-12 : 1 - p + 1e-12);
+        double delta = weight * (p - label);
+        g->b2 += delta;
+        for (int h = 0; h < KWS_HIDDEN; h++) {
+          g->w2[h] += delta * hidden[h];
+          if (hidden[h] <= 0) {
+            continue;
+          }
+          double back = delta * net->w2[h];
+          g->b1[h] += back;
+          for (int i = 0; i < KWS_INPUTS; i++) {
+            g->w1[h][i] += back * input[i] / KWS_BENCH_SCALE;
+          }
+        }
+      }
+      step++;
+      double scale = 1.0 / (end - start);
+      double correct1 = 1 - pow(0.9, step);
+      double correct2 = 1 - pow(0.999, step);
+      for (size_t p = 0; p < params; p++) {
+        double d = grad[p] * scale;
+        m[p] = 0.9 * m[p] + 0.1 * d;
+        v[p] = 0.999 * v[p] + 0.001 * d * d;
+        params_base[p] -= KWS_BENCH_LEARN * (m[p] / correct1) /
+                          (sqrt(v[p] / correct2) + 1e-8);
+      }
+    }
+    loss /= count;
+  }
+  free(order);
+  free(v);
+  free(m);
+  free(grad);
+  return loss;
+}
+
+// Quantize like kws_score: per-layer int8 weights, the hidden accumulator
+// rescaled to int8 activations spanning the largest training activation,
+// the output kept in accumulator units. Returns the logit of one output
+// accumulator unit
+static double kws_quantize(const KwsNet* net, const int8_t* inputs,
+                           size_t count, KwsModel* model) {
+  double largest = 1e-9;
+  for (int h = 0; h < KWS_HIDDEN; h++) {
+    for (int i = 0; i < KWS_INPUTS; i++) {
+      largest = fmax(largest, fabs(net->w1[h][i]) / KWS_BENCH_SCALE);
+    }
+  }
+  double weight_scale = largest / 127;
+  double activation = 1e-9;
+  for (size_t n = 0; n < count; n++) {
+    double hidden[KWS_HIDDEN];
+    kws_forward(net, inputs + n * KWS_INPUTS, hidden);
+    for (int h = 0; h < KWS_HIDDEN; h++) {
+      activation = fmax(activation, hidden[h]);
+    }
+  }
+  double activation_scale = activation / 127;
+  double output_largest = 1e-9;
+  for (int h = 0; h < KWS_HIDDEN; h++) {
+    output_largest = fmax(output_largest, fabs(net->w2[h]));
+  }
+  double output_scale = output_largest / 127;
+
+  for (int h = 0; h < KWS_HIDDEN; h++) {
+    for (int i = 0; i < KWS_INPUTS; i++) {
+      model->hidden_weights[h][i] = (int8_t)lrint(
+          net->w1[h][i] / KWS_BENCH_SCALE / weight_scale);
+    }
+    model->hidden_bias[h] = (int32_t)lrint(net->b1[h] / weight_scale);
+    model->output_weights[h] = (int8_t)lrint(net->w2[h] / output_scale);
+  }
+  model->hidden_scale =
+      (int32_t)lrint(weight_scale / activation_scale * 65536);
+  double unit = output_scale * activation_scale;
+  model->output_bias = (int32_t)lrint(net->b2 / unit);
+  return unit;
+}
+
+static int kws_compare_scores(const void* a, const void* b) {
+  int32_t x = *(const int32_t*)a;
+  int32_t y = *(const int32_t*)b;
+  return x < y ? -1 : x > y;
+}
+
+// Threshold between the loudest training negative and the keyword clips'
+// best windows, keeping at least KWS_BENCH_RECALL of the keywords
+static int32_t kws_threshold(const KwsModel* model, const int8_t* inputs,
+                             const uint8_t* labels, const size_t* owners,
+                             size_t count) {
+  int32_t negative = INT32_MIN;
+  int32_t* best = (int32_t*)malloc(kws_clip_count * sizeof(int32_t));
+  size_t clips = 0;
+  for (size_t n = 0; best != NULL && n < count; n++) {
+    int32_t score = kws_score(model, inputs + n * KWS_INPUTS);
+    if (!labels[n]) {
+      negative = score > negative ? score : negative;
+      continue;
+    }
+    if (n == 0 || owners[n - 1] != owners[n]) {
+      best[clips++] = score;
+    } else if (score > best[clips - 1]) {
+      best[clips - 1] = score;
+    }
+  }
+  if (clips == 0) {
+    free(best);
+    return negative;
+  }
+  qsort(best, clips, sizeof(best[0]), kws_compare_scores);
+  int32_t keep = best[(size_t)((1 - KWS_BENCH_RECALL) * clips)];
+  free(best);
+  return negative < keep ? negative + (keep - negative) / 2 : keep;
+}
+
+// Stream every held-out clip through kws_process
+static void kws_evaluate(Kws* kws, KwsResult* result) {
+  memset(result, 0, sizeof(*result));
+  for (size_t c = 0; c < kws_clip_count; c++) {
+    const KwsClip* clip = &kws_clips[c];
+    if (!clip->held_out) {
+      continue;
+    }
+    kws_reset(kws);
+    size_t detections = 0;
+    for (size_t b = 0; b < clip->blocks; b++) {
+      int64_t start_us = bench_us();
+      uint64_t start = bench_now();
+      detections += kws_process(kws, clip->samples + b * kws->block);
+      uint64_t elapsed = bench_elapsed(start);
+      result->wall_us += bench_us() - start_us;
+      result->cycles += elapsed;
+      result->worst = elapsed > result->worst ? elapsed : result->worst;
+    }
+    result->blocks += clip->blocks;
+    if (clip->positive) {
+      result->keywords++;
+      result->rejected += detections == 0;
+    } else {
+      result->accepts += detections;
+      result->hours += clip->blocks * BENCH_FRAME_MS / 3600000.0;
+    }
+  }
+}
+
+static void kws_write_array(FILE* file, const int32_t* values, size_t count,
+                            const char* indent) {
+  for (size_t i = 0; i < count; i++) {
+    fprintf(file, "%s%ld,%s", i % 10 == 0 ? indent : " ", (long)values[i],
+            i % 10 == 9 || i == count - 1 ? "\n" : "");
+  }
+}
+
+static void kws_write_weights(FILE* file, const int8_t* weights,
+                              size_t count, const char* indent) {
+  int32_t values[KWS_INPUTS];
+  for (size_t i = 0; i < count; i++) {
+    values[i] = weights[i];
+  }
+  kws_write_array(file, values, count, indent);
+}
+
+// Write the model as a kws_model.cpp source for src/
+static void kws_export(const char* path, const KwsModel* model,
+                       const KwsResult* result) {
+  FILE* file = fopen(path, "w");
+  if (file == NULL) {
+    printf("kws: cannot write %s\n", path);
+    return;
+  }
+  fprintf(file,
+          "#include \"kws.h\"\n\n"
+          "// Wake-word network written by the host benchmark (bench_kws.cpp"
+          "\n// with KWS_MODEL_OUT). Trained on %lu keyword and %lu other "
+          "clips;\n// held out: %.1f%% false rejects, %.1f false accepts per"
+          " hour\n",
+          (unsigned long)kws_set_count[1], (unsigned long)kws_set_count[0],
+          result->keywords ? 100.0 * result->rejected / result->keywords : 0,
+          result->hours > 0 ? result->accepts / result->hours : 0);
+  fprintf(file, "const KwsModel kws_model = {\n    \"%s\",\n    {\n",
+          model->keyword);
+  for (int h = 0; h < KWS_HIDDEN; h++) {
+    fprintf(file, "        {\n");
+    kws_write_weights(file, model->hidden_weights[h], KWS_INPUTS,
+                      "            ");
+    fprintf(file, "        },\n");
+  }
+  fprintf(file, "    },\n    {\n");
+  kws_write_array(file, model->hidden_bias, KWS_HIDDEN, "        ");
+  fprintf(file, "    },\n    %ld,\n    {\n", (long)model->hidden_scale);
+  kws_write_weights(file, model->output_weights, KWS_HIDDEN, "        ");
+  fprintf(file, "    },\n    %ld,\n    %ld,\n};\n", (long)model->output_bias,
+          (long)model->threshold);
+  fclose(file);
+  printf("kws: model written to %s\n", path);
+}
+
+void bench_kws() {
+  synth_seed(1);  // Same corpus, training and model on every run
+  const char* positive = getenv("KWS_POSITIVE");
+  const char* negative = getenv("KWS_NEGATIVE");
+  bool keyword = true;
+  bool other = false;
+  if (positive != NULL) {
+    wav_list(positive, KWS_BENCH_MAX_FILES, kws_load_entry, &keyword);
+  }
+  if (negative != NULL) {
+    wav_list(negative, KWS_BENCH_MAX_FILES, kws_load_entry, &other);
+  }
+  for (size_t i = 0; positive == NULL && i < KWS_BENCH_CLIPS; i++) {
+    kws_synth_clip(true, i);
+  }
+  for (size_t i = 0; negative == NULL && i < KWS_BENCH_CLIPS; i++) {
+    kws_synth_clip(false, i);
+  }
+
+  static Kws kws;
+  static KwsNet net;
+  static KwsModel model;
+  size_t block = KWS_BENCH_RATE * BENCH_FRAME_MS / 1000;
+  if (!kws_init(&kws, &model, KWS_BENCH_RATE, block)) {
+    printf("kws: cannot set up at %d Hz\n", KWS_BENCH_RATE);
+    return;
+  }
+  printf("\nkws: %s keyword, %lu keyword / %lu other clips, %d Hz\n",
+         positive != NULL ? positive : "synthetic",
+         (unsigned long)kws_set_count[1], (unsigned long)kws_set_count[0],
+         KWS_BENCH_RATE);
+
+  int8_t* inputs = NULL;
+  uint8_t* labels = NULL;
+  size_t* owners = NULL;
+  size_t count = kws_windows(&kws, &inputs, &labels, &owners);
+  size_t positives = 0;
+  for (size_t n = 0; n < count; n++) {
+    positives += labels[n];
+  }
+  if (positives == 0 || positives == count) {
+    printf("kws: need keyword and other clips to train\n");
+  } else {
+    int64_t start_us = bench_us();
+    double loss = kws_train(&net, inputs, labels, count);
+    printf("kws: %lu keyword and %lu other windows, %d epochs in %.1fs, "
+           "loss %.4f\n",
+           (unsigned long)positives, (unsigned long)(count - positives),
+           KWS_BENCH_EPOCHS, (bench_us() - start_us) / 1e6, loss);
+    const char* keyword = getenv("KWS_KEYWORD");
+    model.keyword = keyword != NULL ? keyword : "synthetic";
+    double unit = kws_quantize(&net, inputs, count, &model);
+    int32_t threshold = kws_threshold(&model, inputs, labels, owners, count);
+
+    // Sweep the threshold around the chosen one, in logit steps
+    KwsResult chosen = {};
+    printf("%10s %8s %9s %12s\n", "threshold", "logit", "reject %",
+           "accepts/h");
+    for (int offset = -4; offset <= 4; offset += 2) {
+      model.threshold = threshold + (int32_t)lrint(offset / unit);
+      KwsResult result;
+      kws_evaluate(&kws, &result);
+      printf("%10ld %8.2f %9.1f %12.1f%s\n", (long)model.threshold,
+             model.threshold * unit,
+             result.keywords ? 100.0 * result.rejected / result.keywords : 0,
+             result.hours > 0 ? result.accepts / result.hours : 0,
+             offset == 0 ? "  <- exported" : "");
+      if (offset == 0) {
+        chosen = result;
+      }
+    }
+    model.threshold = threshold;
+    int64_t frame_us = BENCH_FRAME_MS * 1000;
+    printf("kws: %lu-point FFT, %d bands x %d steps, %d hidden: %llu %s/frame"
+           " (max %llu), %.2f%% of rt\n",
+           (unsigned long)kws.fft.size, KWS_BANDS, KWS_STEPS, KWS_HIDDEN,
+           (unsigned long long)(chosen.blocks ? chosen.cycles / chosen.blocks
+                                              : 0),
+           BENCH_UNIT, (unsigned long long)chosen.worst,
+           chosen.blocks ? 100.0 * chosen.wall_us / (chosen.blocks * frame_us)
+                         : 0.0);
+    const char* out = getenv("KWS_MODEL_OUT");
+    if (out != NULL) {
+      kws_export(out, &model, &chosen);
+    }
+  }
+
+  free(owners);
+  free(labels);
+  free(inputs);
+  for (size_t c = 0; c < kws_clip_count; c++) {
+    free(kws_clips[c].samples);
+  }
+  free(kws_clips);
+  kws_clips = NULL;
+  kws_clip_count = 0;
+}
+#else
+void bench_kws() {
+  printf("\nkws: linux target only\n");
+}
+#endif
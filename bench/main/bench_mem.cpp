@@ -0,0 +1,135 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <opus.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "mem.h"
+#include "synth.h"
+
+// Opus encode time per memory placement: the encoder state, its input and
+// the stack it runs on (Opus keeps its scratch buffers there) are placed in
+// internal SRAM or PSRAM as the firmware's mem_alloc would, and the same
+// speech-like signal is encoded with the firmware's settings at the lowest
+// and highest complexity. Only meaningful on target; the linux build runs
+// every placement from the same host memory
+#define MEM_BENCH_RATE 8000       // Firmware capture rate
+#define MEM_BENCH_FRAMES 250      // 20ms frames encoded per run (5s)
+#define MEM_BENCH_INPUT 50        // Distinct input frames, looped (1s)
+#define MEM_BENCH_STACK 20000     // Same as the firmware's publisher task
+#define MEM_BENCH_BITRATE 30000   // Firmware starting bitrate
+#define MEM_BENCH_PACKET 1276     // Largest Opus packet
+#define MEM_BENCH_COMPLEXITIES 2  // Entries in mem_complexities
+
+typedef struct {
+  const char* name;
+  MemRegion state;  // Encoder state and PCM input
+  MemRegion stack;  // Stack of the encoding task
+} MemPlacement;
+
+static const MemPlacement mem_placements[] = {
+    {"internal", MEM_INTERNAL, MEM_INTERNAL},
+    {"psram-stack", MEM_INTERNAL, MEM_PSRAM},
+    {"psram", MEM_PSRAM, MEM_PSRAM},
+};
+
+static const int mem_complexities[MEM_BENCH_COMPLEXITIES] = {0, 10};
+
+// Encode timing at one complexity
+typedef struct {
+  uint64_t total;  // BENCH_UNIT over all frames
+  uint64_t worst;  // BENCH_UNIT, slowest frame
+  int64_t wall_us;
+} MemTiming;
+
+// One placement, filled in by the encoding task
+typedef struct {
+  const MemPlacement* placement;
+  TaskHandle_t parent;
+  bool ok;
+  MemTiming timings[MEM_BENCH_COMPLEXITIES];
+} MemRun;
+
+static void mem_encode_task(void* user_data) {
+  MemRun* run = (MemRun*)user_data;
+  size_t frame = MEM_BENCH_RATE * BENCH_FRAME_MS / 1000;
+  size_t samples = frame * MEM_BENCH_INPUT;
+  OpusEncoder* encoder = (OpusEncoder*)mem_alloc(run->placement->state,
+                                                 opus_encoder_get_size(1));
+  int16_t* pcm =
+      (int16_t*)mem_alloc(run->placement->state, samples * sizeof(int16_t));
+  uint8_t packet[MEM_BENCH_PACKET];
+  run->ok = encoder != NULL && pcm != NULL;
+  if (run->ok) {
+    synth_seed(1);
+    synth_speech(pcm, samples, MEM_BENCH_RATE, 4000);
+  }
+
+  for (int c = 0; run->ok && c < MEM_BENCH_COMPLEXITIES; c++) {
+    MemTiming* timing = &run->timings[c];
+    if (opus_encoder_init(encoder, MEM_BENCH_RATE, 1, OPUS_APPLICATION_VOIP) !=
+        OPUS_OK) {
+      run->ok = false;
+      break;
+    }
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(MEM_BENCH_BITRATE));
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(mem_complexities[c]));
+    opus_encoder_ctl(encoder, OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE));
+
+    int64_t start_us = bench_us();
+    for (size_t f = 0; f < MEM_BENCH_FRAMES; f++) {
+      const int16_t* in = pcm + (f % MEM_BENCH_INPUT) * frame;
+      uint64_t start = bench_now();
+      opus_encode(encoder, in, frame, packet, sizeof(packet));
+      uint64_t elapsed = bench_elapsed(start);
+      timing->total += elapsed;
+      if (elapsed > timing->worst) {
+        timing->worst = elapsed;
+      }
+    }
+    timing->wall_us = bench_us() - start_us;
+  }
+  xTaskNotifyGive(run->parent);
+  vTaskDelete(NULL);
+}
+
+void bench_mem() {
+  printf("\nmem: opus encode, %d frames of %dms at %dHz\n", MEM_BENCH_FRAMES,
+         BENCH_FRAME_MS, MEM_BENCH_RATE);
+  printf("%-12s %10s %12s %12s %10s\n", "placement", "complexity",
+         BENCH_UNIT "/frame", "worst", "us/frame");
+  size_t count = sizeof(mem_placements) / sizeof(mem_placements[0]);
+  for (size_t i = 0; i < count; i++) {
+    MemRun run = {};
+    run.placement = &mem_placements[i];
+    run.parent = xTaskGetCurrentTaskHandle();
+    if (!mem_task_create(mem_encode_task, "bench_mem", MEM_BENCH_STACK, &run, 5,
+                         NULL, 0, mem_placements[i].stack)) {
+      printf("mem: cannot create task for %s\n", mem_placements[i].name);
+      return;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (!run.ok) {
+      printf("mem: out of memory for %s\n", mem_placements[i].name);
+      return;
+    }
+    for (int c = 0; c < MEM_BENCH_COMPLEXITIES; c++) {
+      const MemTiming* timing = &run.timings[c];
+      printf("%-12s %10d %12llu %12llu %10llu\n", mem_placements[i].name,
+             mem_complexities[c],
+             (unsigned long long)(timing->total / MEM_BENCH_FRAMES),
+             (unsigned long long)timing->worst,
+             (unsigned long long)(timing->wall_us / MEM_BENCH_FRAMES));
+    }
+  }
+
+  for (int region = 0; region < MEM_REGION_COUNT; region++) {
+    MemStats stats;
+    mem_region_stats((MemRegion)region, &stats);
+    printf("mem: %-8s used=%lu reserved=%lu fallbacks=%lu\n",
+           mem_region_name((MemRegion)region), (unsigned long)stats.used,
+           (unsigned long)stats.reserved, (unsigned long)stats.fallbacks);
+  }
+}
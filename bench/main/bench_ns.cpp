@@ -0,0 +1,238 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "ns.h"
+#include "pcm.h"
+#include "synth.h"
+#include "wav.h"
+
+// Noise suppressor benchmark: clean speech mixed with noise at several
+// SNRs, run through the suppressor in 20ms blocks as on the capture path:
+//   NS_SPEECH  clean speech (16-bit WAV; synthetic speech if unset)
+//   NS_NOISE   noise WAVs at the speech rate, comma-separated or a
+//              directory of them, looped to length (synthetic fan, hum and
+//              babble-like noise if unset)
+//   NS_SNR     comma-separated input SNRs in dB (default 0,5,10,20)
+//   NS_OUT     optional prefix; writes <prefix><noise>_<snr>dB.wav
+// Output SNR treats everything but the (delay-aligned) clean speech as
+// noise, so speech distortion counts against it. Noise reduction is the
+// level drop over blocks where the clean speech is silent
+#define NS_BENCH_RATE 8000     // Synthetic signal rate (the codec rate)
+#define NS_BENCH_SECONDS 10    // Synthetic signal length
+#define NS_BENCH_SPEECH 3000   // Synthetic speech RMS-ish level
+#define NS_BENCH_NOISE 8000    // Synthetic noise source amplitude
+#define NS_BENCH_SILENT 30     // Clean block RMS below this is a pause
+#define NS_BENCH_MAX_NOISES 8  // NS_NOISE entries
+#define NS_BENCH_MAX_SNRS 8    // NS_SNR entries
+#define NS_BENCH_NAME 64       // Longest noise name kept
+
+typedef struct {
+  char name[NS_BENCH_NAME];
+  WavAudio wav;
+} NsNoise;
+
+static NsNoise ns_noises[NS_BENCH_MAX_NOISES];
+static size_t ns_noise_count = 0;
+
+static bool ns_alloc(WavAudio* wav, uint32_t rate, size_t count) {
+  wav->sample_rate = rate;
+  wav->count = count;
+  wav->samples = (int16_t*)calloc(count, sizeof(int16_t));
+  return wav->samples != NULL;
+}
+
+// Load one NS_NOISE file if it is at the speech rate
+static void ns_load_noise(const char* path, void* rate) {
+  NsNoise* noise = &ns_noises[ns_noise_count];
+  if (!wav_read(path, &noise->wav)) {
+    return;
+  }
+  if (noise->wav.sample_rate != *(uint32_t*)rate || noise->wav.count == 0) {
+    printf("ns: %s is not at %lu Hz, skipped\n", path,
+           (unsigned long)*(uint32_t*)rate);
+    wav_free(&noise->wav);
+    return;
+  }
+  const char* base = strrchr(path, '/');
+  snprintf(noise->name, sizeof(noise->name), "%s",
+           base != NULL ? base + 1 : path);
+  ns_noise_count++;
+}
+
+// Comma-separated numbers, at most max of them
+static size_t ns_parse_numbers(const char* text, double* values, size_t max) {
+  size_t count = 0;
+  while (*text != '\0' && count < max) {
+    char* end;
+    values[count++] = strtod(text, &end);
+    text = *end == ',' ? end + 1 : "";
+  }
+  return count;
+}
+
+static double ns_energy(const int16_t* samples, size_t count) {
+  double energy = 0;
+  for (size_t i = 0; i < count; i++) {
+    energy += (double)samples[i] * samples[i];
+  }
+  return energy;
+}
+
+// Mix, suppress and score one noise at one SNR
+static void ns_run(NoiseSuppressor* ns, const WavAudio* speech,
+                   const NsNoise* noise, double snr_db, int16_t* mix,
+                   int16_t* out) {
+  size_t frame = speech->sample_rate * BENCH_FRAME_MS / 1000;
+  size_t frames = speech->count / frame;
+  size_t count = frames * frame;
+
+  // Scale the looped noise to the requested SNR over the whole signal
+  double noise_energy = 0;
+  for (size_t i = 0; i < count; i++) {
+    double n = noise->wav.samples[i % noise->wav.count];
+    noise_energy += n * n;
+  }
+  double speech_energy = ns_energy(speech->samples, count);
+  double scale =
+      noise_energy > 0
+          ? sqrt(speech_energy / noise_energy / pow(10, snr_db / 10))
+          : 0;
+  for (size_t i = 0; i < count; i++) {
+    double v =
+        speech->samples[i] + scale * noise->wav.samples[i % noise->wav.count];
+    mix[i] = (int16_t)fmax(-32768.0, fmin(32767.0, lrint(v)));
+  }
+
+  ns_reset(ns);
+  memcpy(out, mix, count * sizeof(int16_t));
+  uint64_t total = 0;
+  uint64_t worst = 0;
+  int64_t wall_us = 0;
+  for (size_t f = 0; f < frames; f++) {
+    int64_t start_us = bench_us();
+    uint64_t start = bench_now();
+    ns_process(ns, out + f * frame, frame);
+    uint64_t elapsed = bench_elapsed(start);
+    wall_us += bench_us() - start_us;
+    total += elapsed;
+    worst = elapsed > worst ? elapsed : worst;
+  }
+
+  // Score after the first second, once the noise estimate has settled,
+  // with the output shifted back by the suppressor's delay
+  size_t delay = ns->overlap;
+  size_t settle = speech->sample_rate;
+  double signal = 0, in_noise = 0, out_noise = 0;
+  double pause_in = 0, pause_out = 0;
+  for (size_t f = settle / frame; f < frames; f++) {
+    size_t base = f * frame;
+    if (base + frame + delay > count) {
+      break;
+    }
+    PcmLevel level;
+    pcm_level(speech->samples + base, frame, &level);
+    for (size_t i = base; i < base + frame; i++) {
+      double s = speech->samples[i];
+      double y = out[i + delay];
+      signal += s * s;
+      in_noise += (mix[i] - s) * (mix[i] - s);
+      out_noise += (y - s) * (y - s);
+      if (level.rms < NS_BENCH_SILENT) {
+        pause_in += (double)mix[i] * mix[i];
+        pause_out += y * y;
+      }
+    }
+  }
+  double snr_in = 10 * log10((signal + 1) / (in_noise + 1));
+  double snr_out = 10 * log10((signal + 1) / (out_noise + 1));
+  double reduction = 10 * log10((pause_in + 1) / (pause_out + 1));
+  int64_t frame_us = BENCH_FRAME_MS * 1000;
+  printf("%-16s %6.1f %7.1f %7.1f %9.1f %10llu %9llu %7.2f%%\n", noise->name,
+         snr_in, snr_out, snr_out - snr_in, reduction,
+         (unsigned long long)(frames ? total / frames : 0),
+         (unsigned long long)worst,
+         frames ? 100.0 * wall_us / (frames * frame_us) : 0.0);
+
+  const char* prefix = getenv("NS_OUT");
+  if (prefix != NULL) {
+    char path[256];
+    if (snprintf(path, sizeof(path), "%s%s_%ddB.wav", prefix, noise->name,
+                 (int)lrint(snr_db)) < (int)sizeof(path)) {
+      wav_write(path, out, count, speech->sample_rate);
+    }
+  }
+}
+
+void bench_ns() {
+  WavAudio speech;
+  const char* speech_path = getenv("NS_SPEECH");
+  if (speech_path != NULL) {
+    if (!wav_read(speech_path, &speech)) {
+      return;
+    }
+  } else if (ns_alloc(&speech, NS_BENCH_RATE,
+                      NS_BENCH_RATE * NS_BENCH_SECONDS)) {
+    synth_seed(1);
+    synth_speech(speech.samples, speech.count, NS_BENCH_RATE,
+                 NS_BENCH_SPEECH * 2);
+  } else {
+    printf("ns: out of memory\n");
+    return;
+  }
+  uint32_t rate = speech.sample_rate;
+
+  ns_noise_count = 0;
+  const char* noise_list = getenv("NS_NOISE");
+  if (noise_list != NULL) {
+    wav_list(noise_list, NS_BENCH_MAX_NOISES, ns_load_noise, &rate);
+  } else {
+    for (int kind = SYNTH_FAN; kind <= SYNTH_BABBLE; kind++) {
+      NsNoise* noise = &ns_noises[ns_noise_count];
+      if (!ns_alloc(&noise->wav, rate, speech.count)) {
+        break;
+      }
+      snprintf(noise->name, sizeof(noise->name), "%s",
+               synth_noise_name((SynthNoise)kind));
+      synth_noise(noise->wav.samples, speech.count, rate, (SynthNoise)kind,
+                  NS_BENCH_NOISE);
+      ns_noise_count++;
+    }
+  }
+
+  double snrs[NS_BENCH_MAX_SNRS];
+  const char* snr_env = getenv("NS_SNR");
+  size_t snr_count = ns_parse_numbers(snr_env != NULL ? snr_env : "0,5,10,20",
+                                      snrs, NS_BENCH_MAX_SNRS);
+
+  size_t frame = rate * BENCH_FRAME_MS / 1000;
+  NoiseSuppressor* ns = (NoiseSuppressor*)malloc(sizeof(NoiseSuppressor));
+  int16_t* mix = (int16_t*)malloc(speech.count * sizeof(int16_t));
+  int16_t* out = (int16_t*)malloc(speech.count * sizeof(int16_t));
+  if (ns == NULL || mix == NULL || out == NULL || !ns_init(ns, frame)) {
+    printf("ns: cannot set up at %lu Hz\n", (unsigned long)rate);
+  } else {
+    printf("\nns: %s, %lu Hz, %lu-point FFT, %lu ms delay\n",
+           speech_path != NULL ? speech_path : "synthetic speech",
+           (unsigned long)rate, (unsigned long)ns->fft.size,
+           (unsigned long)(ns->overlap * 1000 / rate));
+    printf("%-16s %6s %7s %7s %9s %10s %9s %8s\n", "noise", "snr in",
+           "snr out", "gain dB", "reduce dB", BENCH_UNIT "/frame", "max",
+           "of rt");
+    for (size_t n = 0; n < ns_noise_count; n++) {
+      for (size_t s = 0; s < snr_count; s++) {
+        ns_run(ns, &speech, &ns_noises[n], snrs[s], mix, out);
+      }
+    }
+  }
+
+  free(out);
+  free(mix);
+  free(ns);
+  for (size_t n = 0; n < ns_noise_count; n++) {
+    wav_free(&ns_noises[n].wav);
+  }
+  wav_free(&speech);
+}
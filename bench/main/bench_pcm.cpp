@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "pcm.h"
+
+#define PCM_MAX_FRAME 960  // 20 ms at 48 kHz
+
+static const int pcm_rates[] = {16000, 24000, 48000};
+
+// 16-byte aligned so the vector paths are taken
+static int16_t mono[PCM_MAX_FRAME] __attribute__((aligned(16)));
+static int16_t stereo[PCM_MAX_FRAME * 2] __attribute__((aligned(16)));
+static int16_t out_ref[PCM_MAX_FRAME * 2] __attribute__((aligned(16)));
+static int16_t out_fast[PCM_MAX_FRAME * 2] __attribute__((aligned(16)));
+static int32_t wide_ref[PCM_MAX_FRAME] __attribute__((aligned(16)));
+static int32_t wide_fast[PCM_MAX_FRAME] __attribute__((aligned(16)));
+static int16_t taps[PCM_MAX_FRAME] __attribute__((aligned(16)));
+
+typedef void (*PcmKernel)(size_t samples, bool reference);
+
+static void run_gain(size_t samples, bool reference) {
+  if (reference) {
+    pcm_gain_ref(mono, out_ref, samples, PCM_GAIN_UNITY * 3);
+  } else {
+    pcm_gain(mono, out_fast, samples, PCM_GAIN_UNITY * 3);
+  }
+}
+
+static void run_mono_to_stereo(size_t samples, bool reference) {
+  if (reference) {
+    pcm_mono_to_stereo_ref(mono, out_ref, samples);
+  } else {
+    pcm_mono_to_stereo(mono, out_fast, samples);
+  }
+}
+
+static void run_stereo_to_mono(size_t samples, bool reference) {
+  if (reference) {
+    pcm_stereo_to_mono_ref(stereo, out_ref, samples);
+  } else {
+    pcm_stereo_to_mono(stereo, out_fast, samples);
+  }
+}
+
+static void run_s16_to_s32(size_t samples, bool reference) {
+  if (reference) {
+    pcm_s16_to_s32_ref(mono, wide_ref, samples, 16);
+  } else {
+    pcm_s16_to_s32(mono, wide_fast, samples, 16);
+  }
+}
+
+static void run_s32_to_s16(size_t samples, bool reference) {
+  if (reference) {
+    pcm_s32_to_s16_ref(wide_ref, out_ref, samples, 14);
+  } else {
+    pcm_s32_to_s16(wide_ref, out_fast, samples, 14);
+  }
+}
+
+static void run_level(size_t samples, bool reference) {
+  PcmLevel level;
+  if (reference) {
+    pcm_level_ref(mono, samples, &level);
+    out_ref[0] = (int16_t)level.rms;
+  } else {
+    pcm_level(mono, samples, &level);
+    out_fast[0] = (int16_t)level.rms;
+  }
+}
+
+static void run_dot(size_t samples, bool reference) {
+  if (reference) {
+    wide_ref[0] = pcm_dot_ref(taps, mono, samples);
+  } else {
+    wide_fast[0] = pcm_dot(taps, mono, samples);
+  }
+}
+
+typedef struct {
+  const char* name;
+  PcmKernel run;
+  int output_scale;  // Output samples per input sample
+} PcmBench;
+
+static const PcmBench pcm_benches[] = {
+    {"gain x3", run_gain, 1},
+    {"mono->stereo", run_mono_to_stereo, 2},
+    {"stereo->mono", run_stereo_to_mono, 1},
+    {"s16->s32", run_s16_to_s32, 0},
+    {"s32->s16", run_s32_to_s16, 1},
+    {"peak/rms", run_level, 0},
+    {"dot", run_dot, 0},
+};
+
+// Mean time of one call, after a warm-up call to fill caches
+static uint64_t time_kernel(PcmKernel run, size_t samples, bool reference) {
+  run(samples, reference);
+  uint64_t start = bench_now();
+  for (int i = 0; i < BENCH_ITERATIONS; i++) {
+    run(samples, reference);
+  }
+  return bench_elapsed(start) / BENCH_ITERATIONS;
+}
+
+// Largest sample difference between the reference and dispatched outputs
+// (mismatch count for the kernels with 32-bit outputs)
+static int max_difference(const PcmBench* bench, size_t samples) {
+  int diff = 0;
+  if (bench->run == run_dot) {
+    return wide_ref[0] != wide_fast[0];
+  }
+  if (bench->run == run_s16_to_s32) {
+    for (size_t i = 0; i < samples; i++) {
+      if (wide_ref[i] != wide_fast[i]) {
+        diff++;
+      }
+    }
+    return diff;
+  }
+  size_t count = bench->output_scale ? samples * bench->output_scale : 1;
+  for (size_t i = 0; i < count; i++) {
+    int d = abs(out_ref[i] - out_fast[i]);
+    if (d > diff) {
+      diff = d;
+    }
+  }
+  return diff;
+}
+
+// Speech-like test signal: two tones plus noise, peaking near full scale
+// so the saturating paths are exercised
+static void fill_input() {
+  uint32_t seed = 1;
+  for (int i = 0; i < PCM_MAX_FRAME; i++) {
+    seed = seed * 1664525 + 1013904223;
+    int32_t noise = (int32_t)(seed >> 20) - 2048;
+    int32_t tone = ((i * 37) % 200 - 100) * 200 + ((i * 11) % 64 - 32) * 100;
+    mono[i] = (int16_t)(tone + noise);
+    stereo[i * 2] = mono[i];
+    stereo[i * 2 + 1] = (int16_t)(-mono[i] / 2 + noise);
+    taps[i] = (int16_t)((i * 7) % 64 - 32);  // Small enough not to overflow
+  }
+  pcm_s16_to_s32_ref(mono, wide_ref, PCM_MAX_FRAME, 16);
+}
+
+void bench_pcm() {
+  fill_input();
+
+  printf("\npcm kernels, %s per %d ms frame\n", BENCH_UNIT, BENCH_FRAME_MS);
+  printf("%-14s %6s %10s %10s %8s %8s\n", "kernel", "rate", "scalar", "simd",
+         "speedup", "maxdiff");
+  for (size_t b = 0; b < sizeof(pcm_benches) / sizeof(pcm_benches[0]); b++) {
+    const PcmBench* bench = &pcm_benches[b];
+    for (size_t r = 0; r < sizeof(pcm_rates) / sizeof(pcm_rates[0]); r++) {
+      size_t samples = pcm_rates[r] * BENCH_FRAME_MS / 1000;
+      uint64_t scalar = time_kernel(bench->run, samples, true);
+      uint64_t simd = time_kernel(bench->run, samples, false);
+      printf("%-14s %6d %10llu %10llu %7.2fx %8d\n", bench->name,
+             pcm_rates[r], (unsigned long long)scalar,
+             (unsigned long long)simd,
+             simd ? (double)scalar / (double)simd : 0.0,
+             max_difference(bench, samples));
+    }
+  }
+}
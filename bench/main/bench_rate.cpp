@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "rate_control.h"
+
+// Rate controller simulation: an Opus sender using the controller's bitrate
+// and frame duration feeds a drop-tail bottleneck replayed from a trace, and
+// loss, round trip and jitter are reported back every RATE_CONTROL_INTERVAL_MS
+//   RATE_TRACE  CSV trace, one segment per line:
+//               seconds,bandwidth_kbps,loss_percent,rtt_ms
+//               (rtt 0 reports jitter only, like the firmware does)
+// Every segment is run with the controller and with the fixed top rate
+#define RATE_BENCH_OVERHEAD 50   // IP/UDP/RTP/SRTP bytes per packet
+#define RATE_BENCH_QUEUE_MS 300  // Bottleneck buffer before tail drop
+#define RATE_BENCH_MAX_SEGMENTS 64
+
+typedef struct {
+  uint32_t seconds;
+  uint32_t bandwidth_kbps;
+  uint32_t loss_percent;  // Random loss on top of congestion
+  uint32_t rtt_ms;        // Base round trip, 0 for unknown
+} RateSegment;
+
+// Wi-Fi session with interference, congestion and a loss burst
+static const RateSegment rate_default_trace[] = {
+    {20, 200, 0, 40}, {20, 200, 5, 40},  {20, 24, 0, 60}, {20, 16, 1, 80},
+    {30, 200, 0, 40}, {10, 200, 25, 40}, {30, 200, 0, 40},
+};
+
+// Per-segment outcome
+typedef struct {
+  uint64_t bits;          // Payload bits sent
+  uint32_t packets;       // Packets sent
+  uint32_t lost;          // Packets lost on the link
+  uint32_t frames;        // 20ms frames sent
+  uint32_t unrecovered;   // Frames lost and not recovered by FEC
+  uint32_t fec_packets;   // Packets sent with in-band FEC
+  uint64_t frame_ms_sum;  // Frame duration summed over packets
+  uint64_t queue_ms_sum;  // Queueing delay summed over delivered packets
+} RateResult;
+
+static uint32_t rate_seed = 1;
+
+static uint32_t rate_random() {
+  rate_seed = rate_seed * 1664525 + 1013904223;
+  return rate_seed >> 8;
+}
+
+// Read a trace file into segments, returns the segment count (0 on error)
+static size_t rate_read_trace(const char* path, RateSegment* segments) {
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    printf("rate: cannot open %s\n", path);
+    return 0;
+  }
+  size_t count = 0;
+  char line[128];
+  while (count < RATE_BENCH_MAX_SEGMENTS && fgets(line, sizeof(line), file)) {
+    unsigned long seconds, bandwidth, loss, rtt;
+    if (line[0] == '#' || sscanf(line, "%lu,%lu,%lu,%lu", &seconds, &bandwidth,
+                                 &loss, &rtt) != 4) {
+      continue;
+    }
+    RateSegment* segment = &segments[count++];
+    segment->seconds = seconds;
+    segment->bandwidth_kbps = bandwidth > 0 ? bandwidth : 1;
+    segment->loss_percent = loss;
+    segment->rtt_ms = rtt;
+  }
+  fclose(file);
+  return count;
+}
+
+// Run the whole trace; adaptive false keeps the controller's first settings
+static void rate_simulate(const RateSegment* trace, size_t count,
+                          bool adaptive, RateResult* results) {
+  RateControl rc;
+  rate_control_init(&rc, 0);
+  rate_seed = 1;
+  memset(results, 0, count * sizeof(RateResult));
+
+  const int64_t frame_us = BENCH_FRAME_MS * 1000;
+  int64_t now_us = 0;
+  int64_t report_us = 0;
+  double queue_bytes = 0;
+  uint32_t pending = 0;  // Frames waiting for the current packet
+  uint32_t report_sent = 0;
+  uint32_t report_lost = 0;
+  RateResult* previous_lost = NULL;  // Result of a lost last packet
+  double last_delay_ms = -1;
+  double jitter_ms = 0;
+
+  for (size_t s = 0; s < count; s++) {
+    const RateSegment* segment = &trace[s];
+    RateResult* result = &results[s];
+    int64_t end_us = now_us + (int64_t)segment->seconds * 1000000;
+    for (; now_us < end_us; now_us += frame_us) {
+      // Link drains at its bandwidth (kbps == bits per ms)
+      queue_bytes -= segment->bandwidth_kbps * BENCH_FRAME_MS / 8.0;
+      if (queue_bytes < 0) {
+        queue_bytes = 0;
+      }
+      double queue_ms = queue_bytes * 8 / segment->bandwidth_kbps;
+
+      if (adaptive && now_us - report_us >= RATE_CONTROL_INTERVAL_MS * 1000) {
+        report_us = now_us;
+        if (report_sent > 0) {
+          RateFeedback feedback;
+          feedback.fraction_lost = (uint8_t)(report_lost * 255 / report_sent);
+          feedback.rtt_ms =
+              segment->rtt_ms > 0 ? segment->rtt_ms + (uint32_t)queue_ms : 0;
+          feedback.jitter_ms = (uint32_t)jitter_ms;
+          rate_control_update(&rc, &feedback, now_us);
+        }
+        report_sent = 0;
+        report_lost = 0;
+      }
+
+      uint32_t packet_frames = rc.settings.frame_ms / BENCH_FRAME_MS;
+      if (++pending < packet_frames) {
+        continue;
+      }
+      uint32_t payload = rc.settings.bitrate * rc.settings.frame_ms / 8000;
+      uint32_t size = payload + RATE_BENCH_OVERHEAD;
+      double limit = segment->bandwidth_kbps * RATE_BENCH_QUEUE_MS / 8.0;
+      bool lost = queue_bytes + size > limit;
+      if (!lost) {
+        queue_bytes += size;
+        lost = rate_random() % 100 < segment->loss_percent;
+      }
+
+      result->bits += payload * 8;
+      result->packets++;
+      result->frames += pending;
+      result->frame_ms_sum += rc.settings.frame_ms;
+      result->fec_packets += rc.settings.fec ? 1 : 0;
+      report_sent++;
+      if (lost) {
+        result->lost++;
+        result->unrecovered += pending;
+        report_lost++;
+      } else {
+        // In-band FEC carries the last 20ms frame of the previous packet
+        if (previous_lost != NULL && rc.settings.fec) {
+          previous_lost->unrecovered--;
+        }
+        result->queue_ms_sum += (uint64_t)queue_ms;
+        if (last_delay_ms >= 0) {
+          double d = queue_ms - last_delay_ms;
+          jitter_ms += ((d < 0 ? -d : d) - jitter_ms) / 16;
+        }
+        last_delay_ms = queue_ms;
+      }
+      previous_lost = lost ? result : NULL;
+      pending = 0;
+    }
+  }
+
+  if (adaptive) {
+    printf("rate: reports %lu, decreases %lu, increases %lu, failed probes "
+           "%lu, fec changes %lu\n",
+           (unsigned long)rc.stats.reports, (unsigned long)rc.stats.decreases,
+           (unsigned long)rc.stats.increases,
+           (unsigned long)rc.stats.failed_probes,
+           (unsigned long)rc.stats.fec_changes);
+  }
+}
+
+static double rate_percent(uint32_t part, uint32_t whole) {
+  return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+void bench_rate() {
+  RateSegment segments[RATE_BENCH_MAX_SEGMENTS];
+  const RateSegment* trace = rate_default_trace;
+  size_t count = sizeof(rate_default_trace) / sizeof(rate_default_trace[0]);
+  const char* path = getenv("RATE_TRACE");
+  if (path != NULL) {
+    count = rate_read_trace(path, segments);
+    if (count == 0) {
+      return;
+    }
+    trace = segments;
+  }
+
+  RateResult* adaptive = (RateResult*)malloc(count * sizeof(RateResult));
+  RateResult* fixed = (RateResult*)malloc(count * sizeof(RateResult));
+  if (adaptive == NULL || fixed == NULL) {
+    printf("rate: out of memory\n");
+    free(adaptive);
+    free(fixed);
+    return;
+  }
+
+  printf("\nrate: %s, %lu segments\n", path != NULL ? path : "built-in trace",
+         (unsigned long)count);
+  rate_simulate(trace, count, true, adaptive);
+  rate_simulate(trace, count, false, fixed);
+
+  printf("rate: %4s %6s %5s | %5s %5s %4s %6s %6s %6s | %6s %6s %6s\n", "secs",
+         "link", "loss", "kbps", "frame", "fec", "lost", "unrec", "queue",
+         "lost", "unrec", "queue");
+  for (size_t s = 0; s < count; s++) {
+    const RateSegment* segment = &trace[s];
+    const RateResult* a = &adaptive[s];
+    const RateResult* f = &fixed[s];
+    uint32_t a_delivered = a->packets - a->lost;
+    uint32_t f_delivered = f->packets - f->lost;
+    printf("rate: %4lu %6lu %4lu%% | %5.1f %3lums %3.0f%% %5.1f%% %5.1f%% "
+           "%4lums | %5.1f%% %5.1f%% %4lums\n",
+           (unsigned long)segment->seconds,
+           (unsigned long)segment->bandwidth_kbps,
+           (unsigned long)segment->loss_percent,
+           a->bits / 1000.0 / segment->seconds,
+           (unsigned long)(a->packets ? a->frame_ms_sum / a->packets : 0),
+           rate_percent(a->fec_packets, a->packets),
+           rate_percent(a->lost, a->packets),
+           rate_percent(a->unrecovered, a->frames),
+           (unsigned long)(a_delivered ? a->queue_ms_sum / a_delivered : 0),
+           rate_percent(f->lost, f->packets),
+           rate_percent(f->unrecovered, f->frames),
+           (unsigned long)(f_delivered ? f->queue_ms_sum / f_delivered : 0));
+  }
+
+  free(adaptive);
+  free(fixed);
+}
@@ -0,0 +1,159 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "resample.h"
+
+// Resampler cost and quality for each rate pair the firmware can run
+// between the I2S clock and Opus. Cost is per output sample over 20ms
+// blocks. Quality is measured on pure tones once the filter has settled:
+// SNR of a 1kHz tone (everything that is not the tone counts as noise:
+// images, aliases, coefficient and output rounding), passband ripple as the
+// spread of tone gains up to 3.4kHz-equivalent, and for down-conversion the
+// level of a tone above the output Nyquist frequency that would alias
+#define RESAMPLE_BENCH_MAX_FRAME 960  // 20ms at 48kHz
+#define RESAMPLE_BENCH_FRAMES 25      // Frames per tone measurement (0.5s)
+#define RESAMPLE_BENCH_SETTLE 5       // Frames skipped while the filter fills
+#define RESAMPLE_BENCH_AMPLITUDE 16000
+#define RESAMPLE_BENCH_TONE 1000       // Hz, SNR tone
+#define RESAMPLE_BENCH_PASSBAND 0.85   // Of the lower Nyquist (3.4kHz at 8kHz)
+#define RESAMPLE_BENCH_RIPPLE_STEPS 16  // Tones across the passband
+#define RESAMPLE_BENCH_ALIAS 0.75      // Alias tone, of the output rate
+
+typedef struct {
+  uint32_t in_rate;
+  uint32_t out_rate;
+} ResamplePair;
+
+static const ResamplePair resample_pairs[] = {
+    {16000, 8000},  {8000, 16000}, {48000, 8000},
+    {8000, 48000},  {48000, 16000}, {16000, 48000},
+};
+
+static int16_t resample_in[RESAMPLE_BENCH_MAX_FRAME]
+    __attribute__((aligned(16)));
+static int16_t resample_out[RESAMPLE_BENCH_MAX_FRAME * 2]
+    __attribute__((aligned(16)));
+static int16_t resample_capture[RESAMPLE_BENCH_MAX_FRAME * 2 *
+                                RESAMPLE_BENCH_FRAMES];
+
+// Tone fitted to the settled output: gain relative to the input amplitude,
+// SNR of the fit and RMS of the whole output relative to the input RMS.
+// Noise and level are floored at the rounding noise of 16-bit output
+typedef struct {
+  double gain;
+  double snr_db;
+  double level_db;
+} ResampleTone;
+
+static void resample_tone(Resampler* r, double freq, ResampleTone* tone) {
+  resample_reset(r);
+  size_t frame = r->in_rate * BENCH_FRAME_MS / 1000;
+  size_t total = 0;
+  size_t settled = 0;
+  for (size_t f = 0; f < RESAMPLE_BENCH_FRAMES; f++) {
+    for (size_t i = 0; i < frame; i++) {
+      double t = (double)(f * frame + i) / r->in_rate;
+      resample_in[i] =
+          (int16_t)lrint(RESAMPLE_BENCH_AMPLITUDE * sin(2 * M_PI * freq * t));
+    }
+    total += resample_process(r, resample_in, frame, resample_capture + total);
+    if (f + 1 == RESAMPLE_BENCH_SETTLE) {
+      settled = total;
+    }
+  }
+
+  // Least-squares fit of a sin/cos pair at the tone frequency
+  double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0, yy = 0;
+  for (size_t i = settled; i < total; i++) {
+    double w = 2 * M_PI * freq * i / r->out_rate;
+    double s = sin(w);
+    double c = cos(w);
+    double y = resample_capture[i];
+    ss += s * s;
+    sc += s * c;
+    cc += c * c;
+    ys += y * s;
+    yc += y * c;
+    yy += y * y;
+  }
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det;
+  double b = (yc * ss - ys * sc) / det;
+  double fitted = a * ys + b * yc;  // Energy of the fitted tone
+  double residual = yy - fitted;
+  size_t count = total - settled;
+  double input_energy =
+      (double)RESAMPLE_BENCH_AMPLITUDE * RESAMPLE_BENCH_AMPLITUDE / 2 * count;
+  tone->gain = sqrt(a * a + b * b) / RESAMPLE_BENCH_AMPLITUDE;
+  double floor = count / 12.0;  // LSB^2 / 12 per sample
+  tone->snr_db = 10 * log10(fitted / (residual > floor ? residual : floor));
+  tone->level_db = 10 * log10((yy > floor ? yy : floor) / input_energy);
+}
+
+// Mean time of one 20ms block through a running resampler
+static uint64_t resample_time(Resampler* r) {
+  size_t frame = r->in_rate * BENCH_FRAME_MS / 1000;
+  for (size_t i = 0; i < frame; i++) {
+    resample_in[i] = (int16_t)((i * 37) % 200 * 160 - 16000);
+  }
+  resample_process(r, resample_in, frame, resample_out);
+  uint64_t start = bench_now();
+  for (int i = 0; i < BENCH_ITERATIONS; i++) {
+    resample_process(r, resample_in, frame, resample_out);
+  }
+  return bench_elapsed(start) / BENCH_ITERATIONS;
+}
+
+void bench_resample() {
+  printf("\nresample: %s per output sample, quality on tones\n", BENCH_UNIT);
+  printf("%-12s %-7s %5s %9s %8s %10s %9s\n", "convert", "quality", "taps",
+         BENCH_UNIT "/out", "snr dB", "ripple dB", "alias dB");
+  for (size_t p = 0; p < sizeof(resample_pairs) / sizeof(resample_pairs[0]);
+       p++) {
+    const ResamplePair* pair = &resample_pairs[p];
+    uint32_t lower =
+        pair->in_rate < pair->out_rate ? pair->in_rate : pair->out_rate;
+    char name[24];
+    snprintf(name, sizeof(name), "%lu->%lu",
+             (unsigned long)(pair->in_rate / 1000),
+             (unsigned long)(pair->out_rate / 1000));
+
+    for (int q = 0; q < RESAMPLE_QUALITY_COUNT; q++) {
+      Resampler r;
+      size_t frame = pair->in_rate * BENCH_FRAME_MS / 1000;
+      if (!resample_init(&r, pair->in_rate, pair->out_rate,
+                         (ResampleQuality)q, frame)) {
+        printf("resample: cannot set up %s\n", name);
+        return;
+      }
+      size_t outputs = pair->out_rate * BENCH_FRAME_MS / 1000;
+      uint64_t elapsed = resample_time(&r);
+
+      ResampleTone tone;
+      resample_tone(&r, RESAMPLE_BENCH_TONE, &tone);
+      double snr_db = tone.snr_db;
+
+      double low = 1e9, high = 0;
+      double edge = RESAMPLE_BENCH_PASSBAND * lower / 2;
+      for (int s = 0; s < RESAMPLE_BENCH_RIPPLE_STEPS; s++) {
+        double freq =
+            100 + (edge - 100) * s / (RESAMPLE_BENCH_RIPPLE_STEPS - 1);
+        resample_tone(&r, freq, &tone);
+        low = tone.gain < low ? tone.gain : low;
+        high = tone.gain > high ? tone.gain : high;
+      }
+      double ripple_db = 20 * log10(high / low);
+
+      char alias[16] = "-";
+      if (pair->out_rate < pair->in_rate) {
+        resample_tone(&r, RESAMPLE_BENCH_ALIAS * pair->out_rate, &tone);
+        snprintf(alias, sizeof(alias), "%.1f", tone.level_db);
+      }
+      printf("%-12s %-7s %5lu %9.2f %8.1f %10.3f %9s\n", name,
+             resample_quality_name((ResampleQuality)q), (unsigned long)r.taps,
+             (double)elapsed / outputs, snr_db, ripple_db, alias);
+    }
+  }
+}
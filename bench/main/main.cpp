@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "mem.h"
+
+typedef struct {
+  const char* name;
+  void (*run)(void);
+} BenchEntry;
+
+static const BenchEntry benches[] = {
+    {"pcm", bench_pcm},
+    {"resample", bench_resample},
+    {"dsp", bench_dsp},
+    {"ns", bench_ns},
+    {"kws", bench_kws},
+    {"aec", bench_aec},
+    {"rate", bench_rate},
+    {"signaling", bench_signaling},
+    {"events", bench_events},
+    {"mem", bench_mem},
+    {"codec", bench_codec},
+};
+
+// BENCH=pcm,codec runs only the named benchmarks; all of them when unset
+static bool bench_selected(const char* name) {
+  const char* list = getenv("BENCH");
+  if (list == NULL) {
+    return true;
+  }
+  size_t length = strlen(name);
+  for (const char* p = list; (p = strstr(p, name)) != NULL; p += length) {
+    bool starts = p == list || p[-1] == ',';
+    bool ends = p[length] == '\0' || p[length] == ',';
+    if (starts && ends) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Standalone benchmarks for the audio kernels in src/
+// Build for the board to get cycle counts on the ESP32-S3, or for the
+// linux target to compare against the host SIMD paths:
+//   idf.py --preview set-target linux && idf.py build && ./build/bench.elf
+extern "C" void app_main(void) {
+  printf("bench: timing unit %s, %d iterations\n", BENCH_UNIT,
+         BENCH_ITERATIONS);
+  mem_init();  // The kernels place their buffers like the firmware does
+  for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+    if (bench_selected(benches[i].name)) {
+      benches[i].run();
+    }
+  }
+
+#if CONFIG_IDF_TARGET_LINUX
+  exit(0);
+#endif
+}
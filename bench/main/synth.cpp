@@ -0,0 +1,85 @@
+#include "synth.h"
+
+#include <math.h>
+
+static uint32_t synth_state = 1;
+
+static int16_t synth_clip(double v) {
+  return (int16_t)fmax(-32768.0, fmin(32767.0, v));
+}
+
+void synth_seed(uint32_t seed) { synth_state = seed; }
+
+uint32_t synth_bits() {
+  synth_state = synth_state * 1664525 + 1013904223;
+  return synth_state >> 8;
+}
+
+double synth_random() { return synth_bits() / 8388608.0 - 1.0; }
+
+void synth_speech(int16_t* out, size_t count, uint32_t rate, int32_t level) {
+  size_t syllable = rate / 5;
+  double phase = 0;
+  double lowpass = 0;
+  double base = 0;
+  double glide = 0;
+  double sweep = 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t n = i / syllable;
+    double t = (double)(i % syllable) / syllable;
+    if (i % syllable == 0) {
+      // Every syllable gets its own pitch contour and formant sweep
+      base = 120 + 30 * synth_random();
+      glide = 25 + 55 * synth_random();
+      sweep = synth_random();
+    }
+    double pitch = base + glide * t;
+    phase += 2 * M_PI * pitch / rate;
+    double voice = 0;
+    for (int k = 1; k <= 30 && k * pitch < rate / 2; k++) {
+      voice += sin(k * phase) / k;
+    }
+    double noise = synth_random();
+    double sample;
+    if (n % 6 == 5) {
+      sample = t < 0.4 ? 0.25 * noise : 0;  // Fricative, then a pause
+    } else {
+      double formant = 0.15 + 0.35 * (0.5 + 0.5 * sin(2 * M_PI * (sweep + t)));
+      lowpass += formant * (voice - lowpass);
+      sample = lowpass * sin(M_PI * t);
+    }
+    out[i] = synth_clip(sample * level);
+  }
+}
+
+void synth_noise(int16_t* out, size_t count, uint32_t rate, SynthNoise kind,
+                 int32_t level) {
+  double low = 0;
+  double band = 0;
+  for (size_t i = 0; i < count; i++) {
+    double t = (double)i / rate;
+    double white = synth_random();
+    double sample = white;
+    if (kind == SYNTH_FAN) {
+      low += 0.15 * (white - low);
+      sample = 3 * low;
+    } else if (kind == SYNTH_HUM) {
+      sample = 0.1 * white;
+      for (int h = 1; h <= 6; h++) {
+        sample += sin(2 * M_PI * 50 * h * t) / h;
+      }
+      sample *= 0.5;
+    } else if (kind == SYNTH_BABBLE) {
+      double tilt = 0.3 + 0.25 * sin(2 * M_PI * 0.7 * t);
+      band += tilt * (white - band);
+      sample = band * (0.6 + 0.4 * sin(2 * M_PI * 0.3 * t));
+    }
+    out[i] = synth_clip(sample * level);
+  }
+}
+
+const char* synth_noise_name(SynthNoise kind) {
+  static const char* names[SYNTH_NOISE_COUNT] = {"white", "fan", "hum",
+                                                 "babble"};
+  return names[kind];
+}
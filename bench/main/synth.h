@@ -0,0 +1,38 @@
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Seeded test signals for the benchmarks that run without recordings, so
+// every benchmark measures the same reproducible speech and noise
+typedef enum {
+  SYNTH_WHITE,   // Flat spectrum
+  SYNTH_FAN,     // Low-passed noise
+  SYNTH_HUM,     // 50Hz mains harmonics over faint noise
+  SYNTH_BABBLE,  // Noise with a slowly wandering level and tilt
+  SYNTH_NOISE_COUNT,
+} SynthNoise;
+
+// Restart the generator; the same seed gives the same signals
+void synth_seed(uint32_t seed);
+
+// Next 24 random bits
+uint32_t synth_bits();
+
+// Uniform in -1..1
+double synth_random();
+
+// Speech-like voice: 200ms syllables of a harmonic source gliding between
+// 60 and 230Hz under a moving low-pass (formant sweep), pitch contour and
+// sweep drawn per syllable, with a fricative burst and a pause after every
+// fifth syllable. RMS about level / 2, peaks about 1.6 * level
+void synth_speech(int16_t* out, size_t count, uint32_t rate, int32_t level);
+
+// Noise of the given kind; level is the amplitude of the white source
+void synth_noise(int16_t* out, size_t count, uint32_t rate, SynthNoise kind,
+                 int32_t level);
+
+const char* synth_noise_name(SynthNoise kind);
+
+#endif  // SYNTH_H
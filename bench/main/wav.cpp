@@ -0,0 +1,183 @@
+#include "wav.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+static uint16_t read_le16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_le32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static void write_le16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xff;
+  p[1] = v >> 8;
+}
+
+static void write_le32(uint8_t* p, uint32_t v) {
+  p[0] = v & 0xff;
+  p[1] = (v >> 8) & 0xff;
+  p[2] = (v >> 16) & 0xff;
+  p[3] = v >> 24;
+}
+
+bool wav_read(const char* path, WavAudio* wav) {
+  memset(wav, 0, sizeof(*wav));
+  FILE* f = fopen(path, "rb");
+  if (f == NULL) {
+    printf("wav: cannot open %s\n", path);
+    return false;
+  }
+
+  uint8_t riff[12];
+  if (fread(riff, 1, sizeof(riff), f) != sizeof(riff) ||
+      memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+    printf("wav: %s is not a WAV file\n", path);
+    fclose(f);
+    return false;
+  }
+
+  // Walk the RIFF chunks up to the PCM data
+  uint16_t channels = 0;
+  uint8_t chunk[8];
+  while (fread(chunk, 1, sizeof(chunk), f) == sizeof(chunk)) {
+    uint32_t size = read_le32(chunk + 4);
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      uint8_t fmt[16];
+      if (size < sizeof(fmt) || fread(fmt, 1, sizeof(fmt), f) != sizeof(fmt)) {
+        break;
+      }
+      channels = read_le16(fmt + 2);
+      wav->sample_rate = read_le32(fmt + 4);
+      if (read_le16(fmt) != 1 || read_le16(fmt + 14) != 16 || channels == 0) {
+        printf("wav: %s must be 16-bit PCM\n", path);
+        break;
+      }
+      fseek(f, size - sizeof(fmt) + (size & 1), SEEK_CUR);
+    } else if (memcmp(chunk, "data", 4) == 0 && channels != 0) {
+      size_t frames = size / (2 * channels);
+      int16_t* data = (int16_t*)malloc(frames * channels * sizeof(int16_t));
+      wav->samples = (int16_t*)malloc(frames * sizeof(int16_t));
+      if (data == NULL || wav->samples == NULL) {
+        free(data);
+        break;
+      }
+      frames = fread(data, 2 * channels, frames, f);
+      for (size_t i = 0; i < frames; i++) {
+        wav->samples[i] = data[i * channels];
+      }
+      wav->count = frames;
+      free(data);
+      fclose(f);
+      return true;
+    } else {
+      fseek(f, size + (size & 1), SEEK_CUR);
+    }
+  }
+
+  printf("wav: %s has no usable PCM data\n", path);
+  wav_free(wav);
+  fclose(f);
+  return false;
+}
+
+bool wav_write(const char* path, const int16_t* samples, size_t count,
+               uint32_t sample_rate) {
+  FILE* f = fopen(path, "wb");
+  if (f == NULL) {
+    printf("wav: cannot create %s\n", path);
+    return false;
+  }
+
+  uint32_t bytes = (uint32_t)(count * sizeof(int16_t));
+  uint8_t header[44];
+  memcpy(header, "RIFF", 4);
+  write_le32(header + 4, 36 + bytes);
+  memcpy(header + 8, "WAVEfmt ", 8);
+  write_le32(header + 16, 16);
+  write_le16(header + 20, 1);  // PCM
+  write_le16(header + 22, 1);  // Mono
+  write_le32(header + 24, sample_rate);
+  write_le32(header + 28, sample_rate * 2);
+  write_le16(header + 32, 2);
+  write_le16(header + 34, 16);
+  memcpy(header + 36, "data", 4);
+  write_le32(header + 40, bytes);
+
+  bool ok = fwrite(header, 1, sizeof(header), f) == sizeof(header) &&
+            fwrite(samples, sizeof(int16_t), count, f) == count;
+  fclose(f);
+  return ok;
+}
+
+void wav_free(WavAudio* wav) {
+  free(wav->samples);
+  wav->samples = NULL;
+  wav->count = 0;
+}
+
+static bool wav_has_suffix(const char* name, const char* suffix) {
+  size_t length = strlen(name);
+  size_t suffix_length = strlen(suffix);
+  return length >= suffix_length &&
+         strcasecmp(name + length - suffix_length, suffix) == 0;
+}
+
+static int wav_compare_names(const void* a, const void* b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+size_t wav_list(const char* list, size_t max, WavListCallback callback,
+                void* context) {
+  size_t visited = 0;
+  struct stat st;
+  if (stat(list, &st) == 0 && S_ISDIR(st.st_mode)) {
+    DIR* dir = opendir(list);
+    char** names = (char**)malloc(max * sizeof(char*));
+    size_t count = 0;
+    struct dirent* entry;
+    while (dir != NULL && names != NULL && count < max &&
+           (entry = readdir(dir)) != NULL) {
+      if (wav_has_suffix(entry->d_name, ".wav")) {
+        names[count++] = strdup(entry->d_name);
+      }
+    }
+    if (dir != NULL) {
+      closedir(dir);
+    }
+    if (names != NULL) {
+      qsort(names, count, sizeof(names[0]), wav_compare_names);
+    }
+    for (size_t i = 0; i < count; i++) {
+      char path[512];
+      if (snprintf(path, sizeof(path), "%s/%s", list, names[i]) <
+          (int)sizeof(path)) {
+        callback(path, context);
+        visited++;
+      }
+      free(names[i]);
+    }
+    free(names);
+    return visited;
+  }
+
+  char* paths = strdup(list);
+  if (paths == NULL) {
+    return 0;
+  }
+  char* save = NULL;
+  for (char* path = strtok_r(paths, ",", &save);
+       path != NULL && visited < max; path = strtok_r(NULL, ",", &save)) {
+    callback(path, context);
+    visited++;
+  }
+  free(paths);
+  return visited;
+}
@@ -0,0 +1,31 @@
+#ifndef WAV_H
+#define WAV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal 16-bit PCM WAV access for the host benchmarks
+typedef struct {
+  int16_t* samples;  // First channel only
+  size_t count;      // Samples in the first channel
+  uint32_t sample_rate;
+} WavAudio;
+
+// Load the first channel of a 16-bit PCM WAV file
+bool wav_read(const char* path, WavAudio* wav);
+
+// Write mono samples as a 16-bit PCM WAV file
+bool wav_write(const char* path, const int16_t* samples, size_t count,
+               uint32_t sample_rate);
+
+void wav_free(WavAudio* wav);
+
+// Called with the path of every file of a WAV list
+typedef void (*WavListCallback)(const char* path, void* context);
+
+// Visit a corpus given as a directory (its .wav files in name order) or as
+// comma-separated paths, at most max of them; returns the count visited
+size_t wav_list(const char* list, size_t max, WavListCallback callback,
+                void* context);
+
+#endif  // WAV_H
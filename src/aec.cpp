@@ -0,0 +1,429 @@
+#include "aec.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem.h"
+
+// Fixed-point layout: weights are Q28 (+/-8, enough for a loud speaker in a
+// small enclosure); filter sums are 64-bit. The step applied to each tap is
+// g * x with g = mu * e * 2^28 / (energy + delta), clamped so the product
+// always fits in 32 bits; the updated weight saturates at the Q28 range
+#define AEC_COEF_SHIFT 28
+#define AEC_STEP_LIMIT 65535
+#define AEC_REGULARIZATION 64    // Reference RMS where steps start to shrink
+#define AEC_FAR_ACTIVE_LEVEL 32  // Reference RMS that counts as far-end audio
+#define AEC_DIVERGENCE_RATIO 2   // Output energy above ratio * input rolls back
+#define AEC_ERLE_SMOOTHING 0.1f  // Weight of the newest frame in erle_db
+#define AEC_CONVERGED_DB 10      // erle_db above which the filter is trusted
+
+// Delay estimation on 4 ms envelopes over a 1 s window, every 0.5 s
+#define AEC_BLOCK_MS 4
+#define AEC_ESTIMATE_WINDOW_MS 1000
+#define AEC_ESTIMATE_INTERVAL_MS 500
+#define AEC_DELAY_CONFIDENCE 0.4f  // Normalized correlation to trust a lag
+#define AEC_DELAY_MARGIN_BLOCKS 2  // Filter taps kept ahead of the echo peak
+
+// Frames of slack around history_end for capture/playout clock offsets
+#define AEC_LEAD_FRAMES 2
+
+static inline int16_t saturate16(int32_t v) {
+  if (v > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (v < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)v;
+}
+
+static inline int32_t saturate32(int64_t v) {
+  if (v > INT32_MAX) {
+    return INT32_MAX;
+  }
+  if (v < INT32_MIN) {
+    return INT32_MIN;
+  }
+  return (int32_t)v;
+}
+
+bool aec_init(Aec* aec, uint32_t sample_rate, size_t frame_samples) {
+  aec->sample_rate = sample_rate;
+  aec->frame_samples = frame_samples;
+  aec->frame_us = (int64_t)frame_samples * 1000000 / sample_rate;
+  aec->taps = sample_rate * AEC_TAIL_MS / 1000;
+  aec->max_delay = sample_rate * AEC_MAX_DELAY_MS / 1000;
+  aec->delta = (int64_t)aec->taps * AEC_REGULARIZATION * AEC_REGULARIZATION;
+
+  // Envelope blocks must tile the frame; fall back to one block per frame
+  aec->block = sample_rate * AEC_BLOCK_MS / 1000;
+  if (aec->block == 0 || frame_samples % aec->block != 0) {
+    aec->block = frame_samples;
+  }
+  size_t window = sample_rate * AEC_ESTIMATE_WINDOW_MS / 1000 / aec->block;
+  aec->envelope_len = window + aec->max_delay / aec->block + 1;
+
+  // Past samples for the deepest tap, slack on both sides of history_end
+  // and a zero guard for reference that has not been written yet
+  size_t slack = AEC_LEAD_FRAMES * frame_samples;
+  aec->history_len =
+      aec->max_delay + aec->taps + frame_samples + slack + slack;
+  aec->history_end = aec->history_len - slack;
+
+  // All of it is touched every frame, so it stays in internal SRAM
+  aec->reference_storage = (int16_t*)mem_alloc(
+      MEM_INTERNAL, AEC_REFERENCE_FRAMES * frame_samples * sizeof(int16_t));
+  aec->history =
+      (int16_t*)mem_alloc(MEM_INTERNAL, aec->history_len * sizeof(int16_t));
+  aec->weights = (int32_t*)mem_alloc(MEM_INTERNAL, aec->taps * sizeof(int32_t));
+  aec->backup = (int32_t*)mem_alloc(MEM_INTERNAL, aec->taps * sizeof(int32_t));
+  aec->mic_envelope =
+      (int32_t*)mem_alloc(MEM_INTERNAL, aec->envelope_len * sizeof(int32_t));
+  aec->far_envelope =
+      (int32_t*)mem_alloc(MEM_INTERNAL, aec->envelope_len * sizeof(int32_t));
+  if (aec->reference_storage == NULL || aec->history == NULL ||
+      aec->weights == NULL || aec->backup == NULL ||
+      aec->mic_envelope == NULL || aec->far_envelope == NULL) {
+    return false;
+  }
+
+  frame_ring_init(&aec->reference, aec->reference_storage,
+                  AEC_REFERENCE_FRAMES, frame_samples);
+  aec_reset(aec);
+  return true;
+}
+
+void aec_reset(Aec* aec) {
+  // Far-end frames queued while the canceller was bypassed are stale; the
+  // caller is the consumer, so they can be released here
+  while (frame_ring_peek(&aec->reference) != NULL) {
+    frame_ring_pop(&aec->reference);
+  }
+  memset(aec->history, 0, aec->history_len * sizeof(int16_t));
+  memset(aec->weights, 0, aec->taps * sizeof(int32_t));
+  memset(aec->backup, 0, aec->taps * sizeof(int32_t));
+  memset(aec->mic_envelope, 0, aec->envelope_len * sizeof(int32_t));
+  memset(aec->far_envelope, 0, aec->envelope_len * sizeof(int32_t));
+  aec->history_us = 0;
+  aec->delay = 0;
+  aec->envelope_pos = 0;
+  aec->envelope_fill = 0;
+  aec->estimate_countdown =
+      AEC_ESTIMATE_INTERVAL_MS * 1000 / (uint32_t)aec->frame_us;
+  aec->delay_candidate = -1;
+  aec->hangover = 0;
+  memset(&aec->stats, 0, sizeof(aec->stats));
+}
+
+void aec_reference(Aec* aec, const int16_t* mono, size_t samples,
+                   int64_t written_us) {
+  size_t frame_samples = aec->frame_samples;
+  for (size_t done = 0; done < samples; done += frame_samples) {
+    int16_t* slot = frame_ring_acquire(&aec->reference);
+    if (slot == NULL) {
+      aec->reference.overruns.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    size_t count = samples - done < frame_samples ? samples - done
+                                                  : frame_samples;
+    memcpy(slot, mono + done, count * sizeof(int16_t));
+    if (count < frame_samples) {
+      memset(slot + count, 0, (frame_samples - count) * sizeof(int16_t));
+    }
+    aec->reference_times[frame_ring_index(&aec->reference, slot)] =
+        written_us + (int64_t)(done / frame_samples) * aec->frame_us;
+    frame_ring_commit(&aec->reference);
+  }
+}
+
+// Append one frame (NULL for silence) to the far-end history
+static void history_push(Aec* aec, const int16_t* frame) {
+  size_t n = aec->frame_samples;
+  int16_t* end = aec->history + aec->history_end;
+  memmove(aec->history, aec->history + n,
+          (aec->history_end - n) * sizeof(int16_t));
+  if (frame != NULL) {
+    memcpy(end - n, frame, n * sizeof(int16_t));
+  } else {
+    memset(end - n, 0, n * sizeof(int16_t));
+  }
+}
+
+// Bring the far-end history up to the capture time of the current frame
+// and return the offset of that time from history_end in samples
+static int32_t history_sync(Aec* aec, int64_t captured_us) {
+  const int16_t* frame;
+  while ((frame = frame_ring_peek(&aec->reference)) != NULL) {
+    history_push(aec, frame);
+    aec->history_us =
+        aec->reference_times[frame_ring_index(&aec->reference, frame)];
+    frame_ring_pop(&aec->reference);
+  }
+
+  // Nothing written for a while: the speaker is idle, so the playout
+  // timeline carries on with silence
+  int64_t span_us = (int64_t)aec->history_len * 1000000 / aec->sample_rate;
+  if (captured_us - aec->history_us > span_us) {
+    memset(aec->history, 0, aec->history_len * sizeof(int16_t));
+    aec->history_us = captured_us;
+  }
+  while (captured_us - aec->history_us > aec->frame_us * 3 / 2) {
+    history_push(aec, NULL);
+    aec->history_us += aec->frame_us;
+  }
+
+  int32_t slack = AEC_LEAD_FRAMES * (int32_t)aec->frame_samples;
+  int32_t lead = (int32_t)((captured_us - aec->history_us) *
+                           aec->sample_rate / 1000000);
+  if (lead > slack) {
+    lead = slack;
+  } else if (lead < -slack) {
+    lead = -slack;
+  }
+  return lead;
+}
+
+// Re-index filter taps for a bulk delay change, keeping taps that overlap
+static void shift_taps(int32_t* w, size_t taps, size_t from, size_t to) {
+  size_t shift = to > from ? to - from : from - to;
+  if (shift >= taps) {
+    memset(w, 0, taps * sizeof(int32_t));
+  } else if (to > from) {
+    memmove(w, w + shift, (taps - shift) * sizeof(int32_t));
+    memset(w + taps - shift, 0, shift * sizeof(int32_t));
+  } else {
+    memmove(w + shift, w, (taps - shift) * sizeof(int32_t));
+    memset(w, 0, shift * sizeof(int32_t));
+  }
+}
+
+// Move the filter to a new bulk delay
+static void aec_set_delay(Aec* aec, size_t delay) {
+  shift_taps(aec->weights, aec->taps, aec->delay, delay);
+  shift_taps(aec->backup, aec->taps, aec->delay, delay);
+  aec->delay = delay;
+  aec->stats.delay_changes++;
+}
+
+// Find the lag where the microphone envelope best follows the far-end
+// envelope (normalized cross-correlation) and move the filter there once
+// the same lag wins twice in a row
+static void aec_estimate_delay(Aec* aec) {
+  size_t len = aec->envelope_len;
+  size_t lags = aec->max_delay / aec->block + 1;
+  size_t window = len - lags + 1;
+  if (aec->envelope_fill < len) {
+    return;
+  }
+
+  // Oldest entry of the window, relative to the circular write position
+  size_t start = aec->envelope_pos + len - window;
+
+  float mic_mean = 0;
+  for (size_t t = 0; t < window; t++) {
+    mic_mean += aec->mic_envelope[(start + t) % len];
+  }
+  mic_mean /= window;
+  float mic_var = 0;
+  for (size_t t = 0; t < window; t++) {
+    float m = aec->mic_envelope[(start + t) % len] - mic_mean;
+    mic_var += m * m;
+  }
+
+  float best = 0;
+  int32_t best_lag = -1;
+  for (size_t lag = 0; lag < lags; lag++) {
+    size_t far_start = start + len - lag;
+    float far_mean = 0;
+    for (size_t t = 0; t < window; t++) {
+      far_mean += aec->far_envelope[(far_start + t) % len];
+    }
+    far_mean /= window;
+    if (far_mean < AEC_FAR_ACTIVE_LEVEL * aec->block) {
+      continue;  // Not enough far-end audio at this lag to judge
+    }
+
+    float far_var = 0;
+    float cov = 0;
+    for (size_t t = 0; t < window; t++) {
+      float f = aec->far_envelope[(far_start + t) % len] - far_mean;
+      float m = aec->mic_envelope[(start + t) % len] - mic_mean;
+      far_var += f * f;
+      cov += f * m;
+    }
+    if (far_var <= 0 || mic_var <= 0) {
+      continue;
+    }
+    float ncc = cov / sqrtf(far_var * mic_var);
+    if (ncc > best) {
+      best = ncc;
+      best_lag = (int32_t)lag;
+    }
+  }
+
+  if (best < AEC_DELAY_CONFIDENCE) {
+    aec->delay_candidate = -1;
+    return;
+  }
+  if (best_lag != aec->delay_candidate) {
+    aec->delay_candidate = best_lag;
+    return;
+  }
+
+  size_t delay = 0;
+  if (best_lag > AEC_DELAY_MARGIN_BLOCKS) {
+    delay = (best_lag - AEC_DELAY_MARGIN_BLOCKS) * aec->block;
+  }
+  size_t moved = delay > aec->delay ? delay - aec->delay : aec->delay - delay;
+  if (moved > aec->block) {
+    aec_set_delay(aec, delay);
+  }
+}
+
+// Record microphone and far-end envelopes of the frame for delay estimation
+static void aec_track_envelopes(Aec* aec, const int16_t* mic,
+                                const int16_t* far) {
+  for (size_t b = 0; b < aec->frame_samples; b += aec->block) {
+    int32_t mic_sum = 0;
+    int32_t far_sum = 0;
+    for (size_t i = b; i < b + aec->block; i++) {
+      mic_sum += abs(mic[i]);
+      far_sum += abs(far[i]);
+    }
+    aec->mic_envelope[aec->envelope_pos] = mic_sum;
+    aec->far_envelope[aec->envelope_pos] = far_sum;
+    aec->envelope_pos = (aec->envelope_pos + 1) % aec->envelope_len;
+    if (aec->envelope_fill < aec->envelope_len) {
+      aec->envelope_fill++;
+    }
+  }
+
+  if (--aec->estimate_countdown == 0) {
+    aec->estimate_countdown =
+        AEC_ESTIMATE_INTERVAL_MS * 1000 / (uint32_t)aec->frame_us;
+    aec_estimate_delay(aec);
+  }
+}
+
+void aec_process(Aec* aec, const int16_t* mic, int16_t* out,
+                 int64_t captured_us) {
+  size_t n = aec->frame_samples;
+  size_t taps = aec->taps;
+  int32_t lead = history_sync(aec, captured_us);
+
+  // Far-end samples playing while the microphone frame was captured, before
+  // and after the bulk delay
+  const int16_t* now = aec->history + aec->history_end + lead - n;
+  aec_track_envelopes(aec, mic, now);
+  const int16_t* x = now - aec->delay;
+
+  // Reference energy of the window ending just before the first sample and
+  // peak over every sample the filter will touch this frame
+  int64_t energy = 0;
+  int32_t far_peak = 0;
+  for (const int16_t* p = x - taps; p < x + n; p++) {
+    if (p < x) {
+      energy += (int32_t)p[0] * p[0];
+    }
+    if (abs(p[0]) > far_peak) {
+      far_peak = abs(p[0]);
+    }
+  }
+
+  int32_t mic_peak = 0;
+  for (size_t j = 0; j < n; j++) {
+    if (abs(mic[j]) > mic_peak) {
+      mic_peak = abs(mic[j]);
+    }
+  }
+
+  aec->stats.frames++;
+  if (far_peak == 0) {
+    // Speaker silent across the whole filter span: nothing to cancel
+    memcpy(out, mic, n * sizeof(int16_t));
+    return;
+  }
+
+  bool far_active =
+      energy >= (int64_t)taps * AEC_FAR_ACTIVE_LEVEL * AEC_FAR_ACTIVE_LEVEL;
+  if (mic_peak > far_peak * AEC_DOUBLE_TALK_RATIO) {
+    aec->hangover = AEC_HANGOVER_FRAMES;  // Near-end talker: hold the filter
+  }
+  bool adapt = far_active && aec->hangover == 0;
+  if (far_active) {
+    aec->stats.far_frames++;
+  }
+  if (aec->hangover > 0) {
+    aec->hangover--;
+    aec->stats.double_talk++;
+  }
+
+  int32_t* w = aec->weights;
+  int64_t mic_energy = 0;
+  int64_t out_energy = 0;
+  for (size_t j = 0; j < n; j++) {
+    const int16_t* xj = x + j;  // xj[-k] is the reference at lag k
+
+    int64_t acc = 0;
+    for (size_t k = 0; k < taps; k++) {
+      acc += (int64_t)w[k] * xj[-(int32_t)k];
+    }
+    int32_t d = mic[j];
+    int32_t e = saturate16(d - (int32_t)(acc >> AEC_COEF_SHIFT));
+    out[j] = (int16_t)e;
+
+    energy += (int32_t)xj[0] * xj[0] -
+              (int32_t)xj[-(int32_t)taps] * xj[-(int32_t)taps];
+    mic_energy += d * d;
+    out_energy += e * e;
+
+    if (adapt) {
+      int64_t g = ((int64_t)AEC_STEP_Q15 * e * (1 << 13)) /
+                  (energy + aec->delta);
+      if (g > AEC_STEP_LIMIT) {
+        g = AEC_STEP_LIMIT;
+      } else if (g < -AEC_STEP_LIMIT) {
+        g = -AEC_STEP_LIMIT;
+      }
+      int32_t step = (int32_t)g;
+      for (size_t k = 0; k < taps; k++) {
+        w[k] = saturate32((int64_t)w[k] + step * xj[-(int32_t)k]);
+      }
+    }
+  }
+
+  if (out_energy > mic_energy) {
+    // Not converged on this echo path yet: never make the signal worse
+    memcpy(out, mic, n * sizeof(int16_t));
+  }
+  if (!adapt) {
+    return;
+  }
+
+  // Near-end speech that slipped past the peak test shows up as a sudden
+  // loss of cancellation, and divergence as output louder than input: undo
+  // this frame's adaptation in both cases
+  float erle = 10.0f * log10f((float)(mic_energy + 1) / (out_energy + 1));
+  bool converged = aec->stats.erle_db > AEC_CONVERGED_DB;
+  bool audible = out_energy >
+                 (int64_t)n * AEC_FAR_ACTIVE_LEVEL * AEC_FAR_ACTIVE_LEVEL;
+  if (out_energy > mic_energy * AEC_DIVERGENCE_RATIO ||
+      (converged && audible &&
+       erle < aec->stats.erle_db - AEC_ERLE_DROP_DB)) {
+    memcpy(aec->weights, aec->backup, taps * sizeof(int32_t));
+    aec->hangover = AEC_HANGOVER_FRAMES;
+    aec->stats.rollbacks++;
+    return;
+  }
+  memcpy(aec->backup, aec->weights, taps * sizeof(int32_t));
+  aec->stats.erle_db += AEC_ERLE_SMOOTHING * (erle - aec->stats.erle_db);
+}
+
+void aec_stats(Aec* aec, AecStats* stats) {
+  *stats = aec->stats;
+  stats->delay_ms = (uint32_t)(aec->delay * 1000 / aec->sample_rate);
+  stats->reference_drops =
+      aec->reference.overruns.load(std::memory_order_relaxed);
+}
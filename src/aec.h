@@ -0,0 +1,101 @@
+#ifndef AEC_H
+#define AEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ring_buffer.h"
+
+// Acoustic echo canceller: fixed-point time-domain NLMS on the microphone
+// signal, using the decoded far-end audio written to the speaker as the
+// reference. The bulk delay between the speaker write and the echo reaching
+// the microphone (both I2S DMA queues plus the acoustic path) is found by
+// cross-correlating signal envelopes, so the adaptive filter only has to
+// model the room tail
+// Cost: filter and update are 2 * taps multiply-accumulates per sample,
+// 164k per 20ms frame for the 512 taps at 8kHz (bench_aec: 0.56M cycles per
+// frame on an x86 host, 1.3% of real time; run it on target for the
+// ESP32-S3 figure). A partitioned frequency-domain filter over the same tail
+// (4 x 128 taps, 256-point FFTs) would need about 2.5x fewer multiplies but
+// adds a 16ms block of latency and per-bin normalization in fixed point;
+// the deadline governor bypasses the canceller if a frame overruns instead
+#define AEC_TAIL_MS 64           // Echo tail modelled by the adaptive filter
+#define AEC_MAX_DELAY_MS 240     // Largest bulk delay the estimator searches
+#define AEC_REFERENCE_FRAMES 8   // Far-end frames queued by the playout task
+#define AEC_STEP_Q15 16384       // NLMS step size mu (0.5)
+#define AEC_DOUBLE_TALK_RATIO 2  // Mic peak above ratio * far peak freezes
+#define AEC_HANGOVER_FRAMES 5    // Frames adaptation stays frozen afterwards
+#define AEC_ERLE_DROP_DB 10      // Sudden ERLE loss treated as near-end talk
+
+// Echo canceller counters
+typedef struct {
+  float erle_db;             // Echo return loss enhancement (smoothed)
+  uint32_t delay_ms;         // Current bulk delay estimate
+  uint32_t frames;           // Microphone frames processed
+  uint32_t far_frames;       // Frames with far-end audio in the filter
+  uint32_t double_talk;      // Frames where adaptation was frozen
+  uint32_t delay_changes;    // Times the bulk delay estimate moved
+  uint32_t rollbacks;        // Adaptations undone (divergence, double talk)
+  uint32_t reference_drops;  // Far-end frames dropped on a full queue
+} AecStats;
+
+typedef struct {
+  uint32_t sample_rate;
+  size_t frame_samples;  // Samples per microphone/reference frame
+  int64_t frame_us;      // Duration of one frame
+  size_t taps;           // Adaptive filter length in samples
+  size_t max_delay;      // Bulk delay search range in samples
+  int64_t delta;         // NLMS regularisation added to the reference energy
+
+  // Far-end frames and their write times, handed over by the playout task
+  FrameRing reference;
+  int16_t* reference_storage;
+  int64_t reference_times[AEC_REFERENCE_FRAMES];
+
+  // Far-end history on the playout timeline, newest sample at history_end.
+  // Samples past history_end are a zero guard for frames not yet written
+  int16_t* history;
+  size_t history_len;
+  size_t history_end;
+  int64_t history_us;  // Write time of the newest frame in the history
+
+  int32_t* weights;  // Q28 filter coefficients, weights[k] for lag k
+  int32_t* backup;   // Last weights that were cancelling well
+  size_t delay;      // Bulk delay applied to the reference in samples
+
+  // Sub-block envelopes for delay estimation, in circular buffers
+  size_t block;  // Samples per envelope entry
+  int32_t* mic_envelope;
+  int32_t* far_envelope;
+  size_t envelope_len;
+  size_t envelope_pos;
+  size_t envelope_fill;
+  uint32_t estimate_countdown;  // Frames until the next delay estimate
+  int32_t delay_candidate;      // Lag seen once, waiting for confirmation
+
+  uint32_t hangover;  // Frames left with adaptation frozen
+  AecStats stats;
+} Aec;
+
+// Allocate and reset an echo canceller for a frame size and sample rate
+bool aec_init(Aec* aec, uint32_t sample_rate, size_t frame_samples);
+
+// Forget the echo path, the far-end history, queued reference frames and
+// the delay estimate. Encode side only: it consumes the reference queue
+void aec_reset(Aec* aec);
+
+// Playout side: queue mono audio about to be written to the speaker
+// samples: any length, split into frames and the last one padded with
+// silence. written_us: time of the speaker write
+void aec_reference(Aec* aec, const int16_t* mono, size_t samples,
+                   int64_t written_us);
+
+// Capture side: cancel echo in one microphone frame (frame_samples long)
+// out must not alias mic. captured_us: time the frame finished capturing
+void aec_process(Aec* aec, const int16_t* mic, int16_t* out,
+                 int64_t captured_us);
+
+// Snapshot of echo canceller counters (call from the capture side)
+void aec_stats(Aec* aec, AecStats* stats);
+
+#endif  // AEC_H
@@ -0,0 +1,276 @@
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "audio_io.h"
+#include "main.h"
+
+// Host stand-ins for the I2S microphone and speaker, configured at runtime:
+//   MIC_INPUT       WAV file (16-bit PCM) or FIFO of raw s16le mono samples;
+//                   silence when unset
+//   SPEAKER_OUTPUT  WAV file receiving the stereo playout; discarded if unset
+//   AUDIO_PACE      "realtime" (default) follows the sample clock like the
+//                   DMA would, "fast" reads and writes as fast as possible
+//   AUDIO_DRAIN_MS  Time to keep playing after the microphone input ends
+#define DEFAULT_DRAIN_MS 5000  // Enough for the reply to the last utterance
+#define WAV_HEADER_SIZE 44     // Canonical PCM WAV header
+
+static FILE* mic_file = NULL;
+static uint16_t mic_channels = 1;
+// The playout task appends while the capture task may be finalizing the
+// WAV in its atexit handler; both hold speaker_lock
+static SemaphoreHandle_t speaker_lock = NULL;
+static FILE* speaker_file = NULL;
+static uint32_t speaker_bytes = 0;
+static uint32_t io_sample_rate = 0;
+static size_t io_frame_samples = 0;
+static bool realtime = true;
+static struct timespec capture_clock;  // Deadline of the next capture frame
+static struct timespec playout_clock;  // Deadline of the next playout write
+
+// Set by SIGINT or SIGTERM, acted on by the capture loop
+static volatile sig_atomic_t exit_requested = 0;
+
+static uint16_t read_le16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_le32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static void write_le16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xff;
+  p[1] = v >> 8;
+}
+
+static void write_le32(uint8_t* p, uint32_t v) {
+  p[0] = v & 0xff;
+  p[1] = (v >> 8) & 0xff;
+  p[2] = (v >> 16) & 0xff;
+  p[3] = v >> 24;
+}
+
+// Advance an absolute deadline by the given number of samples and sleep
+// until it is reached (used to imitate the I2S DMA clock)
+static void wait_sample_clock(struct timespec* clock, size_t samples) {
+  uint64_t ns = (uint64_t)samples * 1000000000ULL / io_sample_rate;
+  clock->tv_nsec += ns % 1000000000ULL;
+  clock->tv_sec += ns / 1000000000ULL + clock->tv_nsec / 1000000000L;
+  clock->tv_nsec %= 1000000000L;
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, clock, NULL);
+}
+
+// Walk the RIFF chunks up to the start of the PCM data
+static bool parse_wav_header(FILE* f, const char* path) {
+  uint8_t riff[12];
+  if (fread(riff, 1, sizeof(riff), f) != sizeof(riff) ||
+      memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+    ESP_LOGE(LOG_TAG, "%s is not a WAV file", path);
+    return false;
+  }
+
+  uint8_t chunk[8];
+  while (fread(chunk, 1, sizeof(chunk), f) == sizeof(chunk)) {
+    uint32_t size = read_le32(chunk + 4);
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      uint8_t fmt[16];
+      if (size < sizeof(fmt) || fread(fmt, 1, sizeof(fmt), f) != sizeof(fmt)) {
+        break;
+      }
+      uint16_t format = read_le16(fmt);
+      mic_channels = read_le16(fmt + 2);
+      uint32_t rate = read_le32(fmt + 4);
+      uint16_t bits = read_le16(fmt + 14);
+      if (format != 1 || bits != 16 || mic_channels < 1 || mic_channels > 2) {
+        ESP_LOGE(LOG_TAG, "%s must be 16-bit PCM mono or stereo", path);
+        return false;
+      }
+      if (rate != io_sample_rate) {
+        ESP_LOGW(LOG_TAG, "%s is %luHz, pipeline runs at %luHz", path,
+                 (unsigned long)rate, (unsigned long)io_sample_rate);
+      }
+      fseek(f, size - sizeof(fmt) + (size & 1), SEEK_CUR);
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      return true;
+    } else {
+      fseek(f, size + (size & 1), SEEK_CUR);
+    }
+  }
+  ESP_LOGE(LOG_TAG, "%s has no PCM data chunk", path);
+  return false;
+}
+
+// Patch the RIFF and data chunk sizes and close the speaker file
+static void finish_speaker_output() {
+  xSemaphoreTake(speaker_lock, portMAX_DELAY);
+  if (speaker_file == NULL) {
+    xSemaphoreGive(speaker_lock);
+    return;
+  }
+  uint8_t size[4];
+  write_le32(size, 36 + speaker_bytes);
+  fseek(speaker_file, 4, SEEK_SET);
+  fwrite(size, 1, sizeof(size), speaker_file);
+  write_le32(size, speaker_bytes);
+  fseek(speaker_file, 40, SEEK_SET);
+  fwrite(size, 1, sizeof(size), speaker_file);
+  fclose(speaker_file);
+  speaker_file = NULL;  // Later playout writes are discarded
+  xSemaphoreGive(speaker_lock);
+}
+
+// Only async-signal-safe work here: the capture loop sees the flag within
+// a frame and exits from task context, where the atexit handlers can
+// finalize the WAV output
+static void handle_exit_signal(int signum) { exit_requested = 1; }
+
+static bool open_speaker_output(const char* path) {
+  speaker_lock = xSemaphoreCreateMutex();
+  if (speaker_lock == NULL) {
+    ESP_LOGE(LOG_TAG, "Failed to create speaker output lock");
+    return false;
+  }
+  speaker_file = fopen(path, "wb");
+  if (speaker_file == NULL) {
+    ESP_LOGE(LOG_TAG, "Failed to open speaker output %s", path);
+    return false;
+  }
+
+  uint8_t header[WAV_HEADER_SIZE] = {0};
+  memcpy(header, "RIFF", 4);
+  memcpy(header + 8, "WAVEfmt ", 8);
+  write_le32(header + 16, 16);                      // fmt chunk size
+  write_le16(header + 20, 1);                       // PCM
+  write_le16(header + 22, 2);                       // Stereo
+  write_le32(header + 24, io_sample_rate);          // Sample rate
+  write_le32(header + 28, io_sample_rate * 2 * 2);  // Byte rate
+  write_le16(header + 32, 2 * 2);                   // Block align
+  write_le16(header + 34, 16);                      // Bits per sample
+  memcpy(header + 36, "data", 4);
+  fwrite(header, 1, sizeof(header), speaker_file);
+
+  atexit(finish_speaker_output);
+  return true;
+}
+
+// Open the microphone source and speaker sink named in the environment
+bool audio_io_init(uint32_t sample_rate, size_t frame_samples) {
+  io_sample_rate = sample_rate;
+  io_frame_samples = frame_samples;
+
+  signal(SIGINT, handle_exit_signal);
+  signal(SIGTERM, handle_exit_signal);
+
+  const char* pace = getenv("AUDIO_PACE");
+  realtime = pace == NULL || strcmp(pace, "fast") != 0;
+
+  const char* mic_path = getenv("MIC_INPUT");
+  if (mic_path != NULL) {
+    struct stat st;
+    bool fifo = stat(mic_path, &st) == 0 && S_ISFIFO(st.st_mode);
+    mic_file = fopen(mic_path, "rb");  // Blocks until a FIFO writer appears
+    if (mic_file == NULL) {
+      ESP_LOGE(LOG_TAG, "Failed to open microphone input %s", mic_path);
+      return false;
+    }
+    if (!fifo && !parse_wav_header(mic_file, mic_path)) {
+      fclose(mic_file);
+      mic_file = NULL;
+      return false;
+    }
+  }
+
+  const char* speaker_path = getenv("SPEAKER_OUTPUT");
+  if (speaker_path != NULL && !open_speaker_output(speaker_path)) {
+    return false;
+  }
+
+  ESP_LOGI(LOG_TAG, "Host audio: mic=%s speaker=%s pace=%s",
+           mic_path ? mic_path : "(silence)",
+           speaker_path ? speaker_path : "(discard)",
+           realtime ? "realtime" : "fast");
+  return true;
+}
+
+// Start the capture clock from now
+void audio_io_start_capture() {
+  clock_gettime(CLOCK_MONOTONIC, &capture_clock);
+}
+
+// Read one mono frame from the source, paced like the I2S DMA in realtime
+// mode; once the source is exhausted let playout drain, then end the run.
+// A termination signal ends the run at the next frame
+void audio_io_read_frame(int16_t* frame, uint32_t* dropped) {
+  *dropped = 0;
+  if (realtime) {
+    wait_sample_clock(&capture_clock, io_frame_samples);
+  }
+  if (exit_requested) {
+    exit(0);  // Runs atexit handlers so the WAV output is finalized
+  }
+
+  if (mic_file == NULL) {
+    memset(frame, 0, io_frame_samples * sizeof(int16_t));
+    return;
+  }
+
+  size_t got = 0;
+  if (mic_channels == 1) {
+    got = fread(frame, sizeof(int16_t), io_frame_samples, mic_file);
+  } else {
+    // Downmix stereo input to the mono the INMP441 would deliver
+    int16_t pair[2];
+    while (got < io_frame_samples &&
+           fread(pair, sizeof(int16_t), 2, mic_file) == 2) {
+      frame[got++] = (int16_t)(((int32_t)pair[0] + pair[1]) / 2);
+    }
+  }
+  if (got == io_frame_samples) {
+    return;
+  }
+
+  const char* drain = getenv("AUDIO_DRAIN_MS");
+  long drain_ms = drain ? atol(drain) : DEFAULT_DRAIN_MS;
+  ESP_LOGI(LOG_TAG, "Microphone input finished, draining for %ldms",
+           drain_ms);
+  for (long waited = 0; waited < drain_ms && !exit_requested; waited += 20) {
+    usleep(20 * 1000);
+  }
+  exit(0);
+}
+
+// Append stereo frames to the speaker WAV, paced like the I2S DMA in
+// realtime mode
+void audio_io_write(const int16_t* pcm, size_t frames) {
+  if (realtime) {
+    // A real DMA underruns into silence when idle, so restart the clock
+    // rather than bursting to catch up
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > playout_clock.tv_sec ||
+        (now.tv_sec == playout_clock.tv_sec &&
+         now.tv_nsec > playout_clock.tv_nsec)) {
+      playout_clock = now;
+    }
+    wait_sample_clock(&playout_clock, frames);
+  }
+
+  if (speaker_lock == NULL) {
+    return;  // No speaker output configured
+  }
+  xSemaphoreTake(speaker_lock, portMAX_DELAY);
+  if (speaker_file != NULL) {
+    speaker_bytes += fwrite(pcm, 2 * sizeof(int16_t), frames, speaker_file) *
+                     2 * sizeof(int16_t);
+  }
+  xSemaphoreGive(speaker_lock);
+}
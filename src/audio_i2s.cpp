@@ -0,0 +1,135 @@
+#include <driver/i2s.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include "audio_io.h"
+#include "main.h"
+
+// DMA configuration (one DMA buffer == one capture frame)
+#define CAPTURE_DMA_BUF_COUNT 4  // DMA descriptors for the microphone
+#define PLAYOUT_DMA_BUF_COUNT 3  // Small DMA queue, delay lives in the JB
+
+// MAX98357A amplifier pin configuration
+#define MCLK_PIN 0        // Master clock
+#define DAC_BCLK_PIN 20   // Bit clock
+#define DAC_LRCLK_PIN 21  // Word select / Left-right clock
+#define DAC_DATA_PIN 19   // Data output
+
+// INMP441 microphone pin configuration
+#define ADC_BCLK_PIN 47   // Bit clock
+#define ADC_LRCLK_PIN 41  // Word select / Left-right clock
+#define ADC_DATA_PIN 45   // Data input
+
+static QueueHandle_t capture_event_queue = NULL;  // I2S RX DMA events
+static size_t capture_frame_bytes = 0;
+
+// Initialize I2S drivers for audio input (INMP441) and output (MAX98357A)
+bool audio_io_init(uint32_t sample_rate, size_t frame_samples) {
+  capture_frame_bytes = frame_samples * sizeof(int16_t);
+
+  // Configure I2S output for MAX98357A amplifier
+  i2s_config_t i2s_config_out = {
+      .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
+      .sample_rate = (int)sample_rate,
+      .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+      .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,  // Stereo output
+      .communication_format = I2S_COMM_FORMAT_I2S_MSB,
+      .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
+      .dma_buf_count = PLAYOUT_DMA_BUF_COUNT,  // Number of DMA buffers
+      .dma_buf_len = (int)frame_samples,       // One frame per DMA buffer
+      .use_apll = 1,                           // Use APLL for better quality
+      .tx_desc_auto_clear = true,              // Auto-clear DMA buffers
+  };
+  if (i2s_driver_install(I2S_NUM_0, &i2s_config_out, 0, NULL) != ESP_OK) {
+    printf("Failed to configure I2S driver for audio output");
+    return false;
+  }
+
+  // Set up output pins for MAX98357A
+  i2s_pin_config_t pin_config_out = {
+      .mck_io_num = MCLK_PIN,
+      .bck_io_num = DAC_BCLK_PIN,
+      .ws_io_num = DAC_LRCLK_PIN,
+      .data_out_num = DAC_DATA_PIN,
+      .data_in_num = I2S_PIN_NO_CHANGE,
+  };
+  if (i2s_set_pin(I2S_NUM_0, &pin_config_out) != ESP_OK) {
+    printf("Failed to set I2S pins for audio output");
+    return false;
+  }
+  i2s_zero_dma_buffer(I2S_NUM_0);  // Clear output buffer
+
+  // Configure I2S input for INMP441 microphone
+  i2s_config_t i2s_config_in = {
+      .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
+      .sample_rate = (int)sample_rate,
+      .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+      .channel_format =
+          I2S_CHANNEL_FMT_ONLY_LEFT,  // Mono input from mic (one channel input
+                                      // only for inmp441)
+      .communication_format = I2S_COMM_FORMAT_I2S_MSB,
+      .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
+      .dma_buf_count = CAPTURE_DMA_BUF_COUNT,
+      .dma_buf_len = (int)frame_samples,  // Each RX_DONE event is one frame
+      .use_apll = 1,
+      .fixed_mclk = 0};
+  // Install with an event queue so capture is paced by the DMA clock
+  if (i2s_driver_install(I2S_NUM_1, &i2s_config_in, CAPTURE_DMA_BUF_COUNT,
+                         &capture_event_queue) != ESP_OK) {
+    printf("Failed to configure I2S driver for audio input");
+    return false;
+  }
+
+  // Set up input pins for INMP441
+  i2s_pin_config_t pin_config_in = {
+      .mck_io_num = MCLK_PIN,
+      .bck_io_num = ADC_BCLK_PIN,
+      .ws_io_num = ADC_LRCLK_PIN,
+      .data_out_num = I2S_PIN_NO_CHANGE,
+      .data_in_num = ADC_DATA_PIN,
+  };
+  if (i2s_set_pin(I2S_NUM_1, &pin_config_in) != ESP_OK) {
+    printf("Failed to set I2S pins for audio input");
+    return false;
+  }
+  return true;
+}
+
+// Drop DMA buffers and events that piled up before capture started
+void audio_io_start_capture() {
+  i2s_zero_dma_buffer(I2S_NUM_1);
+  xQueueReset(capture_event_queue);
+}
+
+// Wait for I2S RX DMA completions until one full frame has been read
+void audio_io_read_frame(int16_t* frame, uint32_t* dropped) {
+  size_t fill = 0;  // Bytes of the frame already read
+  i2s_event_t event;
+  *dropped = 0;
+
+  while (fill < capture_frame_bytes) {
+    if (xQueueReceive(capture_event_queue, &event, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    if (event.type == I2S_EVENT_RX_Q_OVF) {
+      // Driver had to drop a DMA buffer because we fell behind
+      (*dropped)++;
+      continue;
+    }
+    if (event.type != I2S_EVENT_RX_DONE) {
+      continue;
+    }
+
+    size_t bytes_read = 0;
+    i2s_read(I2S_NUM_1, (uint8_t*)frame + fill, capture_frame_bytes - fill,
+             &bytes_read, 0);
+    fill += bytes_read;
+  }
+}
+
+// Output stereo audio through I2S, blocking while the DMA queue is full
+void audio_io_write(const int16_t* pcm, size_t frames) {
+  size_t bytes_written = 0;
+  i2s_write(I2S_NUM_0, pcm, frames * 2 * sizeof(int16_t), &bytes_written,
+            portMAX_DELAY);
+}
@@ -0,0 +1,26 @@
+#ifndef AUDIO_IO_H
+#define AUDIO_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Audio I/O backend underneath the media pipeline in media.cpp
+// - Target: INMP441 microphone and MAX98357A amplifier over I2S
+//   (audio_i2s.cpp)
+// - Linux: WAV file or FIFO as the microphone, WAV file as the speaker
+//   (audio_host.cpp)
+
+// Open the microphone and speaker at the given rate and capture frame size
+bool audio_io_init(uint32_t sample_rate, size_t frame_samples);
+
+// Discard input captured before the pipeline was ready for it
+void audio_io_start_capture(void);
+
+// Block until the capture clock delivers one full mono frame
+// dropped: frames the backend lost since the previous call
+void audio_io_read_frame(int16_t* frame, uint32_t* dropped);
+
+// Write interleaved stereo frames to the speaker, blocking at the sink pace
+void audio_io_write(const int16_t* pcm, size_t frames);
+
+#endif  // AUDIO_IO_H
@@ -0,0 +1,120 @@
+#include "boot.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/task.h>
+
+#include "main.h"
+#include "mem.h"
+
+typedef struct {
+  int64_t begin_us;  // esp_timer time (since reset), 0 until begun
+  int64_t end_us;    // 0 until ended
+} BootTiming;
+
+// Function run by a phase task
+typedef struct {
+  BootPhase phase;
+  void (*fn)(void);
+} BootJob;
+
+static EventGroupHandle_t boot_events = NULL;
+static BootTiming timings[BOOT_PHASE_COUNT];
+static BootJob jobs[BOOT_PHASE_COUNT];
+
+static const char* phase_names[BOOT_PHASE_COUNT] = {
+    "nvs", "audio", "network", "signaling", "peer", "connect", "audio-in",
+};
+
+void boot_init() {
+  boot_events = xEventGroupCreate();
+}
+
+void boot_begin(BootPhase phase) {
+  if (timings[phase].begin_us == 0) {
+    timings[phase].begin_us = esp_timer_get_time();
+  }
+}
+
+void boot_end(BootPhase phase) {
+  if (timings[phase].end_us != 0) {
+    return;
+  }
+  boot_begin(phase);
+  timings[phase].end_us = esp_timer_get_time();
+  xEventGroupSetBits(boot_events, BOOT_BIT(phase));
+  if (phase == BOOT_FIRST_AUDIO) {
+    boot_dump();
+  }
+}
+
+static void boot_task(void* user_data) {
+  BootJob* job = (BootJob*)user_data;
+  boot_begin(job->phase);
+  job->fn();
+  boot_end(job->phase);
+  vTaskDelete(NULL);
+}
+
+void boot_spawn(BootPhase phase, void (*fn)(void), const char* name,
+                int core) {
+  jobs[phase].phase = phase;
+  jobs[phase].fn = fn;
+  xTaskCreatePinnedToCore(boot_task, name, BOOT_TASK_STACK, &jobs[phase],
+                          BOOT_TASK_PRIORITY, NULL, core);
+}
+
+void boot_wait(uint32_t bits) {
+  xEventGroupWaitBits(boot_events, bits, pdFALSE, pdTRUE, portMAX_DELAY);
+}
+
+// Arena use and heap left per placement region, and stack high-water marks
+static void boot_dump_memory() {
+  ESP_LOGI(LOG_TAG, "%-9s %6s %8s %8s %9s %8s %8s %8s", "memory", "allocs",
+           "used", "reserved", "fallbacks", "free", "min_free", "largest");
+  for (int region = 0; region < MEM_REGION_COUNT; region++) {
+    MemStats stats;
+    mem_region_stats((MemRegion)region, &stats);
+    ESP_LOGI(LOG_TAG, "%-9s %6lu %8lu %8lu %9lu %8lu %8lu %8lu",
+             mem_region_name((MemRegion)region),
+             (unsigned long)stats.allocations, (unsigned long)stats.used,
+             (unsigned long)stats.reserved, (unsigned long)stats.fallbacks,
+             (unsigned long)stats.heap_free,
+             (unsigned long)stats.heap_min_free,
+             (unsigned long)stats.heap_largest);
+  }
+
+  MemTaskStats tasks[MEM_MAX_TASKS];
+  size_t count = mem_task_stats(tasks, MEM_MAX_TASKS);
+  ESP_LOGI(LOG_TAG, "%-16s %-9s %8s %8s", "stack", "region", "size",
+           "min_free");
+  for (size_t i = 0; i < count; i++) {
+    ESP_LOGI(LOG_TAG, "%-16s %-9s %8lu %8lu", tasks[i].name,
+             mem_region_name(tasks[i].region),
+             (unsigned long)tasks[i].stack_size,
+             (unsigned long)tasks[i].stack_min_free);
+  }
+}
+
+void boot_dump() {
+  ESP_LOGI(LOG_TAG, "%-9s %8s %8s %8s", "boot", "begin", "end", "wall(ms)");
+  for (int phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+    const BootTiming* t = &timings[phase];
+    if (t->end_us == 0) {
+      ESP_LOGI(LOG_TAG, "%-9s %8lu %8s %8s", phase_names[phase],
+               (unsigned long)(t->begin_us / 1000), "-", "-");
+      continue;
+    }
+    ESP_LOGI(LOG_TAG, "%-9s %8lu %8lu %8lu", phase_names[phase],
+             (unsigned long)(t->begin_us / 1000),
+             (unsigned long)(t->end_us / 1000),
+             (unsigned long)((t->end_us - t->begin_us) / 1000));
+  }
+  if (timings[BOOT_FIRST_AUDIO].end_us != 0) {
+    ESP_LOGI(LOG_TAG, "Boot to first audio: %lums",
+             (unsigned long)(timings[BOOT_FIRST_AUDIO].end_us / 1000));
+  }
+  boot_dump_memory();
+}
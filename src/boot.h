@@ -0,0 +1,46 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+
+// Startup as a dependency graph: independent init phases run in their own
+// tasks on both cores and signal completion through an event group, so Wi-Fi
+// association, audio/codec setup, TLS/DNS preparation for signaling and the
+// DTLS key generation of the first PeerConnection overlap. Each phase's wall
+// time is recorded and the boot-to-first-audio total reported once the first
+// downlink audio arrives
+#define BOOT_TASK_STACK 8192  // Stack of a phase task in bytes
+#define BOOT_TASK_PRIORITY 5  // Below the audio tasks
+
+typedef enum {
+  BOOT_NVS,          // NVS flash init
+  BOOT_AUDIO,        // I2S (or file) backend, Opus decoder, playout task
+  BOOT_NETWORK,      // Wi-Fi association and DHCP
+  BOOT_SIGNALING,    // TLS setup and DNS lookup of the API host
+  BOOT_PEER,         // libpeer init and first PeerConnection (DTLS keys)
+  BOOT_CONNECT,      // Offer to PeerConnection CONNECTED
+  BOOT_FIRST_AUDIO,  // CONNECTED to the first downlink audio packet
+  BOOT_PHASE_COUNT,
+} BootPhase;
+
+#define BOOT_BIT(phase) (1u << (phase))
+
+// Create the event group; call first thing in app_main
+void boot_init(void);
+
+// Phase boundaries; only the first begin/end of a phase is recorded, so
+// later sessions calling the same hooks leave the boot figures alone
+void boot_begin(BootPhase phase);
+void boot_end(BootPhase phase);
+
+// Run fn as a phase in its own task pinned to core
+void boot_spawn(BootPhase phase, void (*fn)(void), const char* name, int core);
+
+// Block until every phase in bits (BOOT_BIT mask) has ended
+void boot_wait(uint32_t bits);
+
+// Print per-phase start/end and the boot-to-first-audio total, followed by
+// memory use per placement region and task stack high-water marks
+void boot_dump(void);
+
+#endif  // BOOT_H
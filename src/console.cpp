@@ -0,0 +1,68 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdio.h>
+
+#include "boot.h"
+#include "deadline.h"
+#include "latency.h"
+#include "main.h"
+#include "sched.h"
+
+// Serial console for on-demand diagnostics, typed into `idf.py monitor`:
+//   l  dump per-stage latency percentiles
+//   r  reset latency histograms
+//   d  dump frame deadline counters
+//   s  dump session reconnect, data-channel and loop counters
+//   b  dump boot phase timings and memory placement
+//   c  dump CPU use per task and core since the last dump
+//   n  switch microphone noise suppression on or off
+#define CONSOLE_POLL_INTERVAL 100  // stdin polling interval in milliseconds
+#define CONSOLE_TASK_STACK 4096    // Console task stack size in bytes
+#define CONSOLE_TASK_PRIORITY 1    // Lowest priority, never competes with audio
+
+// Polls stdin (non-blocking on the default UART/USB console) for commands
+static void console_task(void* user_data) {
+  while (1) {
+    int c = fgetc(stdin);
+    if (c == EOF) {
+      clearerr(stdin);
+      vTaskDelay(pdMS_TO_TICKS(CONSOLE_POLL_INTERVAL));
+      continue;
+    }
+
+    switch (c) {
+      case 'l':
+        latency_dump();
+        break;
+      case 'r':
+        latency_reset();
+        printf("Latency histograms reset\n");
+        break;
+      case 'd':
+        deadline_dump();
+        break;
+      case 's':
+        webrtc_dump();
+        break;
+      case 'b':
+        boot_dump();
+        break;
+      case 'c':
+        sched_dump();
+        break;
+      case 'n':
+        audio_noise_suppression(!audio_noise_suppression_enabled());
+        printf("Noise suppression %s\n",
+               audio_noise_suppression_enabled() ? "on" : "off");
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+// Start the diagnostics console task
+void start_console() {
+  xTaskCreate(console_task, "console", CONSOLE_TASK_STACK, NULL,
+              CONSOLE_TASK_PRIORITY, NULL);
+}
@@ -0,0 +1,126 @@
+#include "deadline.h"
+
+#include <esp_log.h>
+#include <string.h>
+
+#include "main.h"
+
+typedef struct {
+  DeadlineStats stats;
+  uint32_t window_frames;
+  uint64_t window_percent;  // Load summed over the current window
+  uint32_t window_peak;
+  uint32_t window_misses;
+} DeadlineMonitor;
+
+static DeadlineMonitor monitors[DEADLINE_STAGE_COUNT];
+
+bool deadline_record(DeadlineStage stage, int64_t released_us,
+                     int64_t start_us, int64_t end_us, int64_t budget_us) {
+  DeadlineMonitor* m = &monitors[stage];
+  int64_t work_us = end_us - start_us;
+  if (work_us < 0) {
+    work_us = 0;
+  }
+  if (budget_us <= 0) {
+    budget_us = 1;
+  }
+  uint32_t percent = (uint32_t)(work_us * 100 / budget_us);
+
+  m->stats.frames++;
+  if ((uint32_t)work_us > m->stats.max_us) {
+    m->stats.max_us = (uint32_t)work_us;
+  }
+  if (end_us - released_us > budget_us) {
+    m->stats.misses++;
+    m->window_misses++;
+  } else if (percent >= DEADLINE_SHED_PERCENT) {
+    m->stats.near_misses++;
+  }
+
+  m->window_percent += percent;
+  if (percent > m->window_peak) {
+    m->window_peak = percent;
+  }
+  if (++m->window_frames < DEADLINE_WINDOW_FRAMES) {
+    return false;
+  }
+
+  m->stats.load_percent = (uint32_t)(m->window_percent / m->window_frames);
+  m->stats.peak_percent = m->window_peak;
+  m->stats.window_misses = m->window_misses;
+  m->window_frames = 0;
+  m->window_percent = 0;
+  m->window_peak = 0;
+  m->window_misses = 0;
+  return true;
+}
+
+void deadline_stats(DeadlineStage stage, DeadlineStats* stats) {
+  *stats = monitors[stage].stats;
+}
+
+static const char* stage_names[DEADLINE_STAGE_COUNT] = {"encode", "decode"};
+
+void deadline_dump() {
+  ESP_LOGI(LOG_TAG, "%-8s %8s %7s %7s %8s %6s %6s", "deadline", "frames",
+           "misses", "near", "max(us)", "load", "peak");
+  for (int stage = 0; stage < DEADLINE_STAGE_COUNT; stage++) {
+    const DeadlineStats* s = &monitors[stage].stats;
+    ESP_LOGI(LOG_TAG, "%-8s %8lu %7lu %7lu %8lu %5lu%% %5lu%%",
+             stage_names[stage], (unsigned long)s->frames,
+             (unsigned long)s->misses, (unsigned long)s->near_misses,
+             (unsigned long)s->max_us, (unsigned long)s->load_percent,
+             (unsigned long)s->peak_percent);
+  }
+}
+
+void deadline_reset() {
+  memset(monitors, 0, sizeof(monitors));
+}
+
+void deadline_governor_init(DeadlineGovernor* governor, int complexity) {
+  governor->complexity = complexity;
+  governor->dsp_enabled = true;
+  governor->calm_windows = 0;
+  governor->sheds = 0;
+  governor->raises = 0;
+}
+
+bool deadline_governor_update(DeadlineGovernor* governor,
+                              const DeadlineStats* stats) {
+  // Overload: drop encoder complexity first, the echo canceller last
+  if (stats->window_misses > 0 ||
+      stats->peak_percent >= DEADLINE_SHED_PERCENT) {
+    governor->calm_windows = 0;
+    if (governor->complexity > 0) {
+      governor->complexity--;
+    } else if (governor->dsp_enabled) {
+      governor->dsp_enabled = false;
+    } else {
+      return false;
+    }
+    governor->sheds++;
+    return true;
+  }
+
+  if (stats->peak_percent >= DEADLINE_RAISE_PERCENT) {
+    governor->calm_windows = 0;
+    return false;
+  }
+  if (++governor->calm_windows < DEADLINE_CALM_WINDOWS) {
+    return false;
+  }
+
+  // Headroom: restore in the reverse order, one step per calm period
+  governor->calm_windows = 0;
+  if (!governor->dsp_enabled) {
+    governor->dsp_enabled = true;
+  } else if (governor->complexity < DEADLINE_MAX_COMPLEXITY) {
+    governor->complexity++;
+  } else {
+    return false;
+  }
+  governor->raises++;
+  return true;
+}
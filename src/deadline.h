@@ -0,0 +1,64 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+
+// Per-frame deadline monitor for the audio tasks and an overload governor
+// for the encode path. Every frame is checked against its budget (the audio
+// it covers): a miss is a frame finished later than released + budget, and
+// the CPU time spent on it is tracked as a share of the budget per window.
+// At the end of each window the governor sheds work (encoder complexity,
+// then the echo canceller) when the worst frame came close to the deadline
+// and adds it back one step at a time after several calm windows
+#define DEADLINE_WINDOW_FRAMES 50   // Frames per load window (1s at 20ms)
+#define DEADLINE_SHED_PERCENT 75    // Peak load that sheds one step
+#define DEADLINE_RAISE_PERCENT 35   // Peak load that allows one more step
+#define DEADLINE_CALM_WINDOWS 5     // Windows below that before raising
+#define DEADLINE_MAX_COMPLEXITY 10  // Highest OPUS_SET_COMPLEXITY used
+
+typedef enum {
+  DEADLINE_ENCODE,  // AEC + VAD + opus_encode + send, per captured frame
+  DEADLINE_DECODE,  // opus_decode or concealment, per played frame
+  DEADLINE_STAGE_COUNT,
+} DeadlineStage;
+
+// Deadline counters of one stage
+typedef struct {
+  uint32_t frames;         // Frames checked
+  uint32_t misses;         // Frames finished after their deadline
+  uint32_t near_misses;    // Frames above DEADLINE_SHED_PERCENT of budget
+  uint32_t max_us;         // Longest processing time seen
+  uint32_t load_percent;   // Mean processing time in the last window
+  uint32_t peak_percent;   // Worst frame in the last window
+  uint32_t window_misses;  // Misses in the last window
+} DeadlineStats;
+
+// Work the governor allows on the encode path
+typedef struct {
+  int complexity;         // OPUS_SET_COMPLEXITY
+  bool dsp_enabled;       // Optional DSP stages (echo canceller) running
+  uint32_t calm_windows;  // Consecutive windows with headroom
+  uint32_t sheds;         // Steps shed on overload
+  uint32_t raises;        // Steps added back with headroom
+} DeadlineGovernor;
+
+// Check one frame; each stage must be recorded from a single task
+// released_us: when the frame became ready (capture done, playout due)
+// start_us/end_us: processing span; budget_us: audio time the work covers
+// Returns true when this frame closed a load window
+bool deadline_record(DeadlineStage stage, int64_t released_us,
+                     int64_t start_us, int64_t end_us, int64_t budget_us);
+
+void deadline_stats(DeadlineStage stage, DeadlineStats* stats);
+void deadline_dump(void);   // Print the counters of every stage
+void deadline_reset(void);  // Clear all counters
+
+// Start at the given complexity with every DSP stage enabled
+void deadline_governor_init(DeadlineGovernor* governor, int complexity);
+
+// Apply the last closed window of a stage; true when the allowed work
+// changed
+bool deadline_governor_update(DeadlineGovernor* governor,
+                              const DeadlineStats* stats);
+
+#endif  // DEADLINE_H
@@ -0,0 +1,254 @@
+#include "dns_cache.h"
+
+#include <arpa/inet.h>
+#include <esp_timer.h>
+#include <netdb.h>
+#include <sdkconfig.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#if !CONFIG_IDF_TARGET_LINUX
+#include <lwip/dns.h>
+#endif
+
+#define DNS_PORT 53
+#define DNS_HEADER_SIZE 12
+#define DNS_PACKET_MAX 512  // Largest classic UDP DNS message
+#define DNS_TYPE_A 1
+#define DNS_TYPE_CNAME 5
+#define DNS_CLASS_IN 1
+
+typedef struct {
+  char host[64];       // Empty for an unused entry
+  uint32_t addr;       // IPv4 address, network order
+  int64_t expires_us;  // esp_timer time the answer goes stale
+} DnsCacheEntry;
+
+// Only used by the signaling task, no locking
+static DnsCacheEntry entries[DNS_CACHE_ENTRIES];
+static uint16_t query_id = 0;
+
+// Resolve through the system resolver, which does not report the TTL
+static bool dns_lookup_system(const char* host, uint32_t* addr,
+                              uint32_t* ttl) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* result = NULL;
+  if (getaddrinfo(host, NULL, &hints, &result) != 0 || result == NULL) {
+    return false;
+  }
+  *addr = ((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr;
+  *ttl = DNS_CACHE_MIN_TTL;
+  freeaddrinfo(result);
+  return true;
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+// Standard query for the A record of host, returns its size or 0
+static size_t dns_build_query(uint8_t* packet, uint16_t id, const char* host) {
+  memset(packet, 0, DNS_HEADER_SIZE);
+  packet[0] = id >> 8;
+  packet[1] = id & 0xff;
+  packet[2] = 0x01;  // Recursion desired
+  packet[5] = 1;     // One question
+
+  size_t pos = DNS_HEADER_SIZE;
+  const char* label = host;
+  while (*label != '\0') {
+    const char* dot = strchr(label, '.');
+    size_t length = dot != NULL ? (size_t)(dot - label) : strlen(label);
+    if (length == 0 || length > 63 || pos + length + 6 > DNS_PACKET_MAX) {
+      return 0;
+    }
+    packet[pos++] = (uint8_t)length;
+    memcpy(packet + pos, label, length);
+    pos += length;
+    label += dot != NULL ? length + 1 : length;
+  }
+  packet[pos++] = 0;
+  packet[pos++] = 0;
+  packet[pos++] = DNS_TYPE_A;
+  packet[pos++] = 0;
+  packet[pos++] = DNS_CLASS_IN;
+  return pos;
+}
+
+// Offset just past a (possibly compressed) name, 0 when malformed
+static size_t dns_skip_name(const uint8_t* packet, size_t size, size_t pos) {
+  while (pos < size) {
+    uint8_t length = packet[pos];
+    if (length == 0) {
+      return pos + 1;
+    }
+    if ((length & 0xc0) == 0xc0) {
+      return pos + 2 <= size ? pos + 2 : 0;
+    }
+    pos += 1 + length;
+  }
+  return 0;
+}
+
+static uint16_t dns_read16(const uint8_t* p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// First A record of a reply and the lowest TTL along the answer chain. The
+// reply must be a response with the query's ID that echoes its question
+// (name, type and class), so a stray datagram cannot poison the cache
+static bool dns_parse_reply(const uint8_t* packet, size_t size,
+                            const uint8_t* query, size_t query_size,
+                            uint32_t* addr, uint32_t* ttl) {
+  if (size < query_size || dns_read16(packet) != dns_read16(query) ||
+      (packet[2] & 0x80) == 0 || (packet[3] & 0x0f) != 0 ||
+      dns_read16(packet + 4) != 1 ||
+      memcmp(packet + DNS_HEADER_SIZE, query + DNS_HEADER_SIZE,
+             query_size - DNS_HEADER_SIZE) != 0) {
+    return false;
+  }
+  uint16_t answers = dns_read16(packet + 6);
+
+  size_t pos = query_size;
+
+  bool found = false;
+  uint32_t lowest = UINT32_MAX;
+  for (uint16_t i = 0; i < answers; i++) {
+    pos = dns_skip_name(packet, size, pos);
+    if (pos == 0 || pos + 10 > size) {
+      return false;
+    }
+    uint16_t type = dns_read16(packet + pos);
+    uint32_t record_ttl = ((uint32_t)dns_read16(packet + pos + 4) << 16) |
+                          dns_read16(packet + pos + 6);
+    uint16_t length = dns_read16(packet + pos + 8);
+    pos += 10;
+    if (pos + length > size) {
+      return false;
+    }
+    if ((type == DNS_TYPE_A || type == DNS_TYPE_CNAME) &&
+        record_ttl < lowest) {
+      lowest = record_ttl;
+    }
+    if (type == DNS_TYPE_A && length == 4 && !found) {
+      memcpy(addr, packet + pos, 4);
+      found = true;
+    }
+    pos += length;
+  }
+  *ttl = lowest;
+  return found;
+}
+
+// Ask the network's DNS server directly so the answer comes with its TTL
+static bool dns_lookup_server(const char* host, uint32_t* addr,
+                              uint32_t* ttl) {
+  const ip_addr_t* server = dns_getserver(0);
+  if (server == NULL || !IP_IS_V4(server) || ip_addr_isany(server)) {
+    return false;
+  }
+  struct sockaddr_in to;
+  memset(&to, 0, sizeof(to));
+  to.sin_family = AF_INET;
+  to.sin_port = htons(DNS_PORT);
+  to.sin_addr.s_addr = ip_2_ip4(server)->addr;
+
+  // Connected, so replies from any other address are dropped by the stack
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    return false;
+  }
+  if (connect(fd, (struct sockaddr*)&to, sizeof(to)) != 0) {
+    close(fd);
+    return false;
+  }
+  struct timeval timeout = {DNS_CACHE_TIMEOUT_MS / 1000,
+                            (DNS_CACHE_TIMEOUT_MS % 1000) * 1000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  uint8_t query[DNS_PACKET_MAX];
+  uint8_t reply[DNS_PACKET_MAX];
+  bool resolved = false;
+  for (int attempt = 0; attempt < DNS_CACHE_ATTEMPTS && !resolved; attempt++) {
+    uint16_t id = (uint16_t)(++query_id ^ esp_timer_get_time());
+    size_t size = dns_build_query(query, id, host);
+    if (size == 0) {
+      break;
+    }
+    if (send(fd, query, size, 0) < 0) {
+      continue;
+    }
+    int received = recv(fd, reply, sizeof(reply), 0);
+    resolved = received > 0 && dns_parse_reply(reply, (size_t)received, query,
+                                                size, addr, ttl);
+  }
+  close(fd);
+  return resolved;
+}
+#endif
+
+bool dns_cache_resolve(const char* host, uint32_t* addr) {
+  struct in_addr literal;
+  if (inet_aton(host, &literal)) {
+    *addr = literal.s_addr;
+    return true;
+  }
+
+  // Cached entry for the host, else a free one, else the stalest one
+  int64_t now_us = esp_timer_get_time();
+  DnsCacheEntry* entry = &entries[0];
+  for (int i = 0; i < DNS_CACHE_ENTRIES; i++) {
+    DnsCacheEntry* candidate = &entries[i];
+    if (strcmp(candidate->host, host) == 0) {
+      entry = candidate;
+      break;
+    }
+    if (entry->host[0] != '\0' &&
+        (candidate->host[0] == '\0' ||
+         candidate->expires_us < entry->expires_us)) {
+      entry = candidate;
+    }
+  }
+  bool cached = strcmp(entry->host, host) == 0;
+  if (cached && entry->expires_us > now_us) {
+    *addr = entry->addr;
+    return true;
+  }
+
+  uint32_t ttl = 0;
+  bool resolved = false;
+#if !CONFIG_IDF_TARGET_LINUX
+  resolved = dns_lookup_server(host, addr, &ttl);
+#endif
+  if (!resolved) {
+    resolved = dns_lookup_system(host, addr, &ttl);
+  }
+  if (!resolved) {
+    if (cached) {
+      *addr = entry->addr;  // Resolver unreachable: stale beats nothing
+      return true;
+    }
+    return false;
+  }
+
+  if (ttl < DNS_CACHE_MIN_TTL) {
+    ttl = DNS_CACHE_MIN_TTL;
+  } else if (ttl > DNS_CACHE_MAX_TTL) {
+    ttl = DNS_CACHE_MAX_TTL;
+  }
+  if (strlen(host) < sizeof(entry->host)) {
+    strcpy(entry->host, host);
+    entry->addr = *addr;
+    entry->expires_us = now_us + (int64_t)ttl * 1000000;
+  }
+  return true;
+}
+
+void dns_cache_invalidate(const char* host) {
+  for (int i = 0; i < DNS_CACHE_ENTRIES; i++) {
+    if (strcmp(entries[i].host, host) == 0) {
+      entries[i].expires_us = 0;
+    }
+  }
+}
@@ -0,0 +1,23 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <stdint.h>
+
+// Small IPv4 resolver cache that honours record TTLs. On the device the
+// query goes straight to the DHCP-provided DNS server so the TTL of the
+// answer (the lowest along any CNAME chain) is known; the Linux build falls
+// back to getaddrinfo with DNS_CACHE_MIN_TTL
+#define DNS_CACHE_ENTRIES 4        // Host names remembered
+#define DNS_CACHE_MIN_TTL 30       // Seconds, floor for very short TTLs
+#define DNS_CACHE_MAX_TTL 3600     // Seconds, cap for very long TTLs
+#define DNS_CACHE_TIMEOUT_MS 2000  // Wait for one DNS reply
+#define DNS_CACHE_ATTEMPTS 2       // Queries before giving up
+
+// Resolve host (name or dotted quad) to an IPv4 address in network order
+bool dns_cache_resolve(const char* host, uint32_t* addr);
+
+// Expire a host after connecting to its cached address failed (the old
+// address is only used again if the resolver cannot be reached)
+void dns_cache_invalidate(const char* host);
+
+#endif  // DNS_CACHE_H
@@ -0,0 +1,194 @@
+#include "dsp.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "pcm.h"
+
+#define DSP_HIGHPASS_SHIFT 16  // Fraction bits of the high-pass output state
+#define DSP_GATE_FALL 2        // log2 smoothing while the background falls
+#define DSP_GATE_RISE 5        // log2 smoothing while the background rises
+#define DSP_GATE_DRIFT 11      // log2 smoothing while the gate is open (40s)
+
+static inline int16_t saturate16(int32_t v) {
+  if (v > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (v < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)v;
+}
+
+// Q15 share of the distance a one-pole smoother with time constant tau_ms
+// covers in one block
+static int32_t block_step(uint32_t sample_rate, size_t block_samples,
+                          uint32_t tau_ms) {
+  double block_ms = 1000.0 * block_samples / sample_rate;
+  return (int32_t)lrint((1.0 - exp(-block_ms / tau_ms)) * 32768);
+}
+
+void dsp_chain_init(DspChain* chain) { memset(chain, 0, sizeof(*chain)); }
+
+DspStage* dsp_chain_add(DspChain* chain, const char* name, DspProcess process,
+                        void* state) {
+  if (chain->count == DSP_MAX_STAGES) {
+    return NULL;
+  }
+  DspStage* stage = &chain->stages[chain->count++];
+  stage->name = name;
+  stage->process = process;
+  stage->state = state;
+  stage->enabled = true;
+  return stage;
+}
+
+void dsp_chain_process(DspChain* chain, int16_t* pcm, size_t count) {
+  for (size_t i = 0; i < chain->count; i++) {
+    DspStage* stage = &chain->stages[i];
+    if (stage->enabled) {
+      stage->process(stage->state, pcm, count);
+    }
+  }
+}
+
+void dsp_highpass_init(DspHighpass* hp, uint32_t sample_rate,
+                       uint32_t cutoff_hz) {
+  hp->pole = (int32_t)lrint(exp(-2 * M_PI * cutoff_hz / sample_rate) * 32768);
+  hp->last = 0;
+  hp->out = 0;
+}
+
+void dsp_highpass_process(void* state, int16_t* pcm, size_t count) {
+  DspHighpass* hp = (DspHighpass*)state;
+  int64_t y = hp->out;
+  int32_t last = hp->last;
+  for (size_t i = 0; i < count; i++) {
+    int32_t x = pcm[i];
+    y = (int64_t)(x - last) * (1 << DSP_HIGHPASS_SHIFT) +
+        ((y * hp->pole) >> 15);
+    last = x;
+    pcm[i] = saturate16(
+        (int32_t)((y + (1 << (DSP_HIGHPASS_SHIFT - 1))) >> DSP_HIGHPASS_SHIFT));
+  }
+  hp->out = y;
+  hp->last = last;
+}
+
+void dsp_gate_init(DspGate* gate, uint32_t sample_rate, size_t block_samples) {
+  memset(gate, 0, sizeof(*gate));
+  gate->background = DSP_GATE_INITIAL_LEVEL << 8;
+  gate->gain = DSP_GATE_UNITY;
+  gate->open = true;
+  size_t hold_samples = (size_t)DSP_GATE_HOLD_MS * sample_rate / 1000;
+  gate->hold_blocks = (hold_samples + block_samples - 1) / block_samples;
+  gate->hold = gate->hold_blocks;
+}
+
+void dsp_gate_process(void* state, int16_t* pcm, size_t count) {
+  DspGate* gate = (DspGate*)state;
+  PcmLevel level;
+  pcm_level(pcm, count, &level);
+
+  // Open well above the background, close only once the level has been
+  // near it for the hold time
+  int64_t rms = (int64_t)level.rms << 8;
+  if (rms * 256 >= (int64_t)gate->background * DSP_GATE_OPEN_RATIO) {
+    gate->open = true;
+    gate->hold = gate->hold_blocks;
+  } else if (gate->open &&
+             rms * 256 >= (int64_t)gate->background * DSP_GATE_CLOSE_RATIO) {
+    gate->hold = gate->hold_blocks;
+  } else if (gate->hold > 0) {
+    gate->hold--;
+  } else {
+    gate->open = false;
+  }
+
+  // Learn the background while closed; while open only drift towards the
+  // level slowly, so a room that got louder is eventually learned but a
+  // sentence is not
+  int shift = DSP_GATE_DRIFT;
+  if (!gate->open) {
+    shift = rms < gate->background ? DSP_GATE_FALL : DSP_GATE_RISE;
+  }
+  gate->background += (int32_t)((rms - gate->background) >> shift);
+  if (gate->background < DSP_GATE_MIN_LEVEL << 8) {
+    gate->background = DSP_GATE_MIN_LEVEL << 8;
+  }
+
+  gate->blocks++;
+  if (!gate->open) {
+    gate->closed++;
+  }
+  int32_t target = gate->open ? DSP_GATE_UNITY : DSP_GATE_FLOOR;
+  if (target == DSP_GATE_UNITY && gate->gain == DSP_GATE_UNITY) {
+    return;
+  }
+
+  // Ramp from the last block's gain to this block's
+  int32_t start = gate->gain;
+  int32_t step = (target - start) / (int32_t)count;
+  int32_t gain = start;
+  for (size_t i = 0; i < count; i++) {
+    gain += step;
+    pcm[i] = (int16_t)((pcm[i] * gain) >> 15);
+  }
+  gate->gain = target;
+}
+
+void dsp_agc_init(DspAgc* agc, uint32_t sample_rate, size_t block_samples) {
+  agc->gain = PCM_GAIN_UNITY;
+  agc->attack = block_step(sample_rate, block_samples, DSP_AGC_ATTACK_MS);
+  agc->release = block_step(sample_rate, block_samples, DSP_AGC_RELEASE_MS);
+  agc->limited = 0;
+}
+
+void dsp_agc_process(void* state, int16_t* pcm, size_t count) {
+  DspAgc* agc = (DspAgc*)state;
+  PcmLevel level;
+  pcm_level(pcm, count, &level);
+
+  // Move towards the gain that puts this block at the target; quiet blocks
+  // (pauses, gated noise) hold the gain instead of pulling it up
+  int32_t start = agc->gain;
+  int32_t gain = start;
+  if (level.rms >= DSP_AGC_MIN_LEVEL) {
+    int32_t desired = (int32_t)(((int64_t)DSP_AGC_TARGET << 8) / level.rms);
+    if (desired < DSP_AGC_MIN_GAIN) {
+      desired = DSP_AGC_MIN_GAIN;
+    } else if (desired > DSP_AGC_MAX_GAIN) {
+      desired = DSP_AGC_MAX_GAIN;
+    }
+    int32_t rate = desired < gain ? agc->attack : agc->release;
+    int32_t delta = (int32_t)(((int64_t)(desired - gain) * rate) >> 15);
+    if (delta == 0 && desired != gain) {
+      delta = desired > gain ? 1 : -1;
+    }
+    gain += delta;
+  }
+
+  // A peak the gain would clip cuts it at once, for the whole block
+  if (level.peak > 0) {
+    int32_t limit = (int32_t)(((int64_t)DSP_AGC_PEAK << 8) / level.peak);
+    if (gain > limit) {
+      gain = limit;
+      agc->limited++;
+    }
+    if (start > limit) {
+      start = gain;
+    }
+  }
+  agc->gain = gain;
+
+  if (start == gain) {
+    pcm_gain(pcm, pcm, count, gain);
+    return;
+  }
+  int32_t step = (gain - start) * 65536 / (int32_t)count;
+  int32_t ramp = start * 65536;
+  for (size_t i = 0; i < count; i++) {
+    ramp += step;
+    pcm[i] = saturate16((pcm[i] * (ramp >> 16)) >> 8);
+  }
+}
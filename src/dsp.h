@@ -0,0 +1,95 @@
+#ifndef DSP_H
+#define DSP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-frame microphone DSP in front of the encoder
+// A chain is a fixed list of stages that each process one block in place
+// (no allocation, state carried across blocks). Stages: a first-order
+// DC-blocking high-pass, a noise gate that follows the background level,
+// and a fixed-point AGC that drives speech towards a target RMS with a
+// fast attack, a slow release and a peak limit. Gains are applied as a
+// ramp across the block, so a gain change never steps mid-waveform
+#define DSP_MAX_STAGES 4  // Stages per chain
+
+#define DSP_HIGHPASS_CUTOFF 80  // Hz, below the speech band, above mic DC
+
+#define DSP_GATE_UNITY 32768       // Gate gains are Q15
+#define DSP_GATE_OPEN_RATIO 512    // Q8 of the background to open (+6dB)
+#define DSP_GATE_CLOSE_RATIO 362   // Q8 of the background to close (+3dB)
+#define DSP_GATE_FLOOR 6554        // Gain while closed (-14dB)
+#define DSP_GATE_HOLD_MS 200       // Kept open after the level drops
+#define DSP_GATE_MIN_LEVEL 16      // RMS floor of the background estimate
+#define DSP_GATE_INITIAL_LEVEL 64  // Background RMS before it is measured
+
+#define DSP_AGC_TARGET 3277      // Speech RMS to reach (-20dBFS)
+#define DSP_AGC_MIN_GAIN 64      // Q8, -12dB
+#define DSP_AGC_MAX_GAIN 4096    // Q8, +24dB
+#define DSP_AGC_MIN_LEVEL 100    // Quieter blocks hold the gain
+#define DSP_AGC_ATTACK_MS 40     // Time constant of gain decreases
+#define DSP_AGC_RELEASE_MS 2000  // Time constant of gain increases
+#define DSP_AGC_PEAK 29491       // Limit: gained peak stays below -0.9dBFS
+
+// One stage: process count samples of pcm in place
+typedef void (*DspProcess)(void* state, int16_t* pcm, size_t count);
+
+typedef struct {
+  const char* name;
+  DspProcess process;
+  void* state;
+  bool enabled;  // Disabled stages are skipped and keep their state
+} DspStage;
+
+typedef struct {
+  DspStage stages[DSP_MAX_STAGES];
+  size_t count;
+} DspChain;
+
+// DC blocker: y[n] = x[n] - x[n-1] + R * y[n-1], R = exp(-2*pi*fc/fs).
+// The output is kept in Q16 between samples so quiet input does not get
+// stuck on a rounding limit cycle
+typedef struct {
+  int32_t pole;  // R in Q15
+  int32_t last;  // x[n-1]
+  int64_t out;   // y[n-1] in Q16
+} DspHighpass;
+
+typedef struct {
+  int32_t background;  // Q8 RMS of the input while the gate is closed
+  int32_t gain;        // Q15 gain reached at the end of the last block
+  uint32_t hold;       // Blocks left before the gate may close
+  uint32_t hold_blocks;
+  bool open;
+  uint32_t blocks;  // Blocks processed
+  uint32_t closed;  // Blocks that ended with the gate closed
+} DspGate;
+
+typedef struct {
+  int32_t gain;      // Q8 gain reached at the end of the last block
+  int32_t attack;    // Q15 step towards a lower gain per block
+  int32_t release;   // Q15 step towards a higher gain per block
+  uint32_t limited;  // Blocks whose gain the peak limit cut
+} DspAgc;
+
+void dsp_chain_init(DspChain* chain);
+
+// Append an enabled stage, NULL when the chain is full
+DspStage* dsp_chain_add(DspChain* chain, const char* name, DspProcess process,
+                        void* state);
+
+// Run every enabled stage over count samples in order
+void dsp_chain_process(DspChain* chain, int16_t* pcm, size_t count);
+
+// Stage state for blocks of block_samples at sample_rate
+void dsp_highpass_init(DspHighpass* highpass, uint32_t sample_rate,
+                       uint32_t cutoff_hz);
+void dsp_gate_init(DspGate* gate, uint32_t sample_rate, size_t block_samples);
+void dsp_agc_init(DspAgc* agc, uint32_t sample_rate, size_t block_samples);
+
+// Stage functions, state is the stage struct
+void dsp_highpass_process(void* state, int16_t* pcm, size_t count);
+void dsp_gate_process(void* state, int16_t* pcm, size_t count);
+void dsp_agc_process(void* state, int16_t* pcm, size_t count);
+
+#endif  // DSP_H
@@ -0,0 +1,42 @@
+#include "events.h"
+
+static const char* const type_key[] = {"type"};
+
+const EventRoute* events_dispatch(const EventRoute* routes, size_t count,
+                                  const char* msg, size_t length,
+                                  EventStats* stats, void* user_data) {
+  stats->messages++;
+  stats->bytes += length;
+
+  JsonSlice type;
+  if (json_scan(msg, length, type_key, &type, 1) != 1 ||
+      type.type != JSON_STRING) {
+    stats->malformed++;
+    return NULL;
+  }
+
+  const EventRoute* route = NULL;
+  for (size_t i = 0; i < count; i++) {
+    if (json_equals(&type, routes[i].type)) {
+      route = &routes[i];
+      break;
+    }
+  }
+  if (route == NULL) {
+    stats->unhandled++;
+    return NULL;
+  }
+
+  size_t keys = 0;
+  while (keys < EVENT_MAX_FIELDS && route->keys[keys] != NULL) {
+    keys++;
+  }
+  JsonSlice fields[EVENT_MAX_FIELDS];
+  if (keys > 0 && json_scan(msg, length, route->keys, fields, keys) < 0) {
+    stats->malformed++;
+    return NULL;
+  }
+  stats->handled++;
+  route->handler(fields, user_data);
+  return route;
+}
@@ -0,0 +1,38 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_scan.h"
+
+// Table-driven dispatch of Realtime API data-channel events. A first scan
+// reads only "type" (the first member the server sends, so it stops after a
+// few bytes), the route for that type is looked up, and a second scan pulls
+// just the fields the route asks for. Handlers get slices into the libpeer
+// receive buffer, valid only for the duration of the call
+#define EVENT_MAX_FIELDS 4  // Fields a route can request
+
+typedef void (*EventHandler)(const JsonSlice* fields, void* user_data);
+
+// One event type; keys are dotted paths, fields[i] holds keys[i]
+typedef struct {
+  const char* type;
+  EventHandler handler;
+  const char* keys[EVENT_MAX_FIELDS];  // Unused entries left NULL
+} EventRoute;
+
+typedef struct {
+  uint32_t messages;   // Messages received
+  uint32_t handled;    // Messages routed to a handler
+  uint32_t unhandled;  // Well-formed messages with no route
+  uint32_t malformed;  // Messages that are not a JSON object with a type
+  uint64_t bytes;      // Message bytes received
+} EventStats;
+
+// Route one message; returns the route taken, NULL if none
+const EventRoute* events_dispatch(const EventRoute* routes, size_t count,
+                                  const char* msg, size_t length,
+                                  EventStats* stats, void* user_data);
+
+#endif  // EVENTS_H
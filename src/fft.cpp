@@ -0,0 +1,81 @@
+#include "fft.h"
+
+#include <math.h>
+
+#include "mem.h"
+
+bool fft_init(Fft* fft, size_t size) {
+  fft->size = size;
+  if (size < 2 || size > FFT_MAX_SIZE || (size & (size - 1)) != 0) {
+    return false;
+  }
+  fft->cosine = (int16_t*)mem_alloc(MEM_INTERNAL, size / 2 * sizeof(int16_t));
+  fft->sine = (int16_t*)mem_alloc(MEM_INTERNAL, size / 2 * sizeof(int16_t));
+  fft->order = (uint16_t*)mem_alloc(MEM_INTERNAL, size * sizeof(uint16_t));
+  if (fft->cosine == NULL || fft->sine == NULL || fft->order == NULL) {
+    return false;
+  }
+
+  for (size_t k = 0; k < size / 2; k++) {
+    double angle = 2 * M_PI * k / size;
+    fft->cosine[k] = (int16_t)fmin(32767.0, lrint(cos(angle) * 32768));
+    fft->sine[k] = (int16_t)fmin(32767.0, lrint(sin(angle) * 32768));
+  }
+  int bits = fft_bits((uint32_t)size) - 1;
+  for (size_t i = 0; i < size; i++) {
+    size_t reversed = 0;
+    for (int b = 0; b < bits; b++) {
+      reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    fft->order[i] = (uint16_t)reversed;
+  }
+  return true;
+}
+
+// Iterative decimation in time; the twiddle sign selects the direction
+// (e^-j for forward) and shift halves every stage's output when set
+static void fft_transform(const Fft* fft, FftComplex* data, int32_t sign,
+                          int shift) {
+  size_t size = fft->size;
+  for (size_t i = 0; i < size; i++) {
+    size_t j = fft->order[i];
+    if (j > i) {
+      FftComplex t = data[i];
+      data[i] = data[j];
+      data[j] = t;
+    }
+  }
+
+  for (size_t half = 1; half < size; half <<= 1) {
+    size_t step = size / (half * 2);
+    for (size_t start = 0; start < size; start += half * 2) {
+      for (size_t j = 0; j < half; j++) {
+        int32_t wr = fft->cosine[j * step];
+        int32_t wi = -sign * fft->sine[j * step];
+        FftComplex* a = &data[start + j];
+        FftComplex* b = &data[start + j + half];
+        int64_t re = (int64_t)b->re * wr - (int64_t)b->im * wi;
+        int64_t im = (int64_t)b->re * wi + (int64_t)b->im * wr;
+        int32_t tr = (int32_t)(re >> 15);
+        int32_t ti = (int32_t)(im >> 15);
+        b->re = (a->re - tr) >> shift;
+        b->im = (a->im - ti) >> shift;
+        a->re = (a->re + tr) >> shift;
+        a->im = (a->im + ti) >> shift;
+      }
+    }
+  }
+}
+
+void fft_forward(const Fft* fft, FftComplex* data) {
+  fft_transform(fft, data, 1, 1);
+}
+
+void fft_inverse(const Fft* fft, FftComplex* data) {
+  fft_transform(fft, data, -1, 0);
+}
+
+int fft_bits(uint32_t v) {
+  return v == 0 ? 0 : 32 - __builtin_clz(v);
+}
+
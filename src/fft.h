@@ -0,0 +1,39 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-point radix-2 complex FFT for the spectral audio stages
+// Samples are 32-bit with Q15 twiddles and a 64-bit product in every
+// butterfly. The forward transform halves the data after each stage (the
+// result is X/size, so inputs below 2^29 never overflow); the inverse is
+// unscaled, so inverse(forward(x)) gives x back. Callers normalize blocks
+// towards 2^29 first to keep the precision of quiet input
+#define FFT_MAX_SIZE 1024  // Largest transform
+#define FFT_INPUT_BITS 29  // Forward input magnitude limit, log2
+
+typedef struct {
+  int32_t re;
+  int32_t im;
+} FftComplex;
+
+typedef struct {
+  size_t size;      // Points, a power of two
+  int16_t* cosine;  // size / 2 Q15 twiddles, cos(2*pi*k/size)
+  int16_t* sine;    // size / 2 Q15 twiddles, sin(2*pi*k/size)
+  uint16_t* order;  // Bit-reversed index of every point
+} Fft;
+
+// Build twiddle and bit-reversal tables in internal SRAM. False when size
+// is not a power of two up to FFT_MAX_SIZE, or memory runs out
+bool fft_init(Fft* fft, size_t size);
+
+// In place: forward computes X/size, inverse computes the unscaled inverse
+void fft_forward(const Fft* fft, FftComplex* data);
+void fft_inverse(const Fft* fft, FftComplex* data);
+
+// Bits needed to hold v (0 for 0), for block normalization
+int fft_bits(uint32_t v);
+
+#endif  // FFT_H
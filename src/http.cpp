@@ -1,117 +1,166 @@
-#include <esp_http_client.h>
 #include <esp_log.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <nvs.h>
+#include <sdkconfig.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "dns_cache.h"
+#include "https.h"
 #include "main.h"
 
-// Utility macro for safe minimum value calculation
-#ifndef MIN
-#define MIN(a, b) (((a) < (b)) ? (a) : (b))
-#endif
-
-// HTTP event handler for managing the complete HTTP request lifecycle
-// Handles events like connection, data reception, errors, and disconnection
-// evt: HTTP client event structure containing event type and data
-esp_err_t http_event_handler(esp_http_client_event_t* evt) {
-  static int output_len;  // Tracks total response data length
-
-  switch (evt->event_id) {
-    case HTTP_EVENT_REDIRECT:
-      ESP_LOGD(LOG_TAG, "HTTP_EVENT_REDIRECT");
-      // Set headers for redirect
-      esp_http_client_set_header(evt->client, "From", "rynn.zhng@gmail.com");
-      esp_http_client_set_header(evt->client, "Accept", "text/html");
-      esp_http_client_set_redirection(evt->client);
-      break;
-
-    case HTTP_EVENT_ERROR:
-      ESP_LOGD(LOG_TAG, "HTTP_EVENT_ERROR");
-      break;
-
-    case HTTP_EVENT_ON_CONNECTED:
-      ESP_LOGD(LOG_TAG, "HTTP_EVENT_ON_CONNECTED");
-      break;
-
-    case HTTP_EVENT_HEADER_SENT:
-      ESP_LOGD(LOG_TAG, "HTTP_EVENT_HEADER_SENT");
-      break;
-
-    case HTTP_EVENT_ON_HEADER:
-      ESP_LOGD(LOG_TAG, "HTTP_EVENT_ON_HEADER, key=%s, value=%s",
-               evt->header_key, evt->header_value);
-      break;
-
-    case HTTP_EVENT_ON_DATA: {
-      ESP_LOGD(LOG_TAG, "HTTP_EVENT_ON_DATA, len=%d", evt->data_len);
-
-      // Reject chunked responses as they're not supported
-      if (esp_http_client_is_chunked_response(evt->client)) {
-        ESP_LOGE(LOG_TAG, "Chunked HTTP response not supported");
-        esp_restart();
-      }
-
-      // Clear user buffer on first data chunk
-      if (output_len == 0 && evt->user_data) {
-        memset(evt->user_data, 0, MAX_HTTP_OUTPUT_BUFFER);
-      }
+#define HTTP_REQUEST_ATTEMPTS 3      // Tries before http_request fails
+#define HTTP_RETRY_DELAY_MS 500      // Backoff step between tries
+#define HTTP_NVS_NAMESPACE "http"    // NVS namespace of the signaling state
+#define HTTP_NVS_SESSION "tls_sess"  // NVS key of the saved TLS session
+
+// Signaling connection; the socket is only reused by retries within one
+// http_request (it is closed once the answer arrives), while the TLS session
+// is kept so a reconnect after a dropped PeerConnection can resume it
+static HttpsClient signaling;
+static bool signaling_ready = false;
+static char signaling_path[256];
+
+// Restore the TLS session saved by a previous boot
+static void http_session_load(void) {
+  nvs_handle_t handle;
+  if (nvs_open(HTTP_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+    return;
+  }
+  size_t size = 0;
+  if (nvs_get_blob(handle, HTTP_NVS_SESSION, NULL, &size) == ESP_OK &&
+      size > 0 && size <= HTTPS_SESSION_MAX) {
+    uint8_t* data = (uint8_t*)malloc(size);
+    if (data != NULL &&
+        nvs_get_blob(handle, HTTP_NVS_SESSION, data, &size) == ESP_OK &&
+        https_session_import(&signaling, data, size)) {
+      ESP_LOGI(LOG_TAG, "Restored TLS session (%u bytes)", (unsigned)size);
+    }
+    free(data);
+  }
+  nvs_close(handle);
+}
 
-      // Copy response data to user buffer if available
-      int copy_len = 0;
-      if (evt->user_data) {
-        // Calculate safe copy length to prevent buffer overflow
-        // Reserve last byte for null terminator
-        copy_len = MIN(evt->data_len, (MAX_HTTP_OUTPUT_BUFFER - output_len));
-        if (copy_len) {
-          memcpy(((char*)evt->user_data) + output_len, evt->data, copy_len);
-        }
-      }
-      output_len += copy_len;
-      break;
+// Persist the TLS session whenever the server handed out a new one
+static void http_session_save(void) {
+  if (!signaling.session_updated) {
+    return;
+  }
+  uint8_t* data = (uint8_t*)malloc(HTTPS_SESSION_MAX);
+  if (data == NULL) {
+    return;
+  }
+  size_t size = https_session_export(&signaling, data, HTTPS_SESSION_MAX);
+  nvs_handle_t handle;
+  if (nvs_open(HTTP_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+    if (size > 0) {
+      nvs_set_blob(handle, HTTP_NVS_SESSION, data, size);
+    } else {
+      nvs_erase_key(handle, HTTP_NVS_SESSION);
     }
+    nvs_commit(handle);
+    nvs_close(handle);
+  }
+  free(data);
+}
 
-    case HTTP_EVENT_ON_FINISH:
-      ESP_LOGD(LOG_TAG, "HTTP_EVENT_ON_FINISH");
-      output_len = 0;  // Reset output length counter
-      break;
+// Split OPENAI_REALTIMEAPI into host and path and set up the TLS client
+static void http_init(void) {
+  const char* url = OPENAI_REALTIMEAPI;
+  const char* host = strstr(url, "://");
+  host = host != NULL ? host + 3 : url;
+  const char* path = strchr(host, '/');
+  if (path == NULL) {
+    path = "/";
+  }
+  char hostname[sizeof(signaling.host)];
+  size_t host_len = strcspn(host, "/");
+  if (host_len >= sizeof(hostname) ||
+      strlen(path) >= sizeof(signaling_path)) {
+    ESP_LOGE(LOG_TAG, "Signaling URL too long");
+    esp_restart();
+  }
+  memcpy(hostname, host, host_len);
+  hostname[host_len] = '\0';
+  strcpy(signaling_path, path);
+
+#if CONFIG_ESP_TLS_SKIP_SERVER_CERT_VERIFY
+  bool verify = false;
+#else
+  bool verify = true;
+#endif
+  if (!https_init(&signaling, hostname, 443, verify)) {
+    ESP_LOGE(LOG_TAG, "TLS setup failed");
+    esp_restart();
+  }
+  http_session_load();
+  signaling_ready = true;
+}
 
-    case HTTP_EVENT_DISCONNECTED:
-      ESP_LOGI(LOG_TAG, "HTTP_EVENT_DISCONNECTED");
-      output_len = 0;  // Reset output length counter
-      break;
+// Set up TLS and resolve the API host before the first offer exists, so
+// neither is on the critical path of the first session
+void http_prepare() {
+  if (!signaling_ready) {
+    http_init();
+  }
+  uint32_t addr;
+  if (!dns_cache_resolve(signaling.host, &addr)) {
+    ESP_LOGW(LOG_TAG, "Could not resolve %s ahead", signaling.host);
   }
-  return ESP_OK;
 }
 
-// Makes an HTTP POST request to the OpenAI API with WebRTC signaling data
+// Makes an HTTP POST request to the OpenAI API with WebRTC signaling data.
+// The answer is read by https_post into a per-request buffer that grows as
+// it arrives, whether chunked or not, so large answers never truncate
 // offer: SDP offer to send to the API
-// answer: Buffer to store the API response (SDP answer)
-void http_request(char* offer, char* answer) {
-  // Initialize HTTP client configuration
-  esp_http_client_config_t config;
-  memset(&config, 0, sizeof(esp_http_client_config_t));
-
-  // Set API endpoint and event handlers
-  config.url = OPENAI_REALTIMEAPI;
-  config.event_handler = http_event_handler;
-  config.user_data = answer;  // Response will be stored in answer buffer
-
-  // Prepare authorization header with API key
-  snprintf(answer, MAX_HTTP_OUTPUT_BUFFER, "Bearer %s", OPENAI_API_KEY);
+// Returns the SDP answer, to be released with free(), or NULL on failure
+char* http_request(char* offer) {
+  if (!signaling_ready) {
+    http_init();
+  }
 
-  // Initialize HTTP client and configure request
-  esp_http_client_handle_t client = esp_http_client_init(&config);
-  esp_http_client_set_method(client, HTTP_METHOD_POST);
-  esp_http_client_set_header(client, "Content-Type", "application/sdp");
-  esp_http_client_set_header(client, "Authorization", answer);
-  esp_http_client_set_post_field(client, offer, strlen(offer));
+  // Authorization header with API key
+  static const char headers[] = "Authorization: Bearer " OPENAI_API_KEY "\r\n";
 
-  // Perform HTTP request and check response
-  esp_err_t err = esp_http_client_perform(client);
-  if (err != ESP_OK || esp_http_client_get_status_code(client) != 201) {
-    ESP_LOGE(LOG_TAG, "Error perform http request %s", esp_err_to_name(err));
-    esp_restart();  // Restart ESP on HTTP error
+  HttpsResponse response = {};
+  int status = -1;
+  for (int attempt = 1; attempt <= HTTP_REQUEST_ATTEMPTS; attempt++) {
+    status = https_post(&signaling, signaling_path, headers, "application/sdp",
+                        offer, strlen(offer), &response);
+    http_session_save();
+    if (status == 201 && response.length > 0) {
+      break;
+    }
+    ESP_LOGW(LOG_TAG, "Signaling attempt %d failed (status %d)", attempt,
+             status);
+    // Client errors other than rate limiting will not go away by retrying
+    if (status >= 400 && status < 500 && status != 429) {
+      break;
+    }
+    if (attempt < HTTP_REQUEST_ATTEMPTS) {
+      vTaskDelay(pdMS_TO_TICKS(HTTP_RETRY_DELAY_MS * attempt));
+    }
+  }
+  if (status != 201 || response.length == 0) {
+    ESP_LOGE(LOG_TAG, "Error perform http request, status %d", status);
+    https_response_free(&response);
+    https_close(&signaling);
+    return NULL;  // The session retries with a new PeerConnection
   }
 
-  // Clean up HTTP client
-  esp_http_client_cleanup(client);
+  HttpsStats* stats = &signaling.stats;
+  ESP_LOGI(LOG_TAG,
+           "Signaling: dns %lums connect %lums handshake %lums, "
+           "%lu connects %lu resumed %lu reused",
+           (unsigned long)stats->dns_us / 1000,
+           (unsigned long)stats->connect_us / 1000,
+           (unsigned long)stats->handshake_us / 1000,
+           (unsigned long)stats->connects, (unsigned long)stats->resumed,
+           (unsigned long)stats->reused);
+
+  // The answer is all this connection is needed for; the session stays
+  https_close(&signaling);
+  return response.data;
 }
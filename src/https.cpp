@@ -0,0 +1,485 @@
+#include "https.h"
+
+#include <errno.h>
+#include <esp_timer.h>
+#include <mbedtls/net_sockets.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sdkconfig.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#if CONFIG_SPIRAM
+#include <esp_heap_caps.h>
+#endif
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+#include <esp_crt_bundle.h>
+#endif
+#if defined(MBEDTLS_USE_PSA_CRYPTO) || defined(MBEDTLS_SSL_PROTO_TLS1_3)
+#include <psa/crypto.h>
+#endif
+
+#include "dns_cache.h"
+
+#ifdef MSG_NOSIGNAL
+#define HTTPS_SEND_FLAGS MSG_NOSIGNAL  // Broken connections fail, not signal
+#else
+#define HTTPS_SEND_FLAGS 0
+#endif
+
+// Large buffers go to PSRAM when there is some, internal RAM otherwise
+static void* https_realloc(void* ptr, size_t size) {
+#if CONFIG_SPIRAM
+  void* moved = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM);
+  if (moved != NULL) {
+    return moved;
+  }
+#endif
+  return realloc(ptr, size);
+}
+
+// Make room for `needed` body bytes plus the terminator, doubling the buffer
+static bool https_response_reserve(HttpsResponse* response, size_t needed) {
+  if (needed + 1 <= response->capacity) {
+    return true;
+  }
+  if (needed + 1 > HTTPS_RESPONSE_MAX) {
+    return false;
+  }
+  size_t capacity =
+      response->capacity > 0 ? response->capacity : HTTPS_RESPONSE_INITIAL;
+  while (capacity < needed + 1) {
+    capacity *= 2;
+  }
+  if (capacity > HTTPS_RESPONSE_MAX) {
+    capacity = HTTPS_RESPONSE_MAX;
+  }
+  char* data = (char*)https_realloc(response->data, capacity);
+  if (data == NULL) {
+    return false;
+  }
+  response->data = data;
+  response->capacity = capacity;
+  return true;
+}
+
+void https_response_free(HttpsResponse* response) {
+  free(response->data);
+  response->data = NULL;
+  response->length = 0;
+  response->capacity = 0;
+}
+
+// mbedtls transport callbacks on the plain socket (ctx points at the fd)
+static int https_send(void* ctx, const unsigned char* data, size_t size) {
+  int sent = send(*(int*)ctx, data, size, HTTPS_SEND_FLAGS);
+  if (sent >= 0) {
+    return sent;
+  }
+  if (errno == EINTR) {
+    return MBEDTLS_ERR_SSL_WANT_WRITE;
+  }
+  if (errno == EPIPE || errno == ECONNRESET) {
+    return MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  return MBEDTLS_ERR_NET_SEND_FAILED;
+}
+
+static int https_recv(void* ctx, unsigned char* data, size_t size) {
+  int received = recv(*(int*)ctx, data, size, 0);
+  if (received >= 0) {
+    return received;
+  }
+  if (errno == EINTR) {
+    return MBEDTLS_ERR_SSL_WANT_READ;
+  }
+  if (errno == EAGAIN || errno == EWOULDBLOCK) {
+    return MBEDTLS_ERR_SSL_TIMEOUT;
+  }
+  if (errno == EPIPE || errno == ECONNRESET) {
+    return MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  return MBEDTLS_ERR_NET_RECV_FAILED;
+}
+
+bool https_init(HttpsClient* client, const char* host, uint16_t port,
+                bool verify) {
+  if (strlen(host) >= sizeof(client->host)) {
+    return false;
+  }
+  strcpy(client->host, host);
+  client->port = port;
+  client->fd = -1;
+  client->session_valid = false;
+  client->session_updated = false;
+  client->buffer_pos = 0;
+  client->buffer_len = 0;
+  memset(&client->stats, 0, sizeof(client->stats));
+
+  mbedtls_entropy_init(&client->entropy);
+  mbedtls_ctr_drbg_init(&client->drbg);
+  mbedtls_ssl_config_init(&client->conf);
+  mbedtls_ssl_init(&client->ssl);
+  mbedtls_ssl_session_init(&client->session);
+
+#if defined(MBEDTLS_USE_PSA_CRYPTO) || defined(MBEDTLS_SSL_PROTO_TLS1_3)
+  if (psa_crypto_init() != PSA_SUCCESS) {
+    return false;
+  }
+#endif
+  if (mbedtls_ctr_drbg_seed(&client->drbg, mbedtls_entropy_func,
+                            &client->entropy, (const unsigned char*)host,
+                            strlen(host)) != 0 ||
+      mbedtls_ssl_config_defaults(&client->conf, MBEDTLS_SSL_IS_CLIENT,
+                                  MBEDTLS_SSL_TRANSPORT_STREAM,
+                                  MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+    return false;
+  }
+  mbedtls_ssl_conf_rng(&client->conf, mbedtls_ctr_drbg_random, &client->drbg);
+
+  int authmode = MBEDTLS_SSL_VERIFY_NONE;
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+  if (verify) {
+    esp_crt_bundle_attach(&client->conf);
+    authmode = MBEDTLS_SSL_VERIFY_REQUIRED;
+  }
+#else
+  (void)verify;
+#endif
+  mbedtls_ssl_conf_authmode(&client->conf, authmode);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&client->conf,
+                                   MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+  return mbedtls_ssl_setup(&client->ssl, &client->conf) == 0 &&
+         mbedtls_ssl_set_hostname(&client->ssl, host) == 0;
+}
+
+// Keep the session just negotiated (with any fresh ticket) for next time
+static void https_keep_session(HttpsClient* client) {
+  mbedtls_ssl_session_free(&client->session);
+  mbedtls_ssl_session_init(&client->session);
+  client->session_valid =
+      mbedtls_ssl_get_session(&client->ssl, &client->session) == 0;
+  client->session_updated = client->session_valid;
+}
+
+// Resolve, connect and handshake, offering the cached session if any
+static bool https_connect(HttpsClient* client) {
+  int64_t start_us = esp_timer_get_time();
+  uint32_t addr = 0;
+  if (!dns_cache_resolve(client->host, &addr)) {
+    return false;
+  }
+  int64_t resolved_us = esp_timer_get_time();
+  client->stats.dns_us = (uint32_t)(resolved_us - start_us);
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct timeval timeout = {HTTPS_TIMEOUT_MS / 1000,
+                            (HTTPS_TIMEOUT_MS % 1000) * 1000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  int nodelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+  struct sockaddr_in to;
+  memset(&to, 0, sizeof(to));
+  to.sin_family = AF_INET;
+  to.sin_port = htons(client->port);
+  to.sin_addr.s_addr = addr;
+  if (connect(fd, (struct sockaddr*)&to, sizeof(to)) != 0) {
+    close(fd);
+    dns_cache_invalidate(client->host);
+    return false;
+  }
+  int64_t connected_us = esp_timer_get_time();
+  client->stats.connect_us = (uint32_t)(connected_us - resolved_us);
+  client->stats.connects++;
+  client->fd = fd;
+  client->buffer_pos = 0;
+  client->buffer_len = 0;
+
+  mbedtls_ssl_session_reset(&client->ssl);
+  mbedtls_ssl_set_bio(&client->ssl, &client->fd, https_send, https_recv,
+                      NULL);
+  if (client->session_valid &&
+      mbedtls_ssl_set_session(&client->ssl, &client->session) == 0) {
+    client->stats.resumed++;
+  }
+
+  int ret;
+  while ((ret = mbedtls_ssl_handshake(&client->ssl)) != 0) {
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+      https_close(client);
+      return false;
+    }
+  }
+  client->stats.handshake_us = (uint32_t)(esp_timer_get_time() - connected_us);
+  https_keep_session(client);
+  return true;
+}
+
+void https_close(HttpsClient* client) {
+  if (client->fd < 0) {
+    return;
+  }
+  mbedtls_ssl_close_notify(&client->ssl);
+  close(client->fd);
+  client->fd = -1;
+  client->buffer_pos = 0;
+  client->buffer_len = 0;
+}
+
+void https_forget_session(HttpsClient* client) {
+  mbedtls_ssl_session_free(&client->session);
+  mbedtls_ssl_session_init(&client->session);
+  client->session_valid = false;
+  client->session_updated = true;
+}
+
+size_t https_session_export(HttpsClient* client, uint8_t* buffer,
+                            size_t size) {
+  client->session_updated = false;
+  size_t length = 0;
+  if (!client->session_valid ||
+      mbedtls_ssl_session_save(&client->session, buffer, size, &length) != 0) {
+    return 0;
+  }
+  return length;
+}
+
+bool https_session_import(HttpsClient* client, const uint8_t* data,
+                          size_t size) {
+  mbedtls_ssl_session_free(&client->session);
+  mbedtls_ssl_session_init(&client->session);
+  client->session_valid =
+      mbedtls_ssl_session_load(&client->session, data, size) == 0;
+  return client->session_valid;
+}
+
+static bool https_write(HttpsClient* client, const char* data, size_t size) {
+  while (size > 0) {
+    int ret = mbedtls_ssl_write(&client->ssl, (const unsigned char*)data, size);
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+      continue;
+    }
+    if (ret <= 0) {
+      return false;
+    }
+    data += ret;
+    size -= ret;
+  }
+  return true;
+}
+
+// Refill the read buffer; false on close, timeout or error
+static bool https_fill(HttpsClient* client) {
+  while (1) {
+    int ret = mbedtls_ssl_read(&client->ssl, client->buffer,
+                               sizeof(client->buffer));
+    if (ret > 0) {
+      client->buffer_pos = 0;
+      client->buffer_len = (size_t)ret;
+      return true;
+    }
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+      continue;
+    }
+#ifdef MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET
+    if (ret == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET) {
+      https_keep_session(client);  // TLS 1.3 tickets come after the handshake
+      continue;
+    }
+#endif
+    return false;
+  }
+}
+
+// One CRLF-terminated line without its terminator; false on EOF or overflow
+static bool https_read_line(HttpsClient* client, char* line, size_t size) {
+  size_t length = 0;
+  while (1) {
+    if (client->buffer_pos == client->buffer_len && !https_fill(client)) {
+      return false;
+    }
+    char c = (char)client->buffer[client->buffer_pos++];
+    if (c == '\n') {
+      if (length > 0 && line[length - 1] == '\r') {
+        length--;
+      }
+      line[length] = '\0';
+      return true;
+    }
+    if (length + 1 >= size) {
+      return false;
+    }
+    line[length++] = c;
+  }
+}
+
+// Append count body bytes to the response; SIZE_MAX reads until the server
+// closes the connection
+static bool https_read_body(HttpsClient* client, HttpsResponse* response,
+                            size_t count) {
+  while (count > 0) {
+    if (client->buffer_pos == client->buffer_len && !https_fill(client)) {
+      return count == SIZE_MAX;
+    }
+    size_t available = client->buffer_len - client->buffer_pos;
+    size_t take = available < count ? available : count;
+    if (!https_response_reserve(response, response->length + take)) {
+      return false;
+    }
+    memcpy(response->data + response->length,
+           client->buffer + client->buffer_pos, take);
+    response->length += take;
+    response->data[response->length] = '\0';
+    client->buffer_pos += take;
+    if (count != SIZE_MAX) {
+      count -= take;
+    }
+  }
+  return true;
+}
+
+// Header value after "Name:", or NULL when the line is another header
+static const char* https_header(const char* line, const char* name) {
+  size_t length = strlen(name);
+  if (strncasecmp(line, name, length) != 0 || line[length] != ':') {
+    return NULL;
+  }
+  const char* value = line + length + 1;
+  while (*value == ' ' || *value == '\t') {
+    value++;
+  }
+  return value;
+}
+
+// Send one request on the open connection and read the full response
+// Returns the status or -1; keep_alive tells whether the connection is
+// still usable afterwards
+static int https_exchange(HttpsClient* client, const char* path,
+                          const char* headers, const char* content_type,
+                          const char* body, size_t body_len,
+                          HttpsResponse* response, bool* keep_alive) {
+  *keep_alive = false;
+  const char* format =
+      "POST %s HTTP/1.1\r\nHost: %s\r\nContent-Type: %s\r\n"
+      "Content-Length: %lu\r\n%sConnection: keep-alive\r\n\r\n";
+  const char* extra = headers != NULL ? headers : "";
+  int head_len = snprintf(NULL, 0, format, path, client->host, content_type,
+                          (unsigned long)body_len, extra);
+  char* head = (char*)malloc(head_len + 1);
+  if (head == NULL) {
+    return -1;
+  }
+  snprintf(head, head_len + 1, format, path, client->host, content_type,
+           (unsigned long)body_len, extra);
+  bool sent = https_write(client, head, head_len) &&
+              https_write(client, body, body_len);
+  free(head);
+  if (!sent) {
+    return -1;
+  }
+
+  // Status line and headers, skipping interim 1xx responses
+  char line[HTTPS_HEADER_MAX];
+  int status = 0;
+  long content_length = -1;
+  bool chunked = false;
+  bool close_after = false;
+  do {
+    if (!https_read_line(client, line, sizeof(line)) ||
+        sscanf(line, "HTTP/%*d.%*d %d", &status) != 1) {
+      return -1;
+    }
+    while (1) {
+      if (!https_read_line(client, line, sizeof(line))) {
+        return -1;
+      }
+      if (line[0] == '\0') {
+        break;
+      }
+      const char* value;
+      if ((value = https_header(line, "Content-Length")) != NULL) {
+        content_length = strtol(value, NULL, 10);
+      } else if ((value = https_header(line, "Transfer-Encoding")) != NULL) {
+        chunked = strncasecmp(value, "chunked", 7) == 0;
+      } else if ((value = https_header(line, "Connection")) != NULL) {
+        close_after = strncasecmp(value, "close", 5) == 0;
+      }
+    }
+  } while (status >= 100 && status < 200);
+
+  bool complete = true;
+  if (status == 204 || status == 304) {
+    // No body
+  } else if (chunked) {
+    while (1) {
+      if (!https_read_line(client, line, sizeof(line))) {
+        complete = false;
+        break;
+      }
+      size_t chunk = strtoul(line, NULL, 16);
+      if (chunk == 0) {
+        // Optional trailers end with an empty line
+        while (https_read_line(client, line, sizeof(line)) && line[0] != '\0') {
+        }
+        break;
+      }
+      if (!https_read_body(client, response, chunk) ||
+          !https_read_line(client, line, sizeof(line))) {
+        complete = false;
+        break;
+      }
+    }
+  } else if (content_length >= 0) {
+    complete = https_read_body(client, response, (size_t)content_length);
+  } else {
+    complete = https_read_body(client, response, SIZE_MAX);
+    close_after = true;
+  }
+
+  *keep_alive = complete && !close_after;
+  return complete ? status : -1;
+}
+
+int https_post(HttpsClient* client, const char* path, const char* headers,
+               const char* content_type, const char* body, size_t body_len,
+               HttpsResponse* response) {
+  client->stats.requests++;
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool reused = client->fd >= 0;
+    if (reused) {
+      client->stats.reused++;
+    } else if (!https_connect(client)) {
+      break;
+    }
+
+    response->length = 0;
+    bool keep_alive = false;
+    int status = https_exchange(client, path, headers, content_type, body,
+                                body_len, response, &keep_alive);
+    if (!keep_alive) {
+      https_close(client);
+    }
+    if (status >= 0) {
+      return status;
+    }
+    // An idle kept-alive connection may have been closed by the server in
+    // the meantime: try once more on a fresh one
+    if (!reused) {
+      break;
+    }
+  }
+  client->stats.failures++;
+  return -1;
+}
@@ -0,0 +1,89 @@
+#ifndef HTTPS_H
+#define HTTPS_H
+
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ssl.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal HTTPS/1.1 client for signaling, built on mbedtls so the TLS
+// session can be kept across connections (and exported for persistence):
+// a reconnect with a cached session ID or ticket skips the certificate
+// exchange and key agreement of a full handshake. The connection is kept
+// open between requests and reopened transparently when the server closed
+// it. Responses may use Content-Length, chunked encoding or close-delimiting
+#define HTTPS_TIMEOUT_MS 10000       // Socket send/receive timeout
+#define HTTPS_READ_BUFFER 1024       // Bytes buffered from the TLS stream
+#define HTTPS_HEADER_MAX 512         // Longest response header line accepted
+#define HTTPS_RESPONSE_MAX 65536     // Largest response body accepted
+#define HTTPS_RESPONSE_INITIAL 2048  // First body allocation, then doubled
+#define HTTPS_SESSION_MAX 4096       // Largest serialized TLS session
+
+// Response body, NUL-terminated, grown geometrically (PSRAM if present)
+typedef struct {
+  char* data;
+  size_t length;
+  size_t capacity;
+} HttpsResponse;
+
+// Connection counters
+typedef struct {
+  uint32_t requests;      // Requests sent
+  uint32_t connects;      // TCP connections opened
+  uint32_t reused;        // Requests sent on an already open connection
+  uint32_t resumed;       // Handshakes offering a cached TLS session
+  uint32_t failures;      // Requests that failed at transport level
+  uint32_t dns_us;        // Last name lookup
+  uint32_t connect_us;    // Last TCP connect
+  uint32_t handshake_us;  // Last TLS handshake
+} HttpsStats;
+
+typedef struct {
+  char host[64];
+  uint16_t port;
+  int fd;  // Socket, -1 while closed
+
+  mbedtls_entropy_context entropy;
+  mbedtls_ctr_drbg_context drbg;
+  mbedtls_ssl_config conf;
+  mbedtls_ssl_context ssl;
+  mbedtls_ssl_session session;  // Last negotiated session, for resumption
+  bool session_valid;
+  bool session_updated;  // New session since the last https_session_export
+
+  uint8_t buffer[HTTPS_READ_BUFFER];  // Decrypted bytes not yet consumed
+  size_t buffer_pos;
+  size_t buffer_len;
+  HttpsStats stats;
+} HttpsClient;
+
+// Set up TLS for a host; verify checks the server certificate against the
+// bundled CA store (target builds with the certificate bundle enabled)
+bool https_init(HttpsClient* client, const char* host, uint16_t port,
+                bool verify);
+
+// POST body to path. headers: extra "Name: value\r\n" lines (may be NULL)
+// Returns the HTTP status, or -1 when the request could not be completed.
+// The body is left in response; release it with https_response_free
+int https_post(HttpsClient* client, const char* path, const char* headers,
+               const char* content_type, const char* body, size_t body_len,
+               HttpsResponse* response);
+
+// Close the connection but keep the TLS session for the next one
+void https_close(HttpsClient* client);
+
+// Drop the cached TLS session: the next connection does a full handshake
+void https_forget_session(HttpsClient* client);
+
+// Serialize the cached session for persistence, returns its size or 0
+size_t https_session_export(HttpsClient* client, uint8_t* buffer,
+                            size_t size);
+
+// Restore a session saved by https_session_export
+bool https_session_import(HttpsClient* client, const uint8_t* data,
+                          size_t size);
+
+void https_response_free(HttpsResponse* response);
+
+#endif  // HTTPS_H
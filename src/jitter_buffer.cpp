@@ -0,0 +1,212 @@
+#include "jitter_buffer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem.h"
+
+#define JITTER_BUFFER_FRAME_US (JITTER_BUFFER_FRAME_MS * 1000)
+#define JITTER_BUFFER_SLOT_MASK (JITTER_BUFFER_SLOTS - 1)
+
+// Allocate packet slots and start in the buffering state; the slots are
+// touched once per packet and frame, so they live in PSRAM
+bool jitter_buffer_init(JitterBuffer* jb) {
+  jb->slots = (JitterBufferSlot*)mem_alloc(
+      MEM_PSRAM, JITTER_BUFFER_SLOTS * sizeof(JitterBufferSlot));
+  if (jb->slots == NULL) {
+    return false;
+  }
+  jitter_buffer_reset(jb);
+  return true;
+}
+
+// Forget every buffered packet and all timing state
+void jitter_buffer_reset(JitterBuffer* jb) {
+  for (int i = 0; i < JITTER_BUFFER_SLOTS; i++) {
+    jb->slots[i].valid = false;
+  }
+  jb->count = 0;
+  jb->next_seq = 0;
+  jb->highest_seq = 0;
+  jb->synced = false;
+  jb->playing = false;
+  jb->target_frames = JITTER_BUFFER_MIN_FRAMES;
+  jb->conceal_run = 0;
+  jb->last_arrival_us = 0;
+  jb->last_timestamp = 0;
+  jb->have_transit = false;
+  jb->jitter_us_q4 = 0;
+  memset(&jb->stats, 0, sizeof(jb->stats));
+}
+
+// Drop every buffered packet but keep timing and counters
+static void jitter_buffer_flush(JitterBuffer* jb) {
+  for (int i = 0; i < JITTER_BUFFER_SLOTS; i++) {
+    if (jb->slots[i].valid) {
+      jb->slots[i].valid = false;
+      jb->stats.dropped++;
+    }
+  }
+  jb->count = 0;
+}
+
+// Update the RFC 3550 interarrival jitter estimate and derive the playout
+// target: one frame plus three times the jitter, rounded up to whole frames
+static void jitter_buffer_update_target(JitterBuffer* jb, uint32_t timestamp,
+                                        int64_t arrival_us) {
+  if (jb->have_transit) {
+    int64_t arrival_delta = arrival_us - jb->last_arrival_us;
+    int64_t media_delta = (int64_t)(int32_t)(timestamp - jb->last_timestamp) *
+                          1000000 / JITTER_BUFFER_RTP_CLOCK;
+    int64_t d = arrival_delta - media_delta;
+    if (d < 0) {
+      d = -d;
+    }
+    // J += (|D| - J) / 16, kept in Q4 to avoid losing the fraction
+    jb->jitter_us_q4 += d - (jb->jitter_us_q4 + 8) / 16;
+  }
+  jb->last_arrival_us = arrival_us;
+  jb->last_timestamp = timestamp;
+  jb->have_transit = true;
+
+  int64_t jitter_us = jb->jitter_us_q4 / 16;
+  uint32_t frames =
+      1 + (uint32_t)((3 * jitter_us + JITTER_BUFFER_FRAME_US - 1) /
+                     JITTER_BUFFER_FRAME_US);
+  if (frames < JITTER_BUFFER_MIN_FRAMES) {
+    frames = JITTER_BUFFER_MIN_FRAMES;
+  } else if (frames > JITTER_BUFFER_MAX_FRAMES) {
+    frames = JITTER_BUFFER_MAX_FRAMES;
+  }
+  jb->target_frames = frames;
+}
+
+// Store a packet in its sequence slot; packets behind the playout point are
+// counted as late and dropped
+void jitter_buffer_insert(JitterBuffer* jb, uint16_t seq, uint32_t timestamp,
+                          const uint8_t* data, size_t size,
+                          int64_t arrival_us) {
+  if (size == 0 || size > JITTER_BUFFER_MAX_PACKET) {
+    jb->stats.dropped++;
+    return;
+  }
+  jb->stats.received++;
+  jitter_buffer_update_target(jb, timestamp, arrival_us);
+
+  if (!jb->synced) {
+    jb->next_seq = seq;
+    jb->highest_seq = seq;
+    jb->synced = true;
+  }
+
+  int16_t offset = (int16_t)(seq - jb->next_seq);
+  if (offset < 0) {
+    // Before playout starts a reordered packet may still move the start back
+    if (!jb->playing &&
+        (uint16_t)(jb->highest_seq - seq) < JITTER_BUFFER_SLOTS) {
+      jb->next_seq = seq;
+    } else {
+      jb->stats.late++;
+      return;
+    }
+  } else if (offset >= JITTER_BUFFER_SLOTS) {
+    // Stream jumped ahead of everything we can hold: resynchronise
+    jitter_buffer_flush(jb);
+    jb->next_seq = seq;
+    jb->highest_seq = seq;
+    if (jb->playing) {
+      jb->playing = false;
+      jb->stats.rebuffers++;
+    }
+  }
+
+  if ((int16_t)(seq - jb->highest_seq) > 0) {
+    jb->highest_seq = seq;
+  }
+
+  JitterBufferSlot* slot = &jb->slots[seq & JITTER_BUFFER_SLOT_MASK];
+  if (slot->valid) {
+    return;  // Duplicate
+  }
+  memcpy(slot->data, data, size);
+  slot->arrival_us = arrival_us;
+  slot->size = (uint16_t)size;
+  slot->seq = seq;
+  slot->valid = true;
+  jb->count++;
+}
+
+// Hand out the next frame for playout
+// PACKET: out holds the packet for next_seq, arrival_us its arrival time
+// LOST: next_seq is missing; out holds the following packet for in-band FEC
+//       when it is buffered (size > 0), otherwise the caller runs PLC
+// EMPTY: buffering up to the target delay, nothing to play yet
+JitterBufferResult jitter_buffer_pop(JitterBuffer* jb, uint8_t* out,
+                                     size_t* size, int64_t* arrival_us) {
+  *size = 0;
+  *arrival_us = 0;
+
+  if (!jb->playing) {
+    if (jb->count < jb->target_frames) {
+      return JITTER_BUFFER_EMPTY;
+    }
+    jb->playing = true;
+  }
+
+  // Shed a frame when delay has built up well beyond the target
+  if (jb->count > jb->target_frames + 1) {
+    JitterBufferSlot* stale =
+        &jb->slots[jb->next_seq & JITTER_BUFFER_SLOT_MASK];
+    if (stale->valid && stale->seq == jb->next_seq) {
+      stale->valid = false;
+      jb->count--;
+      jb->stats.dropped++;
+    }
+    jb->next_seq++;
+  }
+
+  JitterBufferSlot* slot = &jb->slots[jb->next_seq & JITTER_BUFFER_SLOT_MASK];
+  if (slot->valid && slot->seq == jb->next_seq) {
+    memcpy(out, slot->data, slot->size);
+    *size = slot->size;
+    *arrival_us = slot->arrival_us;
+    slot->valid = false;
+    jb->count--;
+    jb->next_seq++;
+    jb->conceal_run = 0;
+    return JITTER_BUFFER_PACKET;
+  }
+
+  if (jb->count == 0) {
+    // Nothing has arrived: stretch with PLC and wait for the packet, which
+    // grows the playout delay; give up and rebuffer after too many
+    if (++jb->conceal_run > JITTER_BUFFER_MAX_CONCEAL) {
+      jb->playing = false;
+      jb->conceal_run = 0;
+      jb->stats.rebuffers++;
+      return JITTER_BUFFER_EMPTY;
+    }
+    jb->stats.concealed++;
+    return JITTER_BUFFER_LOST;
+  }
+
+  // Later packets are buffered, so this one is lost; offer the next packet
+  // so the decoder can recover it from in-band FEC
+  jb->stats.lost++;
+  jb->conceal_run++;
+  jb->next_seq++;
+  JitterBufferSlot* next = &jb->slots[jb->next_seq & JITTER_BUFFER_SLOT_MASK];
+  if (next->valid && next->seq == jb->next_seq) {
+    memcpy(out, next->data, next->size);
+    *size = next->size;
+  }
+  return JITTER_BUFFER_LOST;
+}
+
+// Snapshot of counters plus current depth and delay
+void jitter_buffer_stats(const JitterBuffer* jb, JitterBufferStats* stats) {
+  *stats = jb->stats;
+  stats->depth = jb->count;
+  stats->target_ms = jb->target_frames * JITTER_BUFFER_FRAME_MS;
+  stats->jitter_ms = (uint32_t)(jb->jitter_us_q4 / 16 / 1000);
+}
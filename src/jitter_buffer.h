@@ -0,0 +1,71 @@
+#ifndef JITTER_BUFFER_H
+#define JITTER_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Jitter buffer configuration
+#define JITTER_BUFFER_SLOTS 16         // Packets held (power of two)
+#define JITTER_BUFFER_MAX_PACKET 1276  // Largest Opus packet accepted
+#define JITTER_BUFFER_FRAME_MS 20      // Packet duration assumed for playout
+#define JITTER_BUFFER_MIN_FRAMES 2     // Lowest playout delay in frames
+#define JITTER_BUFFER_MAX_FRAMES 12    // Highest playout delay in frames
+#define JITTER_BUFFER_MAX_CONCEAL 5    // Concealed frames before rebuffering
+#define JITTER_BUFFER_RTP_CLOCK 48000  // Opus RTP timestamp rate in Hz
+
+// Outcome of asking the jitter buffer for the next frame to play
+typedef enum {
+  JITTER_BUFFER_EMPTY,   // Still buffering, play nothing
+  JITTER_BUFFER_PACKET,  // Next packet in sequence was returned
+  JITTER_BUFFER_LOST,    // Packet missing, conceal (FEC data if size > 0)
+} JitterBufferResult;
+
+typedef struct {
+  uint8_t data[JITTER_BUFFER_MAX_PACKET];
+  int64_t arrival_us;  // When the packet reached onaudiotrack
+  uint16_t size;
+  uint16_t seq;
+  bool valid;
+} JitterBufferSlot;
+
+// Counters exposed for monitoring
+typedef struct {
+  uint32_t depth;      // Packets currently buffered
+  uint32_t target_ms;  // Current playout delay target
+  uint32_t jitter_ms;  // Smoothed interarrival jitter (RFC 3550)
+  uint32_t received;   // Packets inserted
+  uint32_t late;       // Packets that arrived after their playout time
+  uint32_t lost;       // Packets never received, concealed with PLC/FEC
+  uint32_t concealed;  // Frames synthesized while the buffer was dry
+  uint32_t dropped;    // Packets discarded to shrink delay or on overflow
+  uint32_t rebuffers;  // Times playout stopped to refill to target
+} JitterBufferStats;
+
+// Sequence-ordered packet buffer between the network thread and playout
+// Not thread-safe: callers serialize insert/pop
+typedef struct {
+  JitterBufferSlot* slots;
+  uint32_t count;          // Valid slots
+  uint16_t next_seq;       // Sequence number to play next
+  uint16_t highest_seq;    // Newest sequence number seen
+  bool synced;             // next_seq initialised from the stream
+  bool playing;            // Playout running (false while buffering)
+  uint32_t target_frames;  // Playout delay target in frames
+  uint32_t conceal_run;    // Consecutive frames without a packet
+  int64_t last_arrival_us;
+  uint32_t last_timestamp;
+  bool have_transit;
+  int64_t jitter_us_q4;  // Interarrival jitter in microseconds * 16
+  JitterBufferStats stats;
+} JitterBuffer;
+
+bool jitter_buffer_init(JitterBuffer* jb);   // Allocate slots and reset
+void jitter_buffer_reset(JitterBuffer* jb);  // Drop all packets and stats
+void jitter_buffer_insert(JitterBuffer* jb, uint16_t seq, uint32_t timestamp,
+                          const uint8_t* data, size_t size,
+                          int64_t arrival_us);
+JitterBufferResult jitter_buffer_pop(JitterBuffer* jb, uint8_t* out,
+                                     size_t* size, int64_t* arrival_us);
+void jitter_buffer_stats(const JitterBuffer* jb, JitterBufferStats* stats);
+
+#endif  // JITTER_BUFFER_H
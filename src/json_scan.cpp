@@ -0,0 +1,372 @@
+#include "json_scan.h"
+
+#include <string.h>
+
+// Member name on the path from the top-level object to the current one
+typedef struct {
+  const char* name;
+  size_t length;
+} JsonSegment;
+
+typedef struct {
+  const char* p;
+  const char* end;
+  const char* const* keys;
+  JsonSlice* fields;
+  size_t count;
+  size_t found;
+  JsonSegment path[JSON_SCAN_MAX_DEPTH];
+} JsonScanner;
+
+typedef enum {
+  KEY_NONE,
+  KEY_EXACT,   // The key names this member
+  KEY_PREFIX,  // The key continues inside this member
+} KeyMatch;
+
+static void json_skip_space(JsonScanner* s) {
+  while (s->p < s->end &&
+         (*s->p == ' ' || *s->p == '\t' || *s->p == '\n' || *s->p == '\r')) {
+    s->p++;
+  }
+}
+
+// Consume a string at s->p; on return *start/*length cover its contents
+static bool json_skip_string(JsonScanner* s, const char** start,
+                             size_t* length, bool* escaped) {
+  const char* p = s->p + 1;
+  bool has_escape = false;
+  while (p < s->end && *p != '"') {
+    if (*p == '\\') {
+      has_escape = true;
+      p++;
+    }
+    p++;
+  }
+  if (p >= s->end) {
+    return false;
+  }
+  *start = s->p + 1;
+  *length = (size_t)(p - *start);
+  *escaped = has_escape;
+  s->p = p + 1;
+  return true;
+}
+
+// Consume any value, containers included, without looking inside
+static bool json_skip_value(JsonScanner* s) {
+  int depth = 0;
+  do {
+    json_skip_space(s);
+    if (s->p >= s->end) {
+      return false;
+    }
+    char c = *s->p;
+    if (c == '"') {
+      const char* start;
+      size_t length;
+      bool escaped;
+      if (!json_skip_string(s, &start, &length, &escaped)) {
+        return false;
+      }
+    } else if (c == '{' || c == '[') {
+      depth++;
+      s->p++;
+    } else if (c == '}' || c == ']') {
+      if (--depth < 0) {
+        return false;
+      }
+      s->p++;
+    } else if (c == ',' || c == ':') {
+      if (depth == 0) {
+        return false;
+      }
+      s->p++;
+    } else {
+      // Number or literal, up to the next delimiter
+      const char* start = s->p;
+      while (s->p < s->end && strchr(",:]}\" \t\r\n", *s->p) == NULL) {
+        s->p++;
+      }
+      if (s->p == start) {
+        return false;
+      }
+    }
+  } while (depth > 0);
+  return true;
+}
+
+// Compare a dotted key with the current path plus one member name
+static KeyMatch json_match_key(const JsonScanner* s, int depth, const char* key,
+                               const char* name, size_t length) {
+  for (int i = 0; i < depth; i++) {
+    const JsonSegment* segment = &s->path[i];
+    if (strncmp(key, segment->name, segment->length) != 0 ||
+        key[segment->length] != '.') {
+      return KEY_NONE;
+    }
+    key += segment->length + 1;
+  }
+  if (strncmp(key, name, length) != 0) {
+    return KEY_NONE;
+  }
+  if (key[length] == '\0') {
+    return KEY_EXACT;
+  }
+  return key[length] == '.' ? KEY_PREFIX : KEY_NONE;
+}
+
+static JsonType json_type_of(char c) {
+  switch (c) {
+    case '"':
+      return JSON_STRING;
+    case '{':
+      return JSON_OBJECT;
+    case '[':
+      return JSON_ARRAY;
+    case 't':
+      return JSON_TRUE;
+    case 'f':
+      return JSON_FALSE;
+    case 'n':
+      return JSON_NULL;
+    default:
+      return JSON_NUMBER;
+  }
+}
+
+// Scan the members of the object at s->p (which points at '{')
+static bool json_scan_object(JsonScanner* s, int depth) {
+  s->p++;
+  json_skip_space(s);
+  if (s->p < s->end && *s->p == '}') {
+    s->p++;
+    return true;
+  }
+
+  while (1) {
+    // Member name
+    json_skip_space(s);
+    const char* name;
+    size_t name_length;
+    bool escaped;
+    if (s->p >= s->end || *s->p != '"' ||
+        !json_skip_string(s, &name, &name_length, &escaped)) {
+      return false;
+    }
+    json_skip_space(s);
+    if (s->p >= s->end || *s->p != ':') {
+      return false;
+    }
+    s->p++;
+    json_skip_space(s);
+    if (s->p >= s->end) {
+      return false;
+    }
+
+    // Which requested keys this member is, or leads to
+    int exact = -1;
+    bool prefix = false;
+    for (size_t i = 0; i < s->count; i++) {
+      KeyMatch match =
+          json_match_key(s, depth, s->keys[i], name, name_length);
+      if (match == KEY_EXACT && s->fields[i].type == JSON_NONE) {
+        exact = (int)i;
+      } else if (match == KEY_PREFIX) {
+        prefix = true;
+      }
+    }
+
+    // Value
+    const char* start = s->p;
+    JsonType type = json_type_of(*s->p);
+    const char* string = NULL;
+    size_t string_length = 0;
+    bool string_escaped = false;
+    if (type == JSON_STRING) {
+      if (!json_skip_string(s, &string, &string_length, &string_escaped)) {
+        return false;
+      }
+    } else if (type == JSON_OBJECT && prefix &&
+               depth + 1 < JSON_SCAN_MAX_DEPTH) {
+      s->path[depth].name = name;
+      s->path[depth].length = name_length;
+      if (!json_scan_object(s, depth + 1)) {
+        return false;
+      }
+      if (s->found == s->count) {
+        return true;
+      }
+    } else if (!json_skip_value(s)) {
+      return false;
+    }
+
+    if (exact >= 0) {
+      JsonSlice* field = &s->fields[exact];
+      field->type = type;
+      field->data = type == JSON_STRING ? string : start;
+      field->length =
+          type == JSON_STRING ? string_length : (size_t)(s->p - start);
+      field->escaped = string_escaped;
+      // The same key may be listed twice
+      for (size_t i = 0; i < s->count; i++) {
+        if (s->fields[i].type == JSON_NONE &&
+            strcmp(s->keys[i], s->keys[exact]) == 0) {
+          s->fields[i] = *field;
+          s->found++;
+        }
+      }
+      if (++s->found == s->count) {
+        return true;  // Nothing left to look for
+      }
+    }
+
+    json_skip_space(s);
+    if (s->p >= s->end) {
+      return false;
+    }
+    if (*s->p == '}') {
+      s->p++;
+      return true;
+    }
+    if (*s->p != ',') {
+      return false;
+    }
+    s->p++;
+  }
+}
+
+int json_scan(const char* json, size_t length, const char* const* keys,
+              JsonSlice* fields, size_t count) {
+  JsonScanner s;
+  s.p = json;
+  s.end = json + length;
+  s.keys = keys;
+  s.fields = fields;
+  s.count = count;
+  s.found = 0;
+  for (size_t i = 0; i < count; i++) {
+    // Missing fields stay printable with %.*s
+    fields[i].data = "";
+    fields[i].length = 0;
+    fields[i].type = JSON_NONE;
+    fields[i].escaped = false;
+  }
+
+  json_skip_space(&s);
+  if (s.p >= s.end || *s.p != '{' || !json_scan_object(&s, 0)) {
+    return -1;
+  }
+  return (int)s.found;
+}
+
+bool json_equals(const JsonSlice* field, const char* text) {
+  return field->type != JSON_NONE && strlen(text) == field->length &&
+         memcmp(field->data, text, field->length) == 0;
+}
+
+static int json_hex(const char* p) {
+  int value = 0;
+  for (int i = 0; i < 4; i++) {
+    char c = p[i];
+    value <<= 4;
+    if (c >= '0' && c <= '9') {
+      value |= c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      value |= c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      value |= c - 'A' + 10;
+    } else {
+      return -1;
+    }
+  }
+  return value;
+}
+
+// Append one code point as UTF-8 if it fits
+static size_t json_put_utf8(uint32_t code, char* out, size_t pos,
+                            size_t size) {
+  char bytes[4];
+  size_t count;
+  if (code < 0x80) {
+    bytes[0] = (char)code;
+    count = 1;
+  } else if (code < 0x800) {
+    bytes[0] = (char)(0xc0 | (code >> 6));
+    bytes[1] = (char)(0x80 | (code & 0x3f));
+    count = 2;
+  } else if (code < 0x10000) {
+    bytes[0] = (char)(0xe0 | (code >> 12));
+    bytes[1] = (char)(0x80 | ((code >> 6) & 0x3f));
+    bytes[2] = (char)(0x80 | (code & 0x3f));
+    count = 3;
+  } else {
+    bytes[0] = (char)(0xf0 | (code >> 18));
+    bytes[1] = (char)(0x80 | ((code >> 12) & 0x3f));
+    bytes[2] = (char)(0x80 | ((code >> 6) & 0x3f));
+    bytes[3] = (char)(0x80 | (code & 0x3f));
+    count = 4;
+  }
+  if (pos + count >= size) {
+    return pos;
+  }
+  memcpy(out + pos, bytes, count);
+  return pos + count;
+}
+
+size_t json_unescape(const JsonSlice* field, char* out, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  const char* p = field->data;
+  const char* end = field->data + field->length;
+  size_t pos = 0;
+  while (p < end && pos + 1 < size) {
+    if (*p != '\\' || p + 1 >= end) {
+      out[pos++] = *p++;
+      continue;
+    }
+    char c = p[1];
+    p += 2;
+    switch (c) {
+      case 'n':
+        out[pos++] = '\n';
+        break;
+      case 't':
+        out[pos++] = '\t';
+        break;
+      case 'r':
+        out[pos++] = '\r';
+        break;
+      case 'b':
+        out[pos++] = '\b';
+        break;
+      case 'f':
+        out[pos++] = '\f';
+        break;
+      case 'u': {
+        int code = end - p >= 4 ? json_hex(p) : -1;
+        if (code < 0) {
+          break;
+        }
+        p += 4;
+        // Surrogate pair for code points above the BMP
+        if (code >= 0xd800 && code < 0xdc00 && end - p >= 6 && p[0] == '\\' &&
+            p[1] == 'u') {
+          int low = json_hex(p + 2);
+          if (low >= 0xdc00 && low < 0xe000) {
+            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            p += 6;
+          }
+        }
+        pos = json_put_utf8((uint32_t)code, out, pos, size);
+        break;
+      }
+      default:
+        out[pos++] = c;  // \" \\ \/
+        break;
+    }
+  }
+  out[pos] = '\0';
+  return pos;
+}
@@ -0,0 +1,47 @@
+#ifndef JSON_SCAN_H
+#define JSON_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Single-pass JSON field extractor for data-channel events. Instead of
+// building a tree it walks the text once, looks only for the requested
+// members (dotted paths like "response.status" reach into nested objects)
+// and returns slices pointing into the caller's buffer: nothing is copied
+// or allocated. Everything else is skipped without validation, and the scan
+// stops as soon as every requested field has been seen
+#define JSON_SCAN_MAX_DEPTH 8  // Deepest object a dotted path can reach
+
+typedef enum {
+  JSON_NONE,  // Field not present
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_OBJECT,
+  JSON_ARRAY,
+  JSON_TRUE,
+  JSON_FALSE,
+  JSON_NULL,
+} JsonType;
+
+// A value inside the scanned buffer; strings exclude their quotes
+typedef struct {
+  const char* data;
+  size_t length;
+  JsonType type;
+  bool escaped;  // String holds escape sequences, see json_unescape
+} JsonSlice;
+
+// Fill fields[i] with the value at keys[i] for a JSON object in json; a
+// missing field is JSON_NONE with data "" and length 0
+// Returns the number of fields found, or -1 for malformed input
+int json_scan(const char* json, size_t length, const char* const* keys,
+              JsonSlice* fields, size_t count);
+
+// True when a field equals text exactly (compared without unescaping)
+bool json_equals(const JsonSlice* field, const char* text);
+
+// Decode a string field into out as UTF-8, NUL-terminated and truncated to
+// size - 1 bytes; returns the length written
+size_t json_unescape(const JsonSlice* field, char* out, size_t size);
+
+#endif  // JSON_SCAN_H
@@ -0,0 +1,216 @@
+#include "kws.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "mem.h"
+
+#define KWS_POWER_SHIFT 8  // Bin values dropped to 21 bits before squaring
+#define KWS_FLOOR (-512)   // Lowest band level kept, Q8 log2 (about -80dBFS)
+
+static inline int8_t saturate8(int32_t v) {
+  if (v > 127) {
+    return 127;
+  }
+  if (v < -127) {
+    return -127;
+  }
+  return (int8_t)v;
+}
+
+static double kws_mel(double hz) {
+  return 2595 * log10(1 + hz / 700);
+}
+
+static double kws_hz(double mel) {
+  return 700 * (pow(10, mel / 2595) - 1);
+}
+
+bool kws_init(Kws* kws, const KwsModel* model, uint32_t sample_rate,
+              size_t block_samples) {
+  memset(kws, 0, sizeof(*kws));
+  kws->model = model;
+  kws->block = block_samples;
+  kws->length = block_samples + block_samples / 2;
+  size_t size = 2;
+  while (size < kws->length) {
+    size <<= 1;
+  }
+  if (!fft_init(&kws->fft, size)) {
+    return false;
+  }
+
+  size_t half = kws->block / 2;
+  kws->window =
+      (int16_t*)mem_alloc(MEM_INTERNAL, kws->length * sizeof(int16_t));
+  kws->history = (int16_t*)mem_alloc(MEM_INTERNAL, half * sizeof(int16_t));
+  kws->spectrum =
+      (FftComplex*)mem_alloc(MEM_INTERNAL, size * sizeof(FftComplex));
+  kws->band = (uint8_t*)mem_alloc(MEM_INTERNAL, size / 2 * sizeof(uint8_t));
+  kws->weight = (int16_t*)mem_alloc(MEM_INTERNAL, size / 2 * sizeof(int16_t));
+  if (kws->window == NULL || kws->history == NULL || kws->spectrum == NULL ||
+      kws->band == NULL || kws->weight == NULL) {
+    return false;
+  }
+
+  for (size_t n = 0; n < kws->length; n++) {
+    double w = 0.5 - 0.5 * cos(2 * M_PI * (n + 0.5) / kws->length);
+    kws->window[n] = (int16_t)fmin(32767.0, lrint(w * 32768));
+  }
+
+  // Band edges evenly spaced in mel; band b rises from edge b to its peak
+  // at edge b + 1 and falls to edge b + 2
+  double high = fmin(KWS_HIGH_HZ, sample_rate * 0.475);
+  double low_mel = kws_mel(KWS_LOW_HZ);
+  double step = (kws_mel(high) - low_mel) / (KWS_BANDS + 1);
+  double edges[KWS_BANDS + 2];
+  for (int i = 0; i < KWS_BANDS + 2; i++) {
+    edges[i] = kws_hz(low_mel + step * i);
+  }
+  double bin_hz = (double)sample_rate / size;
+  kws->first_bin = (size_t)ceil(edges[0] / bin_hz);
+  kws->last_bin = kws->first_bin;
+  int edge = 0;
+  for (size_t k = kws->first_bin; k < size / 2; k++) {
+    double hz = k * bin_hz;
+    while (edge < KWS_BANDS + 1 && hz >= edges[edge + 1]) {
+      edge++;
+    }
+    if (edge == KWS_BANDS + 1) {
+      break;
+    }
+    double rise = (hz - edges[edge]) / (edges[edge + 1] - edges[edge]);
+    kws->band[k] = (uint8_t)edge;
+    kws->weight[k] = (int16_t)fmin(32767.0, lrint(rise * 32768));
+    kws->last_bin = k + 1;
+  }
+  kws_reset(kws);
+  return true;
+}
+
+void kws_reset(Kws* kws) {
+  memset(kws->history, 0, kws->block / 2 * sizeof(int16_t));
+  kws->next = 0;
+  kws->steps = 0;
+  kws->score = 0;
+  kws->above = 0;
+  kws->refractory = 0;
+}
+
+// log2(v) in Q8; the mantissa's linear fraction f is bent by
+// 0.344 f (1 - f) to within 0.01 of the true logarithm
+static int32_t kws_log2(uint64_t v) {
+  if (v == 0) {
+    return 0;
+  }
+  int bits = 63 - __builtin_clzll(v);
+  uint32_t fraction = (uint32_t)((v << (63 - bits)) >> 55) & 0xff;
+  fraction += (fraction * (256 - fraction) * 88) >> 16;
+  return bits * 256 + (int32_t)fraction;
+}
+
+bool kws_push(Kws* kws, const int16_t* pcm) {
+  size_t size = kws->fft.size;
+  size_t half = kws->block / 2;
+  FftComplex* x = kws->spectrum;
+
+  int32_t peak = 0;
+  for (size_t n = 0; n < kws->length; n++) {
+    int32_t sample = n < half ? kws->history[n] : pcm[n - half];
+    x[n].re = (sample * kws->window[n]) >> 15;
+    x[n].im = 0;
+    int32_t magnitude = x[n].re < 0 ? -x[n].re : x[n].re;
+    peak = magnitude > peak ? magnitude : peak;
+  }
+  memset(x + kws->length, 0, (size - kws->length) * sizeof(FftComplex));
+  memcpy(kws->history, pcm + kws->block - half, half * sizeof(int16_t));
+
+  int shift = FFT_INPUT_BITS - fft_bits((uint32_t)peak);
+  if (peak == 0) {
+    shift = FFT_INPUT_BITS - 1;
+  }
+  for (size_t n = 0; n < kws->length; n++) {
+    x[n].re *= 1 << shift;
+  }
+  fft_forward(&kws->fft, x);
+
+  uint64_t energy[KWS_BANDS + 1] = {};
+  for (size_t k = kws->first_bin; k < kws->last_bin; k++) {
+    int64_t re = x[k].re >> KWS_POWER_SHIFT;
+    int64_t im = x[k].im >> KWS_POWER_SHIFT;
+    uint64_t power = (uint64_t)(re * re + im * im);
+    uint64_t rise = (power * (uint64_t)kws->weight[k]) >> 15;
+    energy[kws->band[k]] += rise;
+    if (kws->band[k] > 0) {
+      energy[kws->band[k] - 1] += power - rise;
+    }
+  }
+
+  // Undo the normalization: power scales by 2^(2 * (POWER_SHIFT - shift))
+  int16_t* features = kws->features[kws->next];
+  int32_t offset = 2 * (KWS_POWER_SHIFT - shift) * 256;
+  for (int b = 0; b < KWS_BANDS; b++) {
+    int32_t level = kws_log2(energy[b] + 1) + offset;
+    features[b] = (int16_t)(level > KWS_FLOOR ? level : KWS_FLOOR);
+  }
+  kws->next = (kws->next + 1) % KWS_STEPS;
+  if (kws->steps < KWS_STEPS) {
+    kws->steps++;
+  }
+  return kws->steps == KWS_STEPS;
+}
+
+void kws_input(const Kws* kws, int8_t* input) {
+  int32_t sum = 0;
+  for (int s = 0; s < KWS_STEPS; s++) {
+    for (int b = 0; b < KWS_BANDS; b++) {
+      sum += kws->features[s][b];
+    }
+  }
+  int32_t mean = sum / KWS_INPUTS;
+  for (int s = 0; s < KWS_STEPS; s++) {
+    const int16_t* features = kws->features[(kws->next + s) % KWS_STEPS];
+    for (int b = 0; b < KWS_BANDS; b++) {
+      input[s * KWS_BANDS + b] =
+          saturate8((features[b] - mean) >> KWS_INPUT_SHIFT);
+    }
+  }
+}
+
+int32_t kws_score(const KwsModel* model, const int8_t* input) {
+  int32_t output = model->output_bias;
+  for (int h = 0; h < KWS_HIDDEN; h++) {
+    const int8_t* weights = model->hidden_weights[h];
+    int32_t sum = model->hidden_bias[h];
+    for (int i = 0; i < KWS_INPUTS; i++) {
+      sum += weights[i] * input[i];
+    }
+    int64_t activation = ((int64_t)sum * model->hidden_scale) >> 16;
+    activation = activation > 0 ? activation : 0;
+    activation = activation < 127 ? activation : 127;
+    output += model->output_weights[h] * (int32_t)activation;
+  }
+  return output;
+}
+
+bool kws_process(Kws* kws, const int16_t* pcm) {
+  if (!kws_push(kws, pcm)) {
+    return false;
+  }
+  int8_t input[KWS_INPUTS];
+  kws_input(kws, input);
+  kws->score = kws_score(kws->model, input);
+  if (kws->refractory > 0) {
+    kws->refractory--;
+    kws->above = 0;
+    return false;
+  }
+  kws->above = kws->score >= kws->model->threshold ? kws->above + 1 : 0;
+  if (kws->above < KWS_TRIGGER) {
+    return false;
+  }
+  kws->above = 0;
+  kws->refractory = KWS_REFRACTORY;
+  kws->detections++;
+  return true;
+}
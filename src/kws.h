@@ -0,0 +1,90 @@
+#ifndef KWS_H
+#define KWS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fft.h"
+
+// Keyword spotter for the wake-word gate
+// Features: every block (20ms) is windowed together with the second half
+// of the previous one (Hann, 30ms), transformed and pooled into triangular
+// log-mel bands (log2 energy, Q8). The network sees the last KWS_STEPS
+// blocks with the window's mean level removed, quantized to int8 steps of
+// 1/8 log2 (0.75dB): one fully connected ReLU layer and a single output
+// whose accumulator is compared with the model's threshold. Weights are
+// int8 with int32 biases; models are trained and exported as kws_model.cpp
+// by the host benchmark (bench_kws.cpp)
+#define KWS_BANDS 12                        // Log-mel bands
+#define KWS_STEPS 32                        // Blocks per window (640ms)
+#define KWS_INPUTS (KWS_BANDS * KWS_STEPS)  // Network inputs
+#define KWS_HIDDEN 16                       // Hidden units
+#define KWS_LOW_HZ 150                      // Lowest band edge
+#define KWS_HIGH_HZ 3800                    // Highest band edge
+#define KWS_INPUT_SHIFT 5                   // Q8 log2 to 1/8 log2 inputs
+#define KWS_TRIGGER 2                       // Blocks over the threshold to fire
+#define KWS_REFRACTORY 50                   // Blocks ignored after firing (1s)
+
+typedef struct {
+  const char* keyword;  // What the model was trained to spot
+  int8_t hidden_weights[KWS_HIDDEN][KWS_INPUTS];
+  int32_t hidden_bias[KWS_HIDDEN];  // Accumulator units
+  int32_t hidden_scale;             // Q16, accumulator to int8 activation
+  int8_t output_weights[KWS_HIDDEN];
+  int32_t output_bias;
+  int32_t threshold;  // Output accumulator that counts as the keyword
+} KwsModel;
+
+extern const KwsModel kws_model;  // kws_model.cpp
+
+typedef struct {
+  const KwsModel* model;
+  Fft fft;
+  size_t block;   // Samples per block
+  size_t length;  // Samples per analysis window, 1.5 blocks
+
+  int16_t* window;       // Q15 Hann, length samples
+  int16_t* history;      // Second half of the previous block
+  FftComplex* spectrum;  // fft.size points
+
+  // Mel filterbank: bin k in [first_bin, last_bin) adds weight[k] (Q15)
+  // of its power to band[k] and the rest to band[k] - 1
+  uint8_t* band;
+  int16_t* weight;
+  size_t first_bin;
+  size_t last_bin;
+
+  int16_t features[KWS_STEPS][KWS_BANDS];  // Q8 log2 energies, ring
+  size_t next;                             // Oldest step in the ring
+  size_t steps;                            // Steps held, up to KWS_STEPS
+
+  int32_t score;        // Output accumulator of the last full window
+  uint32_t above;       // Consecutive blocks over the threshold
+  uint32_t refractory;  // Blocks left before the next detection
+  uint32_t detections;
+} Kws;
+
+// Build the FFT, window and filterbank in internal SRAM for blocks of
+// block_samples at sample_rate. False when memory runs out or the window
+// needs an FFT larger than FFT_MAX_SIZE
+bool kws_init(Kws* kws, const KwsModel* model, uint32_t sample_rate,
+              size_t block_samples);
+
+// Forget collected features and the trigger state
+void kws_reset(Kws* kws);
+
+// Add one block's features; true once a full window is held
+bool kws_push(Kws* kws, const int16_t* pcm);
+
+// Network input of the current window, KWS_INPUTS values oldest step first
+void kws_input(const Kws* kws, int8_t* input);
+
+// Output accumulator of model for one input window
+int32_t kws_score(const KwsModel* model, const int8_t* input);
+
+// Push one block and score the window; true on the block where the
+// keyword is detected (KWS_TRIGGER blocks over the threshold, then quiet
+// for KWS_REFRACTORY blocks)
+bool kws_process(Kws* kws, const int16_t* pcm);
+
+#endif  // KWS_H
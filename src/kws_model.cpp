@@ -0,0 +1,677 @@
+#include "kws.h"
+
+// Wake-word network written by the host benchmark (bench_kws.cpp
+// with KWS_MODEL_OUT). Trained on 500 keyword and 500 other clips;
+// held out: 11.0% false rejects, 7.0 false accepts per hour
+const KwsModel kws_model = {
+    "synthetic",
+    {
+        {
+            2, 15, 25, -9, 3, 2, 0, -14, -14, -6,
+            -15, -24, -25, 8, 27, -4, -11, 22, -4, -23,
+            -15, 1, 2, -1, 13, 19, 7, -12, 8, -6,
+            -21, -30, -31, -15, -7, -4, 34, 60, 28, -18,
+            -12, -10, -1, -35, -25, 0, 7, -3, 42, 56,
+            37, -11, -29, -15, -32, -36, -49, -15, -4, -15,
+            81, 86, 47, 10, -9, -15, -8, -57, -46, -19,
+            0, -12, 72, 76, 44, 1, -28, -26, -23, -49,
+            -63, -38, -14, -20, 73, 70, 41, 18, -5, 7,
+            5, -35, -55, -42, -15, -13, 61, 65, 45, 16,
+            -59, -39, -33, -12, -69, -46, -21, -15, 64, 65,
+            44, 14, 13, 5, 11, -15, -83, -51, -9, -6,
+            75, 57, 53, 23, 2, -19, -2, -1, -60, -24,
+            20, 27, 54, 31, 44, 26, 19, 25, 21, 14,
+            -22, -8, 21, 41, 54, 24, 28, 20, 27, -5,
+            -1, 13, -21, 11, 40, 60, 29, 26, 19, -4,
+            2, 9, 24, -11, -10, 18, 30, 53, 37, 24,
+            17, 17, -5, -8, -4, -23, -5, 26, 45, 67,
+            7, 28, 4, -27, 6, -7, -9, -22, 19, 22,
+            25, 42, -7, -3, 6, -34, 14, -18, -21, -33,
+            -33, 31, 37, 62, -18, -6, -4, -15, 4, -21,
+            -15, -44, -27, 40, 10, 57, 0, -6, 45, 5,
+            13, -1, -52, -65, -37, 47, 31, 63, 1, -12,
+            -13, 4, -15, -27, -19, -52, -16, 43, 25, 49,
+            1, -1, 0, -12, -17, -27, -18, -22, -11, 29,
+            6, 44, -19, 9, -10, -6, -17, -15, -37, -13,
+            4, 47, 35, 64, -19, 3, -3, 1, -18, -5,
+            -2, 21, 9, 47, 28, 35, -19, -16, -35, -36,
+            -42, -16, 26, 14, 18, 31, 21, 30, -30, -23,
+            -44, -49, -63, -44, 25, 11, 4, -7, 2, 1,
+            -18, -15, -32, -46, -48, -32, 44, 29, 7, -1,
+            -8, -12, -19, -16, -19, -32, -42, -18, 44, 33,
+            27, 1, -16, -12, -23, -25, -13, -37, -54, -12,
+            60, 24, 20, 3, 6, -12, -43, -38, -30, -48,
+            -57, -8, 40, 22, 20, 2, -7, -4, -1, -10,
+            -6, -12, -32, 3, 8, 15, 16, -4, -11, -4,
+            -19, -9, -7, -15, -30, -24, 5, 2, 16, 3,
+            -15, -7, -20, -13, -2, -17, -33, -18, 17, 8,
+            -5, -8, -6, -20,
+        },
+        {
+            33, 27, 13, 11, 4, 8, 0, -18, -17, 5,
+            4, 9, 5, 7, 11, 4, 13, 13, 15, 8,
+            15, 20, 16, 7, 6, 15, -5, -8, -8, 24,
+            20, 14, 4, 13, -1, 10, 26, 34, -10, 9,
+            38, 17, 8, 32, 6, 7, 19, 7, 0, -32,
+            -45, 19, 27, 18, 10, 27, 5, 11, 11, 31,
+            6, -15, -67, -50, 46, -2, 18, 2, 11, 24,
+            23, 17, -30, -54, -46, -31, 8, -18, 5, 8,
+            -7, -19, 10, 20, 1, -13, -61, -51, -12, 4,
+            15, 14, -21, -2, 12, 16, 4, -31, -18, 34,
+            50, 11, 19, 27, -10, -8, -3, 26, 6, -15,
+            -42, 13, 48, 44, 23, 30, 18, 18, 20, 21,
+            -5, -20, -44, -5, 31, 29, 42, 6, -26, -12,
+            -34, -4, -7, -25, -21, -3, 42, 48, 34, -7,
+            -71, -48, -36, -28, 15, -22, -5, 12, 23, 37,
+            29, -4, -91, -61, -51, -36, 6, -28, 4, 21,
+            23, 17, 31, -14, -94, -76, -49, -44, 31, 3,
+            20, 26, 30, 16, 71, 2, -100, -88, -65, -52,
+            30, 9, 15, 51, 52, 47, 19, 24, -18, -37,
+            -65, -38, 57, 30, 37, 46, 47, 25, 36, 23,
+            -9, -8, -39, -32, 48, 37, 20, 36, 22, 22,
+            9, 18, 20, -24, -50, -32, 8, 13, 35, 8,
+            14, -7, 20, 4, -9, -27, -57, -36, 27, 18,
+            33, 25, 22, 13, 19, 12, 2, -31, -58, -45,
+            43, 26, 12, 34, 8, 32, 21, -8, -43, -32,
+            -47, -38, 11, 21, 12, 3, 20, -1, 8, -16,
+            -44, -28, -42, -29, 17, 4, 21, 27, 38, 32,
+            4, 11, -25, -16, -34, -38, 33, 23, 24, 32,
+            25, 20, 28, 14, 24, -11, -10, -19, 21, 7,
+            18, 31, 18, 56, 20, 11, 13, 8, 13, 2,
+            -7, -13, -2, -3, 6, 34, 49, 26, 18, 12,
+            -6, 3, -2, -13, 0, -8, -4, 27, -20, 1,
+            12, 12, -1, 9, 0, -6, -13, -11, 0, 37,
+            5, 25, 23, 3, 7, 2, -8, -22, -13, -11,
+            -9, 11, 22, 29, 13, 4, -9, -18, 12, 13,
+            13, 24, 46, 31, 25, -3, -3, -4, -1, -14,
+            22, 20, 19, 21, 4, -27, 6, -3, -8, -8,
+            -4, -6, -14, 3, 12, 2, 0, -42, -2, -13,
+            6, 15, 20, 7,
+        },
+        {
+            3, 2, 12, 13, 5, 18, 2, 11, 8, 9,
+            8, 1, 0, 11, 0, 12, 6, 21, 19, 3,
+            -1, 5, -4, -4, -4, -1, 8, 0, 8, 17,
+            19, 9, 9, -6, 4, 6, -1, -5, 3, -2,
+            5, 14, 2, 5, 6, 4, -7, -4, -4, -6,
+            8, -1, 11, 2, 11, 10, -6, 7, -6, -6,
+            6, -3, 8, 7, -1, 13, 8, 3, -6, 3,
+            -4, 7, 3, -2, -5, 8, 5, 3, 16, 4,
+            -1, 8, 13, 8, 7, -4, 1, 8, 1, 6,
+            11, 3, -1, 1, 2, 3, -4, -1, -1, 0,
+            12, 9, 18, 5, 9, -2, 6, 11, -5, -2,
+            -9, 6, 5, 17, 21, 19, 8, 7, -5, 0,
+            -4, -1, -8, 4, 11, 18, 18, 9, 6, 7,
+            -7, 0, 2, 1, -10, 6, 0, 20, 10, 4,
+            5, 0, -3, 5, 2, 3, -7, 5, 8, 6,
+            16, 14, -3, 1, 0, 1, -3, 0, -8, 5,
+            3, 12, 13, 8, -1, 0, -5, -1, 5, -4,
+            -1, -1, 3, 16, 19, 6, -2, -5, 8, 3,
+            -5, -9, -3, 18, 21, 21, 26, 20, 5, 4,
+            13, 3, 6, 5, 4, 9, 14, 20, 11, 11,
+            0, 2, 4, -3, 1, 0, 12, 9, 20, 13,
+            22, 7, 9, 17, 14, 7, -3, 7, -2, 12,
+            6, 5, 15, 6, 11, 9, 3, -5, -9, -4,
+            -9, 3, 13, 2, 3, 14, 3, -5, 6, 2,
+            -9, -3, -12, 6, 9, 10, -1, 7, 1, 1,
+            -4, -5, -13, -4, 4, -10, -6, -3, 14, 3,
+            -1, -1, 1, -3, -10, 2, 2, -10, -4, 9,
+            -1, 15, 9, 13, 2, 5, -1, -10, -5, -3,
+            -8, 3, 15, 4, 5, 7, -4, 3, -15, -9,
+            -12, -9, -10, -9, 1, 0, 4, 8, 8, 0,
+            -12, -14, -11, -5, -1, -1, -2, 7, 0, 2,
+            -1, 1, -4, 1, -11, -1, 0, 0, 6, 16,
+            0, 8, -6, 7, -16, -9, -2, 0, -6, 5,
+            1, 9, 10, 12, 2, -9, -2, -12, -8, 3,
+            -7, 6, 8, 14, 12, 6, -2, 6, -6, -13,
+            -6, 3, 5, 4, 13, 12, 3, -2, 11, 7,
+            -12, 5, -3, -6, 4, 9, 16, 21, 19, -1,
+            10, -3, -6, -7, -9, -1, -1, 13, 6, 21,
+            16, 4, 5, 14,
+        },
+        {
+            -32, -3, -8, 6, -9, 6, 13, 26, 32, 13,
+            8, 13, -25, 4, -2, 24, -3, -8, 1, 27,
+            19, 4, 8, 8, -3, 9, 28, 21, -3, 3,
+            3, 24, 39, 12, 7, 0, -28, -17, 13, 19,
+            -8, -11, -5, 15, 21, 4, 2, -2, -19, -10,
+            21, 9, -1, -7, 8, 7, 38, 19, 12, 0,
+            -43, -18, 0, 14, -21, 5, -8, 4, 20, 11,
+            0, 1, -9, 9, 14, 8, -14, 12, 4, 9,
+            29, 12, 1, 7, -36, -13, 4, 14, -21, 2,
+            -11, 3, 19, 24, 4, 4, -35, 8, 9, -12,
+            -10, 18, 16, 19, 31, 16, 16, -5, -15, 1,
+            18, 1, -18, -10, -6, 3, 14, 25, -3, -14,
+            -18, 6, 13, 20, 6, 11, 10, 15, 33, 9,
+            9, 4, -10, 5, 12, 8, -8, -7, -4, 13,
+            29, -5, -3, -20, -7, 7, 11, -9, -6, -2,
+            5, 5, 20, 0, 0, -18, -1, 18, -4, 12,
+            -9, -11, -6, -2, 13, -9, -6, -20, -19, 0,
+            -13, -12, -13, 4, -28, 5, 12, -13, -5, -14,
+            5, 7, 1, -9, -19, 2, 11, 12, 4, -26,
+            10, -16, -25, -10, 3, 10, -9, 13, 16, 12,
+            11, -5, 16, -3, -12, -4, 2, 10, 11, 19,
+            5, 5, 4, -15, 18, -2, -18, -10, -23, 1,
+            12, 16, 15, 24, 7, -21, 12, -7, -3, -1,
+            -7, -1, 10, 12, 0, 1, -6, -22, 19, 4,
+            -13, -9, -3, -1, 14, 8, 6, 14, 0, -7,
+            26, 5, 5, 0, -4, -8, 2, -10, 14, 21,
+            14, 2, 11, 18, -2, -11, -5, -6, 2, -12,
+            0, 15, 7, 0, 13, 3, -1, -12, -9, -4,
+            2, -25, -27, 14, 1, 1, -1, 7, -9, -13,
+            -1, 3, -11, -13, -19, -3, 9, 11, 8, 14,
+            -10, -15, 3, 2, -9, -11, -38, -3, 0, 13,
+            17, 18, -19, -19, -4, -4, -9, -4, -38, 8,
+            5, -5, 15, 12, -1, -7, -7, 2, -2, -17,
+            -28, -7, 1, 14, 17, 16, 4, 12, 10, 6,
+            9, 13, -15, -9, 1, 6, 11, 23, -16, -6,
+            -9, -2, -12, 8, -19, -8, 5, 15, 7, 24,
+            -13, -4, -3, 4, 5, 20, 0, 7, 23, 12,
+            3, 16, -9, 2, 5, 5, 14, 19, 9, 25,
+            20, 15, 8, 6,
+        },
+        {
+            -34, -32, -26, -2, -5, 3, -7, -7, -12, -15,
+            4, -15, -1, 3, -33, -24, -16, -28, -13, 6,
+            -15, -28, -7, -18, 27, -2, -6, -4, -13, -9,
+            -9, 8, -4, -1, 10, -11, -16, -17, -37, -29,
+            -25, -15, -1, -6, -21, -1, 3, -16, 7, 14,
+            -3, -7, 10, 12, 5, -2, 2, -2, 15, 4,
+            -13, -21, -38, -20, -17, 37, 8, -1, -9, -13,
+            11, 13, 37, 37, -12, 5, 22, 59, 56, 23,
+            4, 26, 29, 17, -22, -41, -6, 25, 34, 27,
+            32, 29, -21, -3, 15, 17, -67, -36, -45, -24,
+            11, 37, 53, 28, 5, -14, 17, 0, -52, -28,
+            -12, 14, -41, 16, 39, 26, -3, -8, 7, 12,
+            -8, -10, 28, 52, 60, 38, 38, 38, 38, -7,
+            7, 2, 1, 10, 48, 42, 45, 8, 26, 25,
+            60, 5, -10, -30, 7, 7, 41, 39, -11, 15,
+            36, 39, 58, 30, -4, -15, 2, 24, 26, 21,
+            -9, 1, -37, 9, 77, 44, 1, -19, 18, 31,
+            6, -2, -38, -27, -103, 13, 46, 66, 9, 5,
+            15, 25, 18, -8, -53, -51, -45, 4, 74, 55,
+            30, -16, 13, 34, 43, -27, -30, 10, -28, -17,
+            13, 15, -10, -44, -8, 26, 47, 12, 16, 0,
+            -2, 6, 17, -21, -23, -53, -11, 1, -29, -4,
+            5, 5, -12, 13, 21, -83, -64, -107, 14, -30,
+            -50, -10, 9, 30, 25, 28, -22, -41, 18, -5,
+            -18, 7, 15, 22, 28, 8, 36, 76, 42, 13,
+            57, 23, 65, -27, -56, -13, -16, 29, 55, 119,
+            44, -6, 57, 22, 30, -30, -65, -39, -29, -35,
+            10, 41, 25, -33, 29, 10, -36, -28, -17, -20,
+            -10, -24, 9, 10, 5, -9, 3, 3, 6, 17,
+            5, 12, 13, 19, 5, 8, 16, 28, 1, -7,
+            24, 23, 16, 35, 29, 13, -8, -18, 4, 20,
+            7, 31, 8, 8, 1, 7, 2, -4, -20, -1,
+            6, 5, 20, 10, -5, -3, 2, -2, 6, -10,
+            -6, -36, -4, 12, 6, 31, 2, 9, 4, 5,
+            12, 14, -14, -7, 5, 4, 8, 11, 6, 8,
+            4, 18, 18, 18, 0, -22, -4, 8, 17, 24,
+            24, 16, 8, 15, 16, 10, -31, -16, 2, 13,
+            10, 7, 9, 11, 9, 5, 1, -15, -54, 6,
+            -5, 22, 10, 23,
+        },
+        {
+            -44, -4, 17, 25, -36, -23, -4, 31, 63, 2,
+            -10, -8, -19, -7, 23, 66, 22, -29, -21, 13,
+            52, 9, -3, -6, -48, 13, 62, 61, -2, -45,
+            -18, 7, 62, 27, -4, 2, -13, -7, 60, 65,
+            6, 1, -12, 23, 51, 17, -11, -6, -49, -1,
+            45, 42, -13, -48, -37, -17, 65, 27, -19, -3,
+            -37, -13, 58, 53, -41, -8, -51, -25, 48, 24,
+            1, 2, -40, 3, 31, 13, -69, -56, -32, -35,
+            47, 25, -11, -4, -49, 3, 40, 2, -87, -54,
+            -60, -17, 29, 27, -16, -5, -21, 18, 28, -15,
+            -52, 12, -11, -16, 29, 24, -5, -10, -14, 25,
+            32, 3, -29, -16, -20, -3, 2, 28, 0, -28,
+            -21, 18, 17, -36, -52, 3, -14, -8, 42, 18,
+            22, -17, -1, 30, 19, -49, -59, -31, -27, -13,
+            9, -20, 8, -26, -38, 35, 3, -66, -53, 3,
+            -1, -4, 3, -33, -6, -26, -6, 35, 8, -33,
+            -36, -25, -16, 6, -16, -58, 11, -18, -52, 9,
+            -31, -47, -8, 12, -9, -5, -1, -56, 9, -38,
+            -16, 24, 33, -11, -37, -8, 19, 13, -30, -74,
+            20, -9, -34, -29, -37, 3, 3, 11, 36, 22,
+            32, -46, 48, -3, -16, 7, -5, 15, 26, 19,
+            23, 25, 12, -34, 58, 0, 0, 3, 2, 33,
+            12, 18, 42, 23, 16, -12, 72, 24, 11, 5,
+            1, 10, 15, 3, -14, 10, 11, -29, 23, 4,
+            1, 11, -2, 22, 10, 7, 8, -11, -4, -24,
+            -9, -19, 23, 21, 32, 21, 16, -9, -13, -10,
+            4, -9, -36, -36, 15, 12, 32, 28, 31, 2,
+            -17, -17, -14, -16, -25, -13, 20, 7, 26, 33,
+            26, -10, -50, -8, -5, 6, -15, -3, 16, 5,
+            18, 19, 9, -28, -49, -1, -1, 3, -5, 16,
+            -5, 0, 0, -4, -10, -42, -40, -13, -3, -11,
+            6, 6, -8, 4, -4, 1, -6, -23, -47, -4,
+            -21, -16, 10, 10, 11, -2, 19, 13, -4, -21,
+            -63, -19, -35, -9, 4, 9, 36, 29, 28, 26,
+            26, -6, -47, -16, -13, -12, 2, 13, -12, -3,
+            -7, -9, -35, -27, -58, -28, -10, 11, -2, 6,
+            -14, -5, 6, -4, 9, 10, -18, 6, -3, 17,
+            -2, -2, -8, 2, 2, 2, -5, 12, -6, 4,
+            10, 11, -11, -1,
+        },
+        {
+            81, 34, 10, 2, 20, -3, 3, -17, -21, 4,
+            -3, 7, 35, 0, 13, -1, 12, -20, -16, -6,
+            -1, -1, 6, 15, 10, -8, -47, -26, -7, -1,
+            -3, -8, -7, 2, 4, 19, 4, 14, -35, -45,
+            -11, -3, -11, 11, 7, 40, 25, 34, 5, -39,
+            -74, -63, -34, 3, 1, -2, -5, 4, 21, 35,
+            11, -35, -97, -103, -6, -44, -16, -7, 3, 24,
+            41, 38, -27, -77, -107, -115, -63, -16, -37, -11,
+            -30, 21, 13, 27, -19, -38, -92, -115, -31, -10,
+            -17, -20, -19, 21, 32, 32, -4, -43, -72, -92,
+            -30, -16, -31, -28, -22, 30, 37, 39, -10, -30,
+            -73, -95, -43, -4, -19, -24, 13, 37, 43, 54,
+            24, -9, -52, -47, -11, -22, -20, -15, -20, 37,
+            31, 34, 30, 1, -6, -16, -27, -17, 7, -13,
+            -39, 24, 38, 15, 43, 3, -2, 7, 13, 2,
+            4, -18, -26, -2, 26, 21, 28, -2, -15, -1,
+            4, -20, 2, -14, -32, 8, 18, 12, 14, -24,
+            -29, -25, -36, -38, 24, -6, -34, 5, 6, 29,
+            -11, -28, -36, -6, 21, -3, 19, -18, -7, 62,
+            24, 58, 18, -17, -40, -21, 4, -9, 14, 21,
+            22, 103, 47, 67, 12, -36, -61, -78, -28, 3,
+            4, 15, 78, 94, 28, 51, 30, -16, -29, -83,
+            -24, -19, 4, 33, 59, 97, 37, 72, 16, 1,
+            5, -27, -20, 2, -7, -23, 65, 72, -3, 10,
+            36, 55, 30, -11, -26, -8, -25, -45, 8, 32,
+            1, 6, 60, 39, 37, 18, 22, -3, -6, -46,
+            -18, 6, -3, 3, 17, 23, 21, 6, 5, -4,
+            -20, -9, -18, -14, -18, -18, 25, 22, 8, 4,
+            19, 27, 10, 6, 2, -13, -4, -17, 6, -7,
+            -27, -6, -6, -14, -18, -13, -10, 11, 14, 11,
+            -9, -15, -20, -13, -8, -15, -43, -2, -5, 3,
+            2, -11, 4, -3, -14, -11, -15, -18, -28, -22,
+            3, 17, -25, -10, -4, -10, -11, -10, -16, -8,
+            -33, -3, 1, 2, -9, -8, 0, -14, -25, -3,
+            -14, -8, -20, 4, 11, 13, 0, -8, 10, 8,
+            0, 12, 17, 11, -3, 12, -9, -5, 4, -10,
+            19, -2, 3, 18, 8, 18, 24, 7, -10, -10,
+            8, 1, 26, 10, 22, 22, 51, 55, 34, 9,
+            -3, -14, 10, -6,
+        },
+        {
+            -28, -48, -47, -37, -25, -4, -10, 1, -15, -15,
+            -2, -10, -15, -8, -42, -29, -25, -28, -18, -13,
+            -25, -27, -21, -21, 14, 12, -4, -28, -39, -24,
+            -22, 1, -18, -18, 4, -6, -11, -32, -62, -29,
+            -23, 3, 8, -15, -23, -18, -5, -17, -15, -14,
+            -11, -2, 16, 11, 4, 2, 6, -3, 15, 10,
+            -48, -78, -33, 27, 21, 46, 7, -1, -4, -22,
+            7, -1, -28, -11, -30, 41, 45, 47, 58, 20,
+            36, 19, 23, 20, -53, -45, 9, 67, 28, 12,
+            7, 27, 39, -3, 3, 12, -49, -32, 28, 53,
+            37, 23, 19, 6, 59, 19, 18, 8, -26, -3,
+            39, 62, -29, 3, 12, -26, 39, 35, 2, 5,
+            -1, 17, 55, 64, 28, 5, 3, -2, 87, 24,
+            8, 1, 5, 25, 53, 54, 28, -28, -14, -5,
+            89, 54, -9, -27, 20, 36, 46, 12, -43, -21,
+            -25, 8, 80, 71, -7, -23, 15, 51, 39, 10,
+            -18, -37, -83, -13, 54, 51, -23, -12, 0, 40,
+            12, -19, -28, -12, -88, -19, 12, 0, -40, -50,
+            18, 37, 14, -31, -65, -50, -47, -31, -3, -30,
+            -4, -60, 4, 32, 21, -20, -42, -7, -44, -30,
+            -19, -48, -15, -60, 8, 25, 30, 10, 13, 6,
+            1, -14, -16, -33, 16, -17, -26, 15, -28, 2,
+            9, -3, 0, 14, 26, -46, 11, -21, 18, -19,
+            -51, -22, 4, 9, 11, 31, -22, -29, 44, 11,
+            -19, -16, -39, -17, -1, -4, 16, 43, 40, 0,
+            56, 37, 17, -24, -34, -23, -36, 5, 32, 67,
+            45, -12, 39, 8, -4, -36, -50, -30, -23, -11,
+            26, 31, 22, -10, 18, 13, -12, -5, 22, 11,
+            -3, -2, -6, 18, 5, 2, -2, 7, 10, 7,
+            17, 19, 11, 25, 30, 16, 12, -1, -9, -1,
+            4, 19, 23, 15, 26, 18, 2, -16, 4, 9,
+            -1, 28, -5, 10, 14, 1, 17, 3, -3, -1,
+            -13, -11, 24, 23, 7, 0, 5, -2, 4, 7,
+            -21, -27, -12, 13, 5, 10, 9, 11, 12, 14,
+            12, 7, -33, -30, -18, -10, 22, 19, 11, 1,
+            -3, 4, 6, 13, -37, -14, -7, 1, 6, 13,
+            12, 20, 22, 19, 14, 16, -19, -12, 4, 13,
+            17, 28, 13, 20, 10, 14, -11, -25, -16, 0,
+            19, 19, 13, 12,
+        },
+        {
+            13, 21, 10, 4, 13, -3, 2, -10, -5, -5,
+            -4, 3, 22, 7, 3, -19, -8, -8, -9, -8,
+            -1, 8, -4, -4, -22, 1, 2, -6, -2, -4,
+            -2, 3, -2, -6, -7, -5, -30, -8, -23, -6,
+            -12, -14, 12, -30, -26, -7, -9, -2, -16, -15,
+            -10, -6, -20, 4, 3, -35, -21, -5, -3, -9,
+            -2, -3, -5, -5, -17, -22, 15, -20, -7, -3,
+            -16, -12, -18, 10, -2, -3, 7, 11, 0, -19,
+            -22, -8, -5, -5, -5, -5, -10, -3, -18, -4,
+            -2, -4, -4, -12, -9, -17, 4, 4, -2, 4,
+            -5, 15, 0, 0, -6, 4, -4, -15, 8, 20,
+            0, 0, -2, 11, 0, -11, -6, -9, -8, -6,
+            37, 29, 20, 3, 24, 19, 14, 4, 3, 2,
+            -5, -17, 12, 15, 15, 16, 31, 21, 25, 27,
+            9, -12, -13, 1, 20, 29, 27, 24, 41, 26,
+            33, 31, 14, 2, 4, -15, 21, 37, 20, 38,
+            35, 47, 26, 3, 5, -3, 1, -22, 15, 21,
+            36, 38, 24, 23, 15, 14, 2, -14, -25, -24,
+            17, 36, 43, 12, 20, 2, 21, -1, -25, -23,
+            -20, -21, 10, 17, 13, 22, 12, 5, 20, 7,
+            -7, -20, -17, -8, 10, 7, 21, 25, 24, 24,
+            20, 1, -11, -21, -19, -4, 6, 31, 16, -1,
+            6, -3, 5, -6, 0, -7, -16, -17, 2, 7,
+            13, 8, -9, -13, 0, -9, -17, -5, -12, -13,
+            -5, 0, 14, 1, -10, 1, 4, -10, -20, -4,
+            -19, -11, 8, 13, 4, 5, -6, -22, -5, -16,
+            -3, 5, 4, 1, -1, 9, -3, -5, 0, 3,
+            22, -3, -10, -9, -9, -6, -3, 6, -4, -6,
+            9, -14, -14, -13, 8, 9, -7, -10, -7, 3,
+            6, 4, 6, -19, -10, -1, -8, -14, -10, -14,
+            -9, -5, 1, -6, -6, -4, -26, -1, -8, -1,
+            -12, -3, -3, 0, -10, -3, -3, 7, -10, -8,
+            2, -6, -8, -19, -12, -7, 0, 7, 11, -1,
+            -12, -16, -7, -10, -6, -15, 2, -18, 1, -9,
+            -7, -5, -27, -7, -12, -21, -14, -17, -7, -11,
+            -14, -12, -7, -3, -3, -6, -9, -16, -6, -13,
+            -10, 6, -2, -7, 19, 7, -5, -3, 5, -11,
+            -12, -21, -6, -3, -1, 2, 9, 13, -3, -12,
+            -13, -7, -15, -8,
+        },
+        {
+            3, -1, -20, -32, -33, -19, -14, -15, -37, -19,
+            -18, -21, -5, -12, -6, -30, -16, -4, -13, -18,
+            -27, -26, -12, -8, 3, -23, -39, -26, -9, -2,
+            3, 5, -29, -38, -21, -20, 34, 1, -2, -1,
+            -7, -2, 11, -16, -13, -32, -7, -10, 6, 7,
+            -9, -12, 17, 4, -4, 2, -5, -19, -11, -17,
+            11, -4, -20, -8, 9, 0, 6, 21, 10, 2,
+            6, 0, -8, -18, -46, -39, -13, -5, -4, -15,
+            1, -24, -12, -5, -33, -63, -57, -39, -28, -23,
+            -12, -6, 1, -7, -6, -10, 2, -39, -24, -26,
+            -13, -23, -5, -15, -7, -5, -6, -13, -12, -13,
+            -28, -26, -16, 4, -2, -12, -11, 1, -4, -5,
+            0, -2, -26, -26, -24, -10, -10, -5, -26, 2,
+            -15, -2, 3, -16, -28, -22, -16, -8, -2, -3,
+            -6, -6, -7, 7, 13, 9, -8, -18, 14, 7,
+            15, 1, 16, -15, -24, -11, 24, 16, 2, -2,
+            32, 7, 36, 24, 10, -19, -19, -37, 29, 12,
+            -2, 13, 17, -2, 41, 26, 20, -56, -39, -39,
+            26, 23, 26, 27, 24, 38, 27, 30, 16, -34,
+            -55, -31, 56, 34, 29, 19, 21, 11, 20, 26,
+            10, -26, -28, -11, 62, 33, 34, 35, 32, 8,
+            15, 15, 12, -12, -23, -22, 44, 43, 25, 15,
+            33, 11, 26, 9, 4, 33, 11, 8, 36, 37,
+            22, 19, 30, 2, 15, 41, 48, 40, 12, 22,
+            18, 5, 11, 2, 13, 25, 27, 31, 49, 35,
+            16, 12, -1, -1, 17, 4, 20, 12, 5, 9,
+            46, 45, 35, 22, 11, -4, 5, 11, 22, 15,
+            8, 33, 13, 48, 22, 27, 0, 5, 6, 0,
+            -5, 19, 26, 22, 16, 25, 20, 27, 0, -5,
+            -9, -3, 6, 1, 34, 32, 19, 4, 27, 25,
+            -1, -4, -9, -16, -16, 10, 36, 32, 16, 4,
+            5, 15, 2, -2, -5, -4, -11, -3, 28, 16,
+            13, 16, 0, 4, -2, 4, -7, 6, -5, 15,
+            36, 37, 33, 13, 14, 10, 5, -10, 3, 8,
+            3, 19, 38, 32, 15, 7, 5, -6, 12, 14,
+            10, 7, 11, 22, 47, 34, 14, 7, 9, 3,
+            36, 20, 23, 39, 22, 15, 51, 25, 23, 3,
+            3, 14, 20, 31, 26, 23, 23, 11, 41, 6,
+            3, 9, 17, 7,
+        },
+        {
+            -17, -18, -38, -26, -12, 4, -1, -8, -19, -2,
+            2, 6, -19, -10, -26, -50, -24, 15, 7, 1,
+            -13, 15, 14, 19, -8, -22, -46, -53, -17, 8,
+            7, -13, -18, -5, 13, 14, -1, -21, -40, -33,
+            7, 10, 5, -21, -26, -3, 32, 18, 1, -22,
+            -53, -44, -17, -14, -23, 4, -22, -5, 8, 14,
+            7, -8, -40, -26, 2, 4, 19, -2, -21, -10,
+            17, 11, 7, -3, 12, 15, 31, -5, 16, 10,
+            -16, -30, 8, 18, 53, 43, 42, 71, 59, 33,
+            64, 22, 5, -13, -1, 14, 57, 42, 63, 113,
+            103, 41, 61, 34, 2, -8, 10, 11, 39, 29,
+            33, 86, 105, 92, 61, 34, 22, 10, 36, 20,
+            13, 13, 7, 48, 51, 15, 44, 12, -36, 0,
+            -17, -2, -12, -24, -11, 24, 24, 20, 21, -9,
+            -61, -4, -10, 17, -2, -14, -21, -8, 3, 6,
+            11, -14, -45, 7, 2, 30, -32, -21, -19, -36,
+            -12, 19, 7, -22, -57, -4, -3, 17, 11, -5,
+            0, -11, -7, -8, 31, -20, -40, 6, 13, 40,
+            -1, -10, -6, 0, -4, 10, -3, -12, -2, 23,
+            -2, 31, -11, 24, 28, -10, 14, 5, -12, -27,
+            -51, 2, -2, 2, 17, 24, 21, 15, 6, 26,
+            -14, -11, -24, -28, -42, -20, 37, 38, 56, 5,
+            7, 31, 3, 2, -5, -31, -33, -14, 38, 29,
+            58, 49, 24, 17, 0, 7, -26, -24, -40, -38,
+            25, 26, 6, 4, -8, 11, -11, -12, -47, -46,
+            -59, -57, 5, 17, 24, 0, 8, 9, -4, -5,
+            -40, -38, -29, -28, 3, 10, 27, 15, 18, 37,
+            7, 6, -6, -21, -28, -15, 10, 13, 17, 13,
+            3, 31, 11, 10, 21, 8, 6, -13, -8, -5,
+            -1, -10, -15, 9, -12, -4, -2, 7, 16, 16,
+            -24, -26, -17, -22, -20, -18, -6, 12, -8, 2,
+            3, 3, -18, -17, -14, -25, -20, -13, -47, 5,
+            12, 11, -2, -5, -29, -27, -20, -17, -32, -14,
+            -33, 6, 16, 11, 3, 4, -40, -33, -25, -34,
+            -31, -24, -24, -4, 8, 9, 13, -3, 26, 20,
+            23, 34, 33, 18, 2, 16, 12, -2, 11, 8,
+            38, 44, 34, 33, 33, -4, 8, 8, 0, 2,
+            14, 8, 21, 36, 44, 33, 40, 25, 37, 19,
+            12, 16, 30, 17,
+        },
+        {
+            -7, 28, -43, -13, 1, 8, 8, -13, 21, 15,
+            9, 18, -11, -25, -19, -55, -8, -4, -1, 9,
+            33, 34, 20, 24, 14, -29, -30, -7, -6, 10,
+            18, 20, 33, 36, 18, 17, -6, -9, 17, -19,
+            -37, -8, 17, 6, 24, 22, 14, 28, -17, -40,
+            -30, -17, 10, 9, 13, -3, 23, 12, 12, 14,
+            -8, -24, 12, 26, -19, -32, 15, 23, 31, 28,
+            1, 15, -7, 0, 12, 33, 17, -16, 16, 29,
+            28, 8, 7, -3, -15, -19, -8, -7, 25, 2,
+            -10, 1, 14, 10, 24, 12, 35, 9, 12, 4,
+            -13, 11, 13, -28, 14, 21, 6, 11, 21, 10,
+            6, -1, 35, -14, 13, 0, 18, 10, 6, 1,
+            0, 5, 11, -11, -50, -13, -20, -1, -19, 1,
+            9, 10, 10, 7, 12, -1, -7, -4, 6, -26,
+            -5, 11, 24, 17, -10, 2, 0, 19, 8, -5,
+            1, -8, -19, -11, -24, -4, -3, -4, -9, 9,
+            14, -5, -3, -21, -21, -5, -10, -18, -17, -27,
+            -22, 11, -14, -11, 1, -18, -30, -17, -24, -25,
+            -34, -42, -25, -9, -18, -14, -4, -13, -26, -30,
+            -40, -29, -57, -48, -25, -20, -12, -34, -13, -11,
+            -32, -17, -8, 0, -51, -34, -32, -29, -39, -27,
+            -10, -24, -34, 4, 10, 26, -62, -39, -27, -35,
+            -33, -35, -21, -18, -43, 4, 23, 24, -70, -52,
+            -13, -30, -40, -25, -26, -15, -14, 33, -1, -6,
+            -65, -78, -47, -42, -37, -26, -30, -48, -3, 39,
+            25, 28, -57, -58, -56, -38, -27, -22, -42, -26,
+            -15, 13, 1, 9, -43, -44, -39, -61, -50, -23,
+            -15, -4, -4, 16, 14, 13, -32, -34, -38, -28,
+            -21, -9, -22, -11, -4, -5, 21, 12, -25, -33,
+            -26, -23, -14, -17, -18, -5, 3, -10, 6, 1,
+            -9, -21, -17, -14, 9, 3, -29, 2, 7, 10,
+            -5, -13, -6, -6, -7, 2, 7, 2, 14, -14,
+            8, 6, -6, -4, 18, 2, -2, -4, 3, 14,
+            -2, 18, 7, 13, 2, -3, 16, 8, -6, 12,
+            -4, 12, 53, 7, 3, 7, 1, 0, -2, 10,
+            -4, 7, -1, 40, 58, 35, 11, -8, -11, 3,
+            -8, -6, -10, -3, -2, 22, 43, 18, 9, 10,
+            -3, 15, -4, -10, 1, 5, 8, 13, 27, 38,
+            12, 12, 19, 14,
+        },
+        {
+            -29, -36, -36, -16, -36, -18, -8, -38, -49, -30,
+            -5, -1, -17, -20, -21, -14, -38, -1, 8, -15,
+            -40, -22, 16, 1, -14, -6, -20, -3, -7, 17,
+            17, 16, -31, -17, 17, 20, 7, -12, -6, 9,
+            29, 23, 47, 9, -22, -3, 26, 9, -8, 3,
+            7, -2, 34, 52, 33, 40, 13, 17, 30, 22,
+            8, 3, 12, 17, 66, 57, 55, 23, 40, 29,
+            32, 33, -18, -16, 17, 31, 42, 41, 16, 33,
+            30, 32, 35, 32, -11, 4, 41, 58, 16, -19,
+            31, 11, 21, 35, 35, 21, 2, -9, 26, 33,
+            21, -17, 1, -2, 24, 34, 27, 30, -23, -12,
+            21, 26, -4, -9, 0, 3, 23, 28, 20, 22,
+            -16, 2, 8, 13, 0, 13, 5, 13, 32, 51,
+            21, 28, -15, -3, -7, 1, 10, 4, 17, 30,
+            49, 57, 35, 20, -14, 7, -10, 0, 9, 4,
+            6, 20, 39, 50, 44, 35, -23, 4, 10, -17,
+            -4, 4, -10, 12, 25, 31, 5, 1, 6, -2,
+            -12, -5, 1, 9, -13, 8, 3, 22, 2, 0,
+            -23, -26, -37, -9, -20, -1, 2, 2, -34, 5,
+            -21, -12, -41, -3, 2, -17, 0, 1, -17, -18,
+            -39, -10, 0, 4, -6, 13, 0, -10, -2, -6,
+            -3, -20, -48, -37, -19, -21, 0, 15, 16, 0,
+            1, -8, -10, -6, -12, -24, -20, -30, -4, 12,
+            1, 0, 13, 15, 13, 13, -2, -12, -6, 0,
+            -3, -7, -13, -11, -6, -1, 13, 2, 28, 10,
+            36, 16, 4, 4, 2, 10, -6, -2, 4, 16,
+            23, 12, 25, 19, -9, -8, -11, -7, -4, -19,
+            -12, 24, 12, 11, 13, 6, -5, 6, -4, 2,
+            -4, -6, -11, 23, 24, 14, 16, 14, 2, 6,
+            7, 10, 2, -10, -22, 10, 15, 11, 11, 12,
+            7, 5, 4, -1, -3, -3, -42, 15, 21, 24,
+            20, 9, 4, -3, 2, 4, 5, -11, -40, 1,
+            6, 10, 21, 21, -4, -1, -8, -1, 2, -38,
+            -32, -3, 21, 18, 15, 23, -11, -18, -11, -15,
+            -24, -59, -8, 11, 2, 18, 21, 8, -27, -19,
+            -21, -24, -23, -43, -7, 5, 18, 4, 11, 11,
+            -13, -16, -23, -16, -24, -18, -1, -1, 10, 8,
+            22, 21, -25, -17, -33, -27, -33, -16, 0, -5,
+            12, 3, 6, 10,
+        },
+        {
+            -8, -14, -31, -31, -19, -17, 4, -11, -11, -4,
+            -4, -4, -18, -21, -26, -23, -12, -10, -2, -3,
+            -12, 6, 2, 4, -35, -29, -27, -20, -11, -13,
+            -10, -3, -1, 2, -12, -3, -11, -19, -12, -16,
+            9, -11, -8, 8, -6, 7, 6, 5, -8, -33,
+            -34, -27, -22, -11, -3, -2, -3, -4, -3, 4,
+            -17, -15, -2, 1, 3, -1, -7, 7, 6, 6,
+            7, 2, -64, -53, -48, -49, -51, -41, -19, -21,
+            2, -12, -13, -4, -53, -16, -27, -50, -60, -32,
+            -33, -20, -16, 3, 4, -11, 14, -16, -5, -43,
+            -42, -23, -34, -17, 13, 29, 22, 12, -1, 7,
+            -1, -7, 0, 0, -12, 5, 30, 29, 37, 22,
+            16, 14, -3, -17, -34, -32, -26, -6, 32, 39,
+            26, 19, 3, 21, 4, -15, -10, 0, -11, 9,
+            34, 28, 30, 23, 5, 22, -5, -10, -10, -15,
+            10, 22, 31, 21, 28, 35, 10, 8, -5, -4,
+            -1, -25, 7, 23, 19, 10, 22, 17, 8, 11,
+            -7, -8, -12, 2, 39, 6, 15, -51, 4, 0,
+            -5, 3, 5, -11, 12, 19, 12, 1, -25, -44,
+            -27, 2, 8, 2, -7, -2, 22, 4, 21, -18,
+            -14, -25, -10, 0, 38, 32, 9, -7, -1, 19,
+            7, -5, -2, 1, -11, 3, 47, 36, 18, 7,
+            -3, 11, 37, -4, -3, 9, 7, 15, 18, 28,
+            15, 2, 13, 5, 10, 3, 25, 4, -12, -2,
+            39, 32, 7, -9, -16, 3, 29, -23, 14, 2,
+            -5, -8, -1, 31, 38, 7, 17, -25, 17, -7,
+            22, 27, 9, 1, 7, 0, 29, 13, 15, 3,
+            24, 31, 17, 28, 0, 20, 6, 25, 25, 11,
+            3, -11, -3, 15, 25, 5, 20, 19, 7, -3,
+            -9, 5, -3, -4, -19, -2, 12, 14, 12, 28,
+            -11, -5, -20, -5, -19, -21, 27, 30, 33, 12,
+            18, 23, -11, 2, -16, -15, -4, -7, 10, 41,
+            33, 29, 15, 16, -7, -3, 1, -3, -7, 5,
+            21, 59, 32, 30, 29, 17, 9, -7, 3, 1,
+            7, 4, 34, 63, 44, 42, 14, 17, 4, 8,
+            2, 8, -1, 9, 35, 59, 43, 23, 35, 22,
+            3, 11, 15, 9, 20, 30, 55, 45, 40, 29,
+            32, 21, 12, 10, 16, 12, 12, 20, 63, 42,
+            32, 23, 26, 17,
+        },
+        {
+            16, -3, -17, 3, -2, 21, 11, 11, 15, 6,
+            14, 5, -11, -15, -5, -3, 8, -1, 11, 23,
+            -1, 1, 11, 16, 12, 17, 12, -5, 11, 18,
+            9, 3, 17, 7, 5, 11, -6, -23, 9, 2,
+            11, 7, 9, 8, 10, 14, 16, 0, -17, -8,
+            6, -2, 9, 3, -1, 14, 14, 6, -3, 10,
+            -37, -28, 4, 12, -2, 3, 4, 16, 25, 6,
+            -5, -10, -17, -20, 5, 19, 6, 42, 10, 16,
+            8, -2, -6, 5, -33, -17, 7, 14, 6, 16,
+            16, 24, 16, 8, 4, 0, -18, -20, 13, 6,
+            -11, -14, 19, 17, 22, 7, -4, -4, -17, -13,
+            0, 5, -20, -7, 0, 4, 5, -5, 3, -6,
+            -30, -2, 11, 12, -8, -13, -15, -1, 20, -9,
+            -6, -14, -22, -12, 5, -6, -10, -13, -16, 3,
+            23, -16, -6, -8, 1, -14, -3, -17, -24, -17,
+            -20, -1, 23, -1, -19, -36, -20, -17, -13, -18,
+            -28, -11, -16, -11, 4, -10, -11, -9, -30, -11,
+            -25, -36, -16, 1, -18, -14, 2, -1, -6, -19,
+            -28, -27, -26, -18, -30, -9, -12, -20, -12, -4,
+            9, 4, -35, -5, -12, -17, -22, 1, -10, -1,
+            -9, 11, 14, 7, -40, -22, -4, -27, -5, -9,
+            4, 6, -9, -9, 9, 8, -32, -34, -48, -24,
+            -10, 9, 2, 25, 11, -2, -2, -11, -4, -34,
+            -30, -20, -4, 8, 8, 17, -3, -8, 1, 4,
+            -53, -41, -29, -30, -25, 11, 19, 20, 13, -6,
+            4, 6, -12, -32, -13, -11, 8, 2, 18, 1,
+            12, -5, 3, 6, -21, -23, -18, -8, -12, -20,
+            12, 14, -5, 0, 9, 2, -8, -3, -9, 2,
+            0, -9, -6, 13, -5, 1, -8, -2, -17, -3,
+            0, -4, 7, -19, -35, 3, 5, 3, -9, -2,
+            -14, 1, -5, -1, -6, 4, -31, 0, 0, 10,
+            20, 21, 1, -2, -12, -5, -1, -7, -17, 12,
+            8, 9, 20, 25, 2, -5, -5, 2, 8, 12,
+            -24, 12, 16, 21, 16, 18, -6, -12, 3, 1,
+            9, -4, 0, 11, 16, 5, 25, 17, -1, 0,
+            -9, -9, -4, 24, 2, 9, 19, 25, 26, 27,
+            7, 0, 1, 8, 14, 14, 18, 40, 16, 20,
+            38, 31, 11, 7, 2, 18, 30, 36, 31, 22,
+            15, 19, 22, 27,
+        },
+        {
+            25, 48, 33, 22, 24, -13, -22, -63, -58, -42,
+            6, -6, 35, 28, 37, 9, 13, 39, 9, -32,
+            -61, -31, -8, -18, 30, 40, 36, 29, 41, 53,
+            19, -25, -58, -56, -3, 3, 35, 38, 38, 60,
+            44, 34, 39, 1, -56, -58, -12, -7, 20, 38,
+            55, 91, 94, 54, 62, 7, -51, -42, -5, -10,
+            36, 30, 63, 96, 127, 45, 62, 23, -32, -32,
+            -15, -7, 33, 25, 50, 102, 124, 43, 50, -8,
+            -26, -26, -11, -6, 49, 39, 71, 94, 70, 4,
+            34, -12, -22, -25, -1, 1, 22, 15, 46, 56,
+            18, -4, -1, -26, -31, 6, 4, 14, 5, 0,
+            19, -2, 33, -1, 14, 0, -1, 18, 7, 22,
+            -30, 3, 0, -15, -22, 22, 1, 2, -33, -3,
+            -10, 5, -36, -32, -34, -1, 21, 8, -16, -21,
+            -15, 47, 10, 34, 3, -31, -18, 5, 16, -5,
+            -19, -25, -15, -1, 10, 27, -28, -4, 12, -1,
+            12, 5, -4, -40, -45, -1, -7, 23, 2, -10,
+            22, 20, 25, 13, 18, -53, -89, -35, -45, -10,
+            -1, -19, 15, 21, 33, 37, -10, -34, -73, -29,
+            -47, -25, 10, 34, 45, 43, 48, 30, 3, -19,
+            -68, -46, -49, -29, 30, 34, 57, 70, 16, 12,
+            10, 8, -38, -11, -7, 4, 24, 38, 30, 17,
+            10, 12, 3, 21, -16, -9, -30, -1, -16, 6,
+            5, -21, -11, -3, 19, 23, -5, -17, -29, -13,
+            0, -1, 6, 0, -5, -11, 11, 31, -7, -16,
+            -24, -1, -10, -3, -5, -10, 0, -3, -7, 7,
+            -2, -9, -10, 2, -10, -11, -6, -11, -14, 3,
+            -5, 26, 23, 9, -4, 10, -12, -10, 0, -19,
+            -22, -23, -6, 17, 14, 17, 38, 26, -10, 1,
+            -10, -24, -7, -16, -38, 6, 9, 24, 25, 11,
+            -13, -9, -11, -21, -13, -5, -29, 32, 16, 34,
+            24, 15, -7, 5, -5, -16, -10, -12, -54, 12,
+            21, 7, 16, 2, -6, -11, 1, -16, -11, 1,
+            -45, 9, 22, 24, 14, 3, -28, -23, -24, -25,
+            -26, -22, -13, 22, 8, 9, 9, 2, 4, -1,
+            5, -13, -4, -31, 9, 26, 15, 16, 2, -3,
+            23, 19, 13, -7, 0, -19, 13, 5, 15, 7,
+            19, 22, 5, 7, 6, -6, 2, -19, 11, -2,
+            14, 19, 22, 27,
+        },
+    },
+    {
+        1602, 655, -535, -724, -777, -373, 469, -597, 85, -16,
+        822, 434, 3, 149, -568, 1141,
+    },
+    28,
+    {
+        -127, -115, -9, -6, 31, 49, -94, 52, -47, -18,
+        -59, -31, -13, -14, 0, -70,
+    },
+    -24,
+    907,
+};
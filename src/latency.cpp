@@ -0,0 +1,121 @@
+#include "latency.h"
+
+#include <esp_log.h>
+#include <string.h>
+
+#include "main.h"
+
+// Log-linear histogram: 8 sub-buckets per power of two from 1us to ~2s,
+// small enough to keep one per stage in internal RAM
+#define LATENCY_SUB_BITS 3
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_OCTAVES 22
+#define LATENCY_BUCKETS (LATENCY_SUB_BUCKETS * LATENCY_OCTAVES)
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+typedef struct {
+  uint32_t buckets[LATENCY_BUCKETS];
+  uint32_t count;
+  uint32_t max_us;
+} LatencyHistogram;
+
+static LatencyHistogram histograms[LATENCY_STAGE_COUNT];
+
+static const char* stage_names[LATENCY_STAGE_COUNT] = {
+    "capture->encoded", "encode", "encoded->sent",   "mouth->wire",
+    "arrival->decoded", "decode", "decoded->played", "wire->speaker",
+};
+
+// Bucket holding a value: exact below 8us, then 8 steps per octave
+static int bucket_index(uint32_t us) {
+  if (us < LATENCY_SUB_BUCKETS) {
+    return us;
+  }
+  int msb = 31 - __builtin_clz(us);
+  int shift = msb - LATENCY_SUB_BITS;
+  int index = (shift + 1) * LATENCY_SUB_BUCKETS +
+              ((us >> shift) & (LATENCY_SUB_BUCKETS - 1));
+  return index < LATENCY_BUCKETS ? index : LATENCY_BUCKETS - 1;
+}
+
+// Midpoint of a bucket
+static uint32_t bucket_value(int index) {
+  if (index < LATENCY_SUB_BUCKETS) {
+    return index;
+  }
+  int shift = index / LATENCY_SUB_BUCKETS - 1;
+  uint32_t low = (uint32_t)(LATENCY_SUB_BUCKETS + index % LATENCY_SUB_BUCKETS)
+                 << shift;
+  return low + ((1u << shift) >> 1);
+}
+
+void latency_record(LatencyStage stage, int64_t us) {
+  if (us < 0) {
+    us = 0;
+  } else if (us > UINT32_MAX) {
+    us = UINT32_MAX;
+  }
+  LatencyHistogram* h = &histograms[stage];
+  h->buckets[bucket_index((uint32_t)us)]++;
+  h->count++;
+  if ((uint32_t)us > h->max_us) {
+    h->max_us = (uint32_t)us;
+  }
+}
+
+void latency_percentiles(LatencyStage stage, LatencyPercentiles* out) {
+  const LatencyHistogram* h = &histograms[stage];
+  memset(out, 0, sizeof(*out));
+  out->count = h->count;
+  out->max_us = h->max_us;
+  if (h->count == 0) {
+    return;
+  }
+
+  // Ranks of each percentile, rounded up so p99 of 100 samples is the 99th
+  uint32_t rank50 = (h->count * 50 + 99) / 100;
+  uint32_t rank95 = (h->count * 95 + 99) / 100;
+  uint32_t rank99 = (h->count * 99 + 99) / 100;
+  uint32_t seen = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    if (h->buckets[i] == 0) {
+      continue;
+    }
+    seen += h->buckets[i];
+    if (out->p50_us == 0 && seen >= rank50) {
+      out->p50_us = bucket_value(i);
+    }
+    if (out->p95_us == 0 && seen >= rank95) {
+      out->p95_us = bucket_value(i);
+    }
+    if (seen >= rank99) {
+      out->p99_us = bucket_value(i);
+      break;
+    }
+  }
+
+  // A bucket midpoint can overshoot the largest sample actually seen
+  out->p50_us = MIN(out->p50_us, out->max_us);
+  out->p95_us = MIN(out->p95_us, out->max_us);
+  out->p99_us = MIN(out->p99_us, out->max_us);
+}
+
+void latency_dump() {
+  ESP_LOGI(LOG_TAG, "%-18s %8s %9s %9s %9s %9s", "latency stage", "frames",
+           "p50(us)", "p95(us)", "p99(us)", "max(us)");
+  for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    LatencyPercentiles p;
+    latency_percentiles((LatencyStage)stage, &p);
+    ESP_LOGI(LOG_TAG, "%-18s %8lu %9lu %9lu %9lu %9lu", stage_names[stage],
+             (unsigned long)p.count, (unsigned long)p.p50_us,
+             (unsigned long)p.p95_us, (unsigned long)p.p99_us,
+             (unsigned long)p.max_us);
+  }
+}
+
+void latency_reset() {
+  memset(histograms, 0, sizeof(histograms));
+}
@@ -0,0 +1,44 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+// Per-frame latency stages, measured with esp_timer_get_time()
+// Uplink (mouth-to-wire):
+//   capture  - I2S read completion
+//   encoded  - opus_encode done
+//   sent     - peer_connection_send_audio returned (WebRTC task)
+// Downlink (wire-to-speaker):
+//   arrival  - packet handed to onaudiotrack
+//   decoded  - opus_decode done
+//   played   - I2S write completion (frame queued to the speaker DMA)
+typedef enum {
+  LATENCY_CAPTURE_TO_ENCODED,  // Ring queueing + encode
+  LATENCY_ENCODE,              // opus_encode alone
+  LATENCY_ENCODED_TO_SENT,     // Uplink ring + RTP/SRTP/socket send
+  LATENCY_MOUTH_TO_WIRE,       // capture -> sent
+  LATENCY_ARRIVAL_TO_DECODED,  // Jitter buffer wait + decode
+  LATENCY_DECODE,              // opus_decode alone
+  LATENCY_DECODED_TO_PLAYED,   // Waiting for speaker DMA space
+  LATENCY_WIRE_TO_SPEAKER,     // arrival -> played
+  LATENCY_STAGE_COUNT,
+} LatencyStage;
+
+typedef struct {
+  uint32_t count;
+  uint32_t p50_us;
+  uint32_t p95_us;
+  uint32_t p99_us;
+  uint32_t max_us;
+} LatencyPercentiles;
+
+// Record one sample; each stage must be recorded from a single task
+void latency_record(LatencyStage stage, int64_t us);
+
+// Percentiles of a stage, approximated to within ~6% by its histogram
+void latency_percentiles(LatencyStage stage, LatencyPercentiles* out);
+
+void latency_dump(void);   // Print a p50/p95/p99 table for every stage
+void latency_reset(void);  // Clear all histograms
+
+#endif  // LATENCY_H
@@ -3,13 +3,36 @@
 #include <esp_event.h>
 #include <esp_log.h>
 #include <peer.h>
+#include <stdlib.h>
 
+#include "boot.h"
+#include "latency.h"
+#include "mem.h"
 #include "nvs_flash.h"
 
+// Audio phase: I/O backend and downlink decoder (runs on core 1)
+static void boot_audio() {
+  init_audio_capture();  // Set up I2S audio interfaces (files on Linux)
+  init_audio_decoder();  // Initialize Opus decoder for incoming audio
+}
+
+// Signaling phase: TLS setup and DNS lookup of the API host, once the
+// network is up (runs on core 1 while core 0 generates the DTLS keys)
+static void boot_signaling() {
+  boot_wait(BOOT_BIT(BOOT_NETWORK));
+  http_prepare();
+}
+
 // Main application entry point
-// Initializes system components and starts the WebRTC communication
+// Starts the init phases in parallel and runs the WebRTC session
 extern "C" void app_main(void) {
+  boot_init();
+  mem_init();
+  mem_task_track(xTaskGetCurrentTaskHandle(), "main",
+                 CONFIG_ESP_MAIN_TASK_STACK_SIZE, MEM_INTERNAL);
+
   // Initialize non-volatile storage (NVS) for storing system configuration
+  boot_begin(BOOT_NVS);
   esp_err_t ret = nvs_flash_init();
   if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
       ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -18,14 +41,28 @@ extern "C" void app_main(void) {
     ret = nvs_flash_init();
   }
   ESP_ERROR_CHECK(ret);
+  boot_end(BOOT_NVS);
 
   // Create default event loop for system events
   ESP_ERROR_CHECK(esp_event_loop_create_default());
 
-  // Initialize system components in sequence:
-  peer_init();           // Initialize WebRTC peer connection system
-  init_audio_capture();  // Set up I2S audio interfaces
-  init_audio_decoder();  // Initialize Opus decoder for incoming audio
-  wifi();                // Connect to WiFi network
-  webrtc();              // Start WebRTC session (this call blocks indefinitely)
+#ifdef LINUX_BUILD
+  // Print latency percentiles when a host run ends
+  atexit(latency_dump);
+#endif
+
+  // Independent phases, each signalling its BOOT_BIT when done:
+  //   nvs -> audio                          (core 1)
+  //   nvs -> network -> signaling           (Wi-Fi driver, core 1)
+  //   nvs -> peer                           (core 0, in webrtc)
+  //   audio + signaling + peer -> connect -> audio-in
+  start_console();  // Accept diagnostics commands on the serial console
+  boot_spawn(BOOT_AUDIO, boot_audio, "boot_audio", 1);
+#ifndef LINUX_BUILD
+  wifi();  // Start connecting to WiFi (returns before association)
+#else
+  boot_end(BOOT_NETWORK);  // The host is already online
+#endif
+  boot_spawn(BOOT_SIGNALING, boot_signaling, "boot_signaling", 1);
+  webrtc();  // Start WebRTC session (this call blocks indefinitely)
 }
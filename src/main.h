@@ -3,27 +3,73 @@
 
 #include <peer.h>
 
+#include "aec.h"
+#include "jitter_buffer.h"
+
 // Project identification and logging
 #define LOG_TAG "ESP32S3-embedded-TEJ4"  // Tag used for ESP logging system
 
-// Buffer configuration
-#define MAX_HTTP_OUTPUT_BUFFER 2048  // Maximum size for HTTP response data
-
 // Network and connectivity functions
-void wifi(void);  // Initialize and connect WiFi
-void webrtc();    // Set up and manage WebRTC connection
-void http_request(char* offer,
-                  char* answer);  // Handle HTTP communication with OpenAI API
+void wifi(void);                  // Initialize and connect WiFi
+void webrtc();                    // Set up and manage WebRTC connection
+void webrtc_dump(void);           // Print session and loop counters
+char* http_request(char* offer);  // POST SDP offer to OpenAI, NULL on error
+void http_prepare(void);          // TLS setup and API host lookup ahead
+
+// Diagnostics
+void start_console(void);  // Serial console for on-demand stats dumps
 
 // Audio system initialization
 void init_audio_capture(void);  // Set up I2S for INMP441 and MAX98357A
 void init_audio_decoder(void);  // Initialize Opus decoder for incoming audio
 void init_audio_encoder();      // Initialize Opus encoder for outgoing audio
 
+// Capture pipeline counters
+typedef struct {
+  uint32_t frames;     // Frames delivered by the I2S DMA
+  uint32_t depth;      // Frames waiting to be encoded
+  uint32_t overruns;   // Frames dropped because the encoder fell behind
+  uint32_t underruns;  // Encoder waits that timed out without a frame
+} AudioCaptureStats;
+
+// Encode/send counters; silent frames are skipped before opus_encode
+typedef struct {
+  uint32_t frames;     // Frames taken from the capture ring
+  uint32_t encoded;    // Frames passed to opus_encode
+  uint32_t skipped;    // Silent frames sent as a TOC-only DTX packet
+  uint32_t packets;    // Packets handed to libpeer
+  uint32_t bytes;      // Opus payload bytes sent
+  uint32_t dropped;    // Packets dropped, WebRTC task not keeping up
+  uint64_t encode_us;  // Time spent inside opus_encode
+  uint32_t gated;      // Frames that ended with the noise gate closed
+  int32_t agc_gain;    // Current microphone AGC gain, Q8
+  uint32_t muted;      // Frames held back waiting for the wake word
+  uint32_t wakes;      // Wake-word detections that opened the uplink
+} AudioSendStats;
+
+// Playout counters on the speaker side of the jitter buffer
+typedef struct {
+  uint32_t frames;     // Packets decoded or concealed and written
+  uint32_t samples;    // Samples written per channel
+  uint32_t underruns;  // Speaker ran dry before the next packet of a stream
+  uint32_t invalid;    // Packets whose duration could not be parsed
+} AudioPlayoutStats;
+
 // Audio processing functions
+void start_audio_capture(void);  // Start DMA-driven capture into frame ring
+void encode_audio(void);         // Encode a captured frame for the uplink
+void audio_uplink_start(void);   // Session connected: queue packets to send
 void send_audio(
-    PeerConnection* peer_connection);  // Capture and send audio through WebRTC
+    PeerConnection* peer_connection);  // Send the packets encoded so far
+void audio_capture_stats(AudioCaptureStats* stats);  // Read capture counters
 void audio_decode(uint8_t* data,
-                  size_t size);  // Process and play received audio
+                  size_t size);  // Queue received audio in the jitter buffer
+void audio_playout_stats(JitterBufferStats* stats);  // Read jitter counters
+void audio_speaker_stats(AudioPlayoutStats* stats);  // Read playout counters
+void audio_aec_stats(AecStats* stats);               // Read AEC counters
+void audio_send_stats(AudioSendStats* stats);        // Read send counters
+void audio_session_reset(void);  // Drop audio state of a closed session
+void audio_noise_suppression(bool enabled);  // Switch noise suppression
+bool audio_noise_suppression_enabled(void);
 
 #endif  // MAIN_H
@@ -1,146 +1,598 @@
-#include <driver/i2s.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <opus.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "aec.h"
+#include "audio_io.h"
+#include "deadline.h"
+#include "dsp.h"
+#include "jitter_buffer.h"
+#include "kws.h"
+#include "latency.h"
 #include "main.h"
+#include "mem.h"
+#include "ns.h"
+#include "pcm.h"
+#include "rate_control.h"
+#include "resample.h"
+#include "ring_buffer.h"
+#include "sched.h"
+#include "vad.h"
 
 // Buffer and sampling configuration
 #define OPUS_OUT_BUFFER_SIZE \
   1276  // Maximum size for Opus encoded data (recommended by opus_encode)
-#define SAMPLE_RATE 8000    // Audio sampling rate in Hz
-#define BUFFER_SAMPLES 320  // Number of samples per buffer (40ms at 8kHz)
+#ifndef SAMPLE_RATE
+#define SAMPLE_RATE 8000  // Opus encode/decode rate in Hz
+#endif
 
-// MAX98357A amplifier pin configuration
-#define MCLK_PIN 0        // Master clock
-#define DAC_BCLK_PIN 20   // Bit clock
-#define DAC_LRCLK_PIN 21  // Word select / Left-right clock
-#define DAC_DATA_PIN 19   // Data output
+// I2S clock for the INMP441 and MAX98357A, independent of the codec rate:
+// the resampler converts captured frames down to SAMPLE_RATE and decoded
+// packets back up to it
+#ifndef AUDIO_IO_RATE
+#define AUDIO_IO_RATE 16000  // I2S sampling rate in Hz
+#endif
+#define AUDIO_RESAMPLE_QUALITY RESAMPLE_MEDIUM  // HIGH: same stopband, 2x taps
 
-// INMP441 microphone pin configuration
-#define ADC_BCLK_PIN 47   // Bit clock
-#define ADC_LRCLK_PIN 41  // Word select / Left-right clock
-#define ADC_DATA_PIN 45   // Data input
+// Noise suppression at startup; `n` on the serial console toggles it
+#ifndef AUDIO_NOISE_SUPPRESSION
+#define AUDIO_NOISE_SUPPRESSION 1
+#endif
+
+// Wake-word gate: the uplink stays muted until the keyword spotter hears
+// the wake word, then the pre-roll (audio from before and during the
+// keyword) is sent ahead of live audio. Off by default: the shipped model
+// is a placeholder until one is trained with the kws benchmark
+#ifndef WAKE_WORD_GATE
+#define WAKE_WORD_GATE 0
+#endif
+#define WAKE_PREROLL_MS 1000  // Audio kept from before the detection
+#define WAKE_IDLE_MS 15000    // Without speech either way, mute again
+#define WAKE_PLAYOUT_LEVEL 128  // Downlink RMS that counts as far-end speech
+
+// Capture frame configuration (one DMA buffer == one Opus frame)
+#define FRAME_DURATION_MS 20  // Opus frame duration in milliseconds
+#define FRAME_SAMPLES \
+  (SAMPLE_RATE * FRAME_DURATION_MS / 1000)  // Mono samples per frame
+#define IO_FRAME_SAMPLES \
+  (AUDIO_IO_RATE * FRAME_DURATION_MS / 1000)  // I2S samples per frame
+#define CAPTURE_RING_SLOTS 8  // Frames buffered between capture and encode
+#define UPLINK_RING_SLOTS 4   // Packets buffered between encode and network
+
+// Playout configuration (jitter buffer -> decoder -> MAX98357A)
+#define PLAYOUT_STATS_INTERVAL 500  // Frames between jitter stats logs (10s)
+#define RTP_HEADER_SIZE 12          // Fixed RTP header preceding the payload
+#define PLAYOUT_MAX_MS 120          // Longest Opus packet
+#define PLAYOUT_MAX_SAMPLES \
+  (SAMPLE_RATE * PLAYOUT_MAX_MS / 1000)  // Mono samples per decoded packet
 
 // Opus codec configuration
 #define OPUS_ENCODER_BITRATE 30000  // Encoding bitrate in bits per second
-#define OPUS_ENCODER_COMPLEXITY 0   // Lower complexity for better performance
+#define OPUS_ENCODER_COMPLEXITY 0   // Starting point, raised with CPU headroom
+
+// Silence suppression: while the VAD reports silence only every
+// COMFORT_NOISE_INTERVAL-th frame is encoded, with Opus DTX enabled. The
+// others still go out as a TOC-only packet (a zero-length frame, played as
+// DTX), because libpeer advances the RTP timestamp by 20ms per packet
+#define COMFORT_NOISE_INTERVAL 20  // Silent frames per comfort noise (400ms)
+
+// Capture frames collected into one Opus packet at the longest frame
+// duration the rate controller may pick
+#define PACKET_MAX_FRAMES (RATE_CONTROL_MAX_FRAME_MS / FRAME_DURATION_MS)
+#define WAKE_PREROLL_FRAMES (WAKE_PREROLL_MS / FRAME_DURATION_MS)
 
 // Function declarations for audio processing
-void init_audio_capture();  // Initialize I2S for input/output
+void init_audio_capture();  // Initialize audio I/O backend
 void init_audio_decoder();  // Set up Opus decoder
 void audio_decode(uint8_t* data, size_t size);     // Process incoming audio
 void init_audio_encoder();                         // Set up Opus encoder
-void send_audio(PeerConnection* peer_connection);  // Process and send audio
+void encode_audio();                               // Encode captured audio
+void send_audio(PeerConnection* peer_connection);  // Send encoded audio
+void start_audio_capture();                        // Start capture stage
+
+// Capture stage state: backend frames feeding a lock-free frame ring
+static FrameRing capture_ring;
+static opus_int16* capture_storage = NULL;         // MEM_DMA
+static int64_t capture_times[CAPTURE_RING_SLOTS];  // I2S read completion
+static opus_int16 capture_discard[FRAME_SAMPLES];  // Sink for dropped frames
+static TaskHandle_t capture_consumer = NULL;       // Encode task to wake
+static uint32_t capture_frames = 0;                // Frames committed
+static Resampler capture_resampler;                // I2S rate to SAMPLE_RATE
+static opus_int16* capture_io = NULL;  // MEM_DMA, I2S frame when resampling
+
+// Microphone front end: DC is removed at capture, before the echo
+// canceller and VAD see the frame; gate and AGC run after the VAD so level
+// changes never look like speech. They see every frame, so hold, background
+// and gain move in real time, but only encoded frames keep their output
+static DspChain capture_chain;
+static DspHighpass capture_highpass;
+static DspChain voice_chain;
+static DspGate voice_gate;
+static DspAgc voice_agc;
+
+// Uplink hand-off: the encode stage writes Opus packets straight into a
+// lock-free ring and wakes the WebRTC task, which sends them, so SRTP and
+// the socket send run on the network core
+static PacketRing uplink_ring;
+static uint16_t uplink_lengths[UPLINK_RING_SLOTS];
+static int64_t uplink_captured[UPLINK_RING_SLOTS];  // First frame, 0: pre-roll
+static int64_t uplink_encoded[UPLINK_RING_SLOTS];   // opus_encode returned
+static std::atomic<bool> uplink_active(false);      // Session connected
+static TaskHandle_t uplink_sender = NULL;           // WebRTC task to wake
+
+// Echo canceller between the speaker (reference) and the microphone
+static Aec aec;
+static bool aec_ready = false;
+
+// Noise suppressor after the echo canceller, before the VAD sees the frame
+static NoiseSuppressor noise_suppressor;
+static DspChain noise_chain;
+static DspStage* noise_stage = NULL;  // NULL when it could not be set up
+static std::atomic<bool> noise_requested(AUDIO_NOISE_SUPPRESSION);
+static opus_int16 clean_frame[FRAME_SAMPLES];  // Echo and noise removed
+
+// Wake-word gate: while armed, clean frames feed the keyword spotter and
+// the pre-roll FIFO instead of the encoder. After a detection the FIFO is
+// drained into the encoder, live frames queueing behind it until it has
+// caught up
+static Kws wake_kws;
+static bool wake_ready = false;                  // Gate built and set up
+static bool wake_armed = true;                   // Muted, listening
+static opus_int16* wake_frames = NULL;           // MEM_PSRAM, pre-roll FIFO
+static int64_t wake_times[WAKE_PREROLL_FRAMES];  // Capture time per frame
+static size_t wake_head = 0;                     // Oldest frame in the FIFO
+static size_t wake_count = 0;                    // Frames in the FIFO
+static int64_t wake_heard_us = 0;  // Last speech either way
+static uint32_t wake_playout = 0;  // playout_voiced at wake_heard_us
 
-// Initialize I2S drivers for audio input (INMP441) and output (MAX98357A)
+// Initialize the audio I/O backend (I2S on target, files on Linux)
 void init_audio_capture() {
-  // Configure I2S output for MAX98357A amplifier
-  i2s_config_t i2s_config_out = {
-      .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
-      .sample_rate = SAMPLE_RATE,
-      .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-      .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,  // Stereo output
-      .communication_format = I2S_COMM_FORMAT_I2S_MSB,
-      .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-      .dma_buf_count = 8,             // Number of DMA buffers
-      .dma_buf_len = BUFFER_SAMPLES,  // Samples per DMA buffer
-      .use_apll = 1,                  // Use APLL for better quality
-      .tx_desc_auto_clear = true,     // Auto-clear DMA buffers
-  };
-  if (i2s_driver_install(I2S_NUM_0, &i2s_config_out, 0, NULL) != ESP_OK) {
-    printf("Failed to configure I2S driver for audio output");
-    return;
-  }
-
-  // Set up output pins for MAX98357A
-  i2s_pin_config_t pin_config_out = {
-      .mck_io_num = MCLK_PIN,
-      .bck_io_num = DAC_BCLK_PIN,
-      .ws_io_num = DAC_LRCLK_PIN,
-      .data_out_num = DAC_DATA_PIN,
-      .data_in_num = I2S_PIN_NO_CHANGE,
-  };
-  if (i2s_set_pin(I2S_NUM_0, &pin_config_out) != ESP_OK) {
-    printf("Failed to set I2S pins for audio output");
-    return;
-  }
-  i2s_zero_dma_buffer(I2S_NUM_0);  // Clear output buffer
-
-  // Configure I2S input for INMP441 microphone
-  i2s_config_t i2s_config_in = {
-      .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-      .sample_rate = SAMPLE_RATE,
-      .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-      .channel_format =
-          I2S_CHANNEL_FMT_ONLY_LEFT,  // Mono input from mic (one channel input
-                                      // only for inmp441)
-      .communication_format = I2S_COMM_FORMAT_I2S_MSB,
-      .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-      .dma_buf_count = 8,  // Optimized buffer count
-      .dma_buf_len = BUFFER_SAMPLES,
-      .use_apll = 1,
-      .fixed_mclk = 0};
-  if (i2s_driver_install(I2S_NUM_1, &i2s_config_in, 0, NULL) != ESP_OK) {
-    printf("Failed to configure I2S driver for audio input");
-    return;
-  }
-
-  // Set up input pins for INMP441
-  i2s_pin_config_t pin_config_in = {
-      .mck_io_num = MCLK_PIN,
-      .bck_io_num = ADC_BCLK_PIN,
-      .ws_io_num = ADC_LRCLK_PIN,
-      .data_out_num = I2S_PIN_NO_CHANGE,
-      .data_in_num = ADC_DATA_PIN,
-  };
-  if (i2s_set_pin(I2S_NUM_1, &pin_config_in) != ESP_OK) {
-    printf("Failed to set I2S pins for audio input");
-    return;
-  }
-}
-
-// Buffers and decoder for audio output
-opus_int16* output_buffer = NULL;
-OpusDecoder* opus_decoder = NULL;
-
-// Initialize Opus decoder for incoming audio
+  if (!audio_io_init(AUDIO_IO_RATE, IO_FRAME_SAMPLES)) {
+    printf("Failed to initialize audio I/O");
+    return;
+  }
+
+  capture_storage = (opus_int16*)mem_alloc(
+      MEM_DMA, CAPTURE_RING_SLOTS * FRAME_SAMPLES * sizeof(opus_int16));
+  if (capture_storage == NULL) {
+    printf("Failed to allocate capture ring");
+    return;
+  }
+  frame_ring_init(&capture_ring, capture_storage, CAPTURE_RING_SLOTS,
+                  FRAME_SAMPLES);
+
+  if (!resample_init(&capture_resampler, AUDIO_IO_RATE, SAMPLE_RATE,
+                     AUDIO_RESAMPLE_QUALITY, IO_FRAME_SAMPLES)) {
+    printf("Failed to set up capture resampler");
+    return;
+  }
+  if (capture_resampler.taps > 0) {
+    capture_io = (opus_int16*)mem_alloc(
+        MEM_DMA, IO_FRAME_SAMPLES * sizeof(opus_int16));
+    if (capture_io == NULL) {
+      printf("Failed to allocate capture frame");
+      return;
+    }
+  }
+
+  dsp_highpass_init(&capture_highpass, SAMPLE_RATE, DSP_HIGHPASS_CUTOFF);
+  dsp_chain_init(&capture_chain);
+  dsp_chain_add(&capture_chain, "highpass", dsp_highpass_process,
+                &capture_highpass);
+
+  aec_ready = aec_init(&aec, SAMPLE_RATE, FRAME_SAMPLES);
+  if (!aec_ready) {
+    printf("Failed to allocate echo canceller, sending raw microphone");
+  }
+
+  dsp_chain_init(&noise_chain);
+  if (ns_init(&noise_suppressor, FRAME_SAMPLES)) {
+    noise_stage =
+        dsp_chain_add(&noise_chain, "ns", ns_process, &noise_suppressor);
+  } else {
+    printf("Failed to set up noise suppressor");
+  }
+}
+
+// Capture stage: wakes every time the backend delivers a frame (I2S RX DMA
+// completion on target), converts it to the codec rate into the ring and
+// wakes the encode stage
+static void audio_capture_task(void* user_data) {
+  while (1) {
+    opus_int16* slot = frame_ring_acquire(&capture_ring);
+    bool full = slot == NULL;
+    if (full) {
+      slot = capture_discard;  // Encoder is behind: capture and drop
+    }
+
+    // Resampled and filtered even when dropped, so filter history stays
+    // continuous
+    uint32_t dropped = 0;
+    if (capture_io == NULL) {
+      audio_io_read_frame(slot, &dropped);
+    } else {
+      audio_io_read_frame(capture_io, &dropped);
+      resample_process(&capture_resampler, capture_io, IO_FRAME_SAMPLES,
+                       slot);
+    }
+    dsp_chain_process(&capture_chain, slot, FRAME_SAMPLES);
+    if (full) {
+      dropped++;
+    }
+    if (dropped > 0) {
+      capture_ring.overruns.fetch_add(dropped, std::memory_order_relaxed);
+    }
+    if (full) {
+      continue;
+    }
+
+    capture_times[frame_ring_index(&capture_ring, slot)] = esp_timer_get_time();
+    frame_ring_commit(&capture_ring);
+    capture_frames++;
+    xTaskNotifyGive(capture_consumer);
+  }
+}
+
+// Start the capture stage; the calling task becomes the frame consumer
+void start_audio_capture() {
+  capture_consumer = xTaskGetCurrentTaskHandle();
+  audio_io_start_capture();
+  sched_start(SCHED_CAPTURE, audio_capture_task, NULL);
+}
+
+// Snapshot of capture pipeline counters
+void audio_capture_stats(AudioCaptureStats* stats) {
+  stats->frames = capture_frames;
+  stats->depth = frame_ring_depth(&capture_ring);
+  stats->overruns = capture_ring.overruns.load(std::memory_order_relaxed);
+  stats->underruns = capture_ring.underruns.load(std::memory_order_relaxed);
+}
+
+// Buffers and decoder for audio output. The decoder runs mono (the
+// MAX98357A plays one channel) and the samples are only widened to the
+// stereo I2S frame on the way to the DMA
+opus_int16* playout_pcm = NULL;    // MEM_INTERNAL, decoded mono packet
+opus_int16* output_buffer = NULL;  // MEM_DMA, written to the speaker
+OpusDecoder* opus_decoder = NULL;  // MEM_INTERNAL
+static Resampler playout_resampler;    // SAMPLE_RATE to the I2S rate
+static opus_int16* playout_io = NULL;  // MEM_INTERNAL, packet at I2S rate
+
+// Receive path state: the network thread inserts into the jitter buffer and
+// the playout task drains it at the speaker DMA rate
+static JitterBuffer jitter_buffer;
+static SemaphoreHandle_t jitter_lock = NULL;
+static TaskHandle_t playout_task = NULL;
+static uint8_t playout_packet[JITTER_BUFFER_MAX_PACKET];
+static std::atomic<bool> playout_reset(false);  // New session: reset decoder
+static AudioPlayoutStats playout_stats;         // Written by the playout task
+
+// Decoded frames louder than WAKE_PLAYOUT_LEVEL, read by the encode task
+static std::atomic<uint32_t> playout_voiced(0);
+
+// Samples to synthesize for a lost packet: the duration of the last packet
+// decoded (concealment and FEC must match the missing packet's duration)
+static int playout_lost_samples() {
+  opus_int32 samples = 0;
+  opus_decoder_ctl(opus_decoder, OPUS_GET_LAST_PACKET_DURATION(&samples));
+  if (samples <= 0 || samples > PLAYOUT_MAX_SAMPLES) {
+    return FRAME_SAMPLES;
+  }
+  return samples;
+}
+
+// Decode one packet from the jitter buffer (or conceal it) into playout_pcm
+// Returns decoded mono samples, or 0 when there is nothing to play
+// arrival_us: arrival time of the decoded packet, 0 for concealed frames
+static int playout_decode_frame(int64_t* arrival_us) {
+  size_t size = 0;
+  xSemaphoreTake(jitter_lock, portMAX_DELAY);
+  JitterBufferResult result =
+      jitter_buffer_pop(&jitter_buffer, playout_packet, &size, arrival_us);
+  xSemaphoreGive(jitter_lock);
+
+  switch (result) {
+    case JITTER_BUFFER_PACKET: {
+      // Decode exactly the packet's duration, 2.5 to 120ms
+      int samples =
+          opus_packet_get_nb_samples(playout_packet, size, SAMPLE_RATE);
+      if (samples <= 0 || samples > PLAYOUT_MAX_SAMPLES) {
+        playout_stats.invalid++;
+        *arrival_us = 0;
+        return opus_decode(opus_decoder, NULL, 0, playout_pcm,
+                           playout_lost_samples(), 0);
+      }
+      int64_t start = esp_timer_get_time();
+      int decoded = opus_decode(opus_decoder, playout_packet, size,
+                                playout_pcm, samples, 0);
+      latency_record(LATENCY_DECODE, esp_timer_get_time() - start);
+      return decoded;
+    }
+    case JITTER_BUFFER_LOST:
+      if (size > 0) {
+        // Recover the missing frame from the next packet's in-band FEC
+        return opus_decode(opus_decoder, playout_packet, size, playout_pcm,
+                           playout_lost_samples(), 1);
+      }
+      // Packet loss concealment
+      return opus_decode(opus_decoder, NULL, 0, playout_pcm,
+                         playout_lost_samples(), 0);
+    case JITTER_BUFFER_EMPTY:
+    default:
+      return 0;
+  }
+}
+
+// Playout task: owns the speaker, paced by i2s_write blocking on the DMA
+static void audio_playout_task(void* user_data) {
+  uint32_t frames = 0;
+  bool playing = false;        // Last round wrote audio
+  int64_t speaker_end_us = 0;  // When the audio written so far runs out
+
+  while (1) {
+    if (playout_reset.exchange(false)) {
+      opus_decoder_ctl(opus_decoder, OPUS_RESET_STATE);
+      resample_reset(&playout_resampler);
+    }
+    int64_t arrival_us = 0;
+    int64_t decode_start_us = esp_timer_get_time();
+    int decoded = playout_decode_frame(&arrival_us);
+    if (decoded <= 0) {
+      // Buffering: DMA auto-clear plays silence, wait for the next packet
+      playing = false;
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FRAME_DURATION_MS));
+      continue;
+    }
+    int64_t decoded_us = esp_timer_get_time();
+    int64_t duration_us = (int64_t)decoded * 1000000 / SAMPLE_RATE;
+    deadline_record(DEADLINE_DECODE, decode_start_us, decode_start_us,
+                    decoded_us, duration_us);
+
+    // A stream that was playing but whose audio ran out before this packet
+    // was ready has left a gap of DMA silence
+    if (playing && decoded_us > speaker_end_us) {
+      playout_stats.underruns++;
+    }
+
+    // Convert to the I2S rate, widen to the I2S frame and write only what
+    // was decoded, blocking at the speaker pace, and hand the mono samples
+    // at the codec rate to the echo canceller as its far-end reference
+    const opus_int16* speaker_pcm = playout_pcm;
+    size_t speaker_samples = decoded;
+    if (playout_io != NULL) {
+      speaker_samples = resample_process(&playout_resampler, playout_pcm,
+                                         decoded, playout_io);
+      speaker_pcm = playout_io;
+    }
+    pcm_mono_to_stereo(speaker_pcm, output_buffer, speaker_samples);
+    audio_io_write(output_buffer, speaker_samples);
+    int64_t played_us = esp_timer_get_time();
+    if (aec_ready) {
+      aec_reference(&aec, playout_pcm, decoded, played_us);
+    }
+    speaker_end_us =
+        (speaker_end_us > decoded_us ? speaker_end_us : decoded_us) +
+        duration_us;
+    playing = true;
+    playout_stats.frames++;
+    playout_stats.samples += decoded;
+#if WAKE_WORD_GATE
+    // Far-end speech keeps the wake-word gate open; comfort noise does not
+    PcmLevel level;
+    pcm_level(playout_pcm, decoded, &level);
+    if (level.rms >= WAKE_PLAYOUT_LEVEL) {
+      playout_voiced.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+
+    if (arrival_us != 0) {
+      latency_record(LATENCY_ARRIVAL_TO_DECODED, decoded_us - arrival_us);
+      latency_record(LATENCY_DECODED_TO_PLAYED, played_us - decoded_us);
+      latency_record(LATENCY_WIRE_TO_SPEAKER, played_us - arrival_us);
+    }
+
+    if (++frames % PLAYOUT_STATS_INTERVAL == 0) {
+      JitterBufferStats stats;
+      audio_playout_stats(&stats);
+      ESP_LOGI(LOG_TAG,
+               "Jitter: depth=%lu target=%lums jitter=%lums late=%lu "
+               "lost=%lu concealed=%lu dropped=%lu rebuffers=%lu",
+               (unsigned long)stats.depth, (unsigned long)stats.target_ms,
+               (unsigned long)stats.jitter_ms, (unsigned long)stats.late,
+               (unsigned long)stats.lost, (unsigned long)stats.concealed,
+               (unsigned long)stats.dropped, (unsigned long)stats.rebuffers);
+
+      AudioPlayoutStats playout;
+      audio_speaker_stats(&playout);
+      ESP_LOGI(LOG_TAG,
+               "Playout: frames=%lu samples=%lu underruns=%lu invalid=%lu",
+               (unsigned long)playout.frames, (unsigned long)playout.samples,
+               (unsigned long)playout.underruns,
+               (unsigned long)playout.invalid);
+    }
+  }
+}
+
+// Initialize Opus decoder, jitter buffer and playout task for incoming audio
 void init_audio_decoder() {
-  int decoder_error = 0;
+  // Decoder state in internal SRAM, mono output
   opus_decoder =
-      opus_decoder_create(SAMPLE_RATE, 2, &decoder_error);  // Stereo output
-  if (decoder_error != OPUS_OK) {
+      (OpusDecoder*)mem_alloc(MEM_INTERNAL, opus_decoder_get_size(1));
+  if (opus_decoder == NULL ||
+      opus_decoder_init(opus_decoder, SAMPLE_RATE, 1) != OPUS_OK) {
     printf("Failed to create OPUS decoder");
     return;
   }
 
-  output_buffer = (opus_int16*)malloc(BUFFER_SAMPLES * sizeof(opus_int16));
+  if (!resample_init(&playout_resampler, SAMPLE_RATE, AUDIO_IO_RATE,
+                     AUDIO_RESAMPLE_QUALITY, PLAYOUT_MAX_SAMPLES)) {
+    printf("Failed to set up playout resampler");
+    return;
+  }
+
+  // Sized for the longest Opus packet, whatever the sender picks
+  size_t io_max = resample_output_max(&playout_resampler, PLAYOUT_MAX_SAMPLES);
+  playout_pcm = (opus_int16*)mem_alloc(
+      MEM_INTERNAL, PLAYOUT_MAX_SAMPLES * sizeof(opus_int16));
+  output_buffer = (opus_int16*)mem_alloc(
+      MEM_DMA, io_max * 2 * sizeof(opus_int16));
+  if (playout_resampler.taps > 0) {
+    playout_io = (opus_int16*)mem_alloc(
+        MEM_INTERNAL, io_max * sizeof(opus_int16));
+  }
+  if (playout_pcm == NULL || output_buffer == NULL ||
+      (playout_resampler.taps > 0 && playout_io == NULL)) {
+    printf("Failed to allocate playout buffers");
+    return;
+  }
+
+  if (!jitter_buffer_init(&jitter_buffer)) {
+    printf("Failed to allocate jitter buffer");
+    return;
+  }
+  jitter_lock = xSemaphoreCreateMutex();
+  sched_start(SCHED_PLAYOUT, audio_playout_task, &playout_task);
+}
+
+// Skip what follows the fixed RTP header in data (CSRC list, header
+// extension) and the padding at its end. False for a malformed packet
+static bool rtp_payload(const uint8_t* rtp, const uint8_t* data, size_t size,
+                        size_t* offset, size_t* length) {
+  if ((rtp[0] >> 6) != 2) {
+    return false;  // Not RTP version 2
+  }
+  size_t skip = (size_t)(rtp[0] & 0x0f) * 4;  // CC: 32-bit CSRCs
+  if (rtp[0] & 0x10) {
+    // X: 16-bit profile, 16-bit length in words, then the extension words
+    if (skip + 4 > size) {
+      return false;
+    }
+    skip += 4 + (size_t)((data[skip + 2] << 8) | data[skip + 3]) * 4;
+  }
+  size_t padding = 0;
+  if ((rtp[0] & 0x20) && size > 0) {
+    padding = data[size - 1];  // P: last byte counts the padding
+  }
+  if (skip + padding > size) {
+    return false;
+  }
+  *offset = skip;
+  *length = size - skip - padding;
+  return true;
 }
 
-// Process incoming audio data and output to MAX98357A
+// Queue an incoming Opus packet for playout (called from the network thread)
+// libpeer strips only the fixed RTP header and hands us a pointer into the
+// same packet buffer: the header sits just before data, and CSRCs, header
+// extension and padding are still part of what it calls the payload
 void audio_decode(uint8_t* data, size_t size) {
-  // Decode Opus audio data to PCM
-  int decoded_size =
-      opus_decode(opus_decoder, data, size, output_buffer, BUFFER_SAMPLES, 0);
+  const uint8_t* rtp = data - RTP_HEADER_SIZE;
+  uint16_t seq = (uint16_t)((rtp[2] << 8) | rtp[3]);
+  uint32_t timestamp = ((uint32_t)rtp[4] << 24) | ((uint32_t)rtp[5] << 16) |
+                       ((uint32_t)rtp[6] << 8) | (uint32_t)rtp[7];
+  size_t offset;
+  size_t length;
+  if (!rtp_payload(rtp, data, size, &offset, &length) || length == 0) {
+    return;
+  }
+
+  // Never blocks on the speaker: only a short copy under the lock
+  xSemaphoreTake(jitter_lock, portMAX_DELAY);
+  jitter_buffer_insert(&jitter_buffer, seq, timestamp, data + offset, length,
+                       esp_timer_get_time());
+  xSemaphoreGive(jitter_lock);
+  xTaskNotifyGive(playout_task);
+}
+
+// Forget the session that was torn down: the encode stage goes back to
+// draining capture, and the next session starts a new RTP stream (sequence
+// numbers, timestamps and decoder history)
+void audio_session_reset() {
+  uplink_active.store(false, std::memory_order_release);
+  xSemaphoreTake(jitter_lock, portMAX_DELAY);
+  jitter_buffer_reset(&jitter_buffer);
+  xSemaphoreGive(jitter_lock);
+  playout_reset.store(true);
+  xTaskNotifyGive(playout_task);
+}
+
+// Snapshot of jitter buffer counters
+void audio_playout_stats(JitterBufferStats* stats) {
+  xSemaphoreTake(jitter_lock, portMAX_DELAY);
+  jitter_buffer_stats(&jitter_buffer, stats);
+  xSemaphoreGive(jitter_lock);
+}
+
+// Snapshot of playout counters (written by the playout task)
+void audio_speaker_stats(AudioPlayoutStats* stats) {
+  *stats = playout_stats;
+}
 
-  if (decoded_size > 0) {
-    // Output decoded audio through I2S
-    size_t bytes_written = 0;
-    i2s_write(I2S_NUM_0, output_buffer, BUFFER_SAMPLES * sizeof(opus_int16),
-              &bytes_written, portMAX_DELAY);
+// Switch noise suppression from any task; applied at the next frame
+void audio_noise_suppression(bool enabled) {
+  noise_requested.store(enabled, std::memory_order_relaxed);
+}
+
+bool audio_noise_suppression_enabled() {
+  return noise_requested.load(std::memory_order_relaxed);
+}
+
+// Snapshot of echo canceller counters (call from the encode task)
+void audio_aec_stats(AecStats* stats) {
+  if (!aec_ready) {
+    memset(stats, 0, sizeof(*stats));
+    return;
   }
+  aec_stats(&aec, stats);
 }
 
 // Buffers and encoder for audio input
-OpusEncoder* opus_encoder = NULL;
-opus_int16* encoder_input_buffer = NULL;
-uint8_t* encoder_output_buffer = NULL;
+OpusEncoder* opus_encoder = NULL;       // MEM_INTERNAL
+uint8_t* encoder_output_buffer = NULL;  // MEM_INTERNAL, packets not sent
+
+// Encode stage state: voice activity gating and send counters
+static Vad vad;
+static bool vad_active = true;      // Speech or hangover: encode every frame
+static uint32_t silent_frames = 0;  // Frames since the VAD reported silence
+static AudioSendStats send_stats;
+static std::atomic<uint32_t> sent_packets(0);  // Counted by the WebRTC task
+static std::atomic<uint32_t> sent_bytes(0);
+static DeadlineGovernor governor;  // Complexity and DSP allowed by CPU load
+
+// Frames collected for the next Opus packet
+static opus_int16 packet_pcm[PACKET_MAX_FRAMES * FRAME_SAMPLES];
+static size_t packet_frames = 0;
+static int64_t packet_captured_us = 0;  // Capture time of the first frame
+static bool packet_timed = false;       // No frame came out of the pre-roll
+static uint8_t dtx_toc = 0;             // Single-frame TOC of the last packet
+static bool dtx_ready = false;          // dtx_toc holds an encoded TOC
+
+// Network adaptation: the controller and the downlink counters its
+// feedback is derived from
+static RateControl rate_control;
+static int64_t rate_feedback_us = 0;  // Time of the last feedback report
+static uint32_t rate_received = 0;    // Downlink packets at that report
+static uint32_t rate_lost = 0;        // Downlink losses at that report
+
+// Push the controller's bitrate and loss resilience into the encoder; the
+// frame duration is applied by encode_audio when it packs frames
+static void apply_rate_settings(const RateSettings* settings) {
+  opus_encoder_ctl(opus_encoder, OPUS_SET_BITRATE(settings->bitrate));
+  opus_encoder_ctl(opus_encoder,
+                   OPUS_SET_PACKET_LOSS_PERC(settings->loss_percent));
+  opus_encoder_ctl(opus_encoder, OPUS_SET_INBAND_FEC(settings->fec ? 1 : 0));
+}
 
 // Initialize Opus encoder for outgoing audio
 void init_audio_encoder() {
-  int encoder_error;
-  // Create mono encoder optimized for voice
-  opus_encoder = opus_encoder_create(SAMPLE_RATE, 1, OPUS_APPLICATION_VOIP,
-                                     &encoder_error);
-  if (encoder_error != OPUS_OK) {
+  // Create mono encoder optimized for voice, state in internal SRAM
+  opus_encoder =
+      (OpusEncoder*)mem_alloc(MEM_INTERNAL, opus_encoder_get_size(1));
+  if (opus_encoder == NULL) {
     printf("Failed to create OPUS encoder");
     return;
   }
@@ -151,36 +603,428 @@ void init_audio_encoder() {
     return;
   }
 
-  // Configure encoder parameters
-  opus_encoder_ctl(opus_encoder,
-                   OPUS_SET_BITRATE(30000));  // Set bitrate for quality
-  opus_encoder_ctl(opus_encoder,
-                   OPUS_SET_COMPLEXITY(0));  // Low complexity for performance
+  // Configure encoder parameters (bitrate, expected loss and FEC start at
+  // the top of the rate controller's ladder, complexity starts low and is
+  // raised by the deadline governor while frames have headroom)
+  rate_control_init(&rate_control, esp_timer_get_time());
+  apply_rate_settings(&rate_control.settings);
+  deadline_governor_init(&governor, OPUS_ENCODER_COMPLEXITY);
+  opus_encoder_ctl(opus_encoder, OPUS_SET_COMPLEXITY(governor.complexity));
   opus_encoder_ctl(opus_encoder,
                    OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE));  // Optimize for voice
-  opus_encoder_ctl(opus_encoder,
-                   OPUS_SET_GAIN(500));  // Apply gain to boost volume
 
-  // Allocate buffers for audio processing
-  encoder_input_buffer =
-      (opus_int16*)malloc(BUFFER_SAMPLES * sizeof(opus_int16));
-  encoder_output_buffer = (uint8_t*)malloc(OPUS_OUT_BUFFER_SIZE);
+  // Encoded packets go straight into the uplink ring (input frames live in
+  // the capture ring); the spare buffer takes packets the ring has no room
+  // for, so the encoder state still advances
+  encoder_output_buffer =
+      (uint8_t*)mem_alloc(MEM_INTERNAL, OPUS_OUT_BUFFER_SIZE);
+  uint8_t* uplink_storage = (uint8_t*)mem_alloc(
+      MEM_INTERNAL, UPLINK_RING_SLOTS * OPUS_OUT_BUFFER_SIZE);
+  if (encoder_output_buffer == NULL || uplink_storage == NULL) {
+    printf("Failed to allocate encoder output");
+    return;
+  }
+  packet_ring_init(&uplink_ring, uplink_storage, uplink_lengths,
+                   UPLINK_RING_SLOTS, OPUS_OUT_BUFFER_SIZE);
+
+  vad_init(&vad);
+
+  // Microphone level is set by the AGC (OPUS_SET_GAIN is a decoder
+  // control; the encoder rejects it)
+  dsp_gate_init(&voice_gate, SAMPLE_RATE, FRAME_SAMPLES);
+  dsp_agc_init(&voice_agc, SAMPLE_RATE, FRAME_SAMPLES);
+  dsp_chain_init(&voice_chain);
+  dsp_chain_add(&voice_chain, "gate", dsp_gate_process, &voice_gate);
+  dsp_chain_add(&voice_chain, "agc", dsp_agc_process, &voice_agc);
+
+#if WAKE_WORD_GATE
+  // The pre-roll is written once per frame and read once per detection
+  wake_frames = (opus_int16*)mem_alloc(
+      MEM_PSRAM, WAKE_PREROLL_FRAMES * FRAME_SAMPLES * sizeof(opus_int16));
+  wake_ready = wake_frames != NULL &&
+               kws_init(&wake_kws, &kws_model, SAMPLE_RATE, FRAME_SAMPLES);
+  if (!wake_ready) {
+    printf("Failed to set up the wake-word gate");
+  }
+#endif
 }
 
-// Capture audio from INMP441, encode, and send through WebRTC
-void send_audio(PeerConnection* peer_connection) {
-  size_t bytes_read = 0;
+// Snapshot of encode/send counters (call from the encode task; packets
+// and bytes are counted by the WebRTC task)
+void audio_send_stats(AudioSendStats* stats) {
+  *stats = send_stats;
+  stats->packets = sent_packets.load(std::memory_order_relaxed);
+  stats->bytes = sent_bytes.load(std::memory_order_relaxed);
+  stats->gated = voice_gate.closed;
+  stats->agc_gain = voice_agc.gain;
+  stats->dropped = uplink_ring.overruns.load(std::memory_order_relaxed);
+}
+
+// Feed the rate controller once per RATE_CONTROL_INTERVAL_MS. libpeer
+// consumes RTCP receiver reports internally without exposing them, so loss
+// and jitter come from the downlink jitter buffer instead: both directions
+// cross the same Wi-Fi hop, which is where congestion shows up first
+static void rate_control_poll(int64_t now_us) {
+  if (jitter_lock == NULL ||
+      now_us - rate_feedback_us < RATE_CONTROL_INTERVAL_MS * 1000LL) {
+    return;
+  }
+  rate_feedback_us = now_us;
+
+  JitterBufferStats stats;
+  audio_playout_stats(&stats);
+  if (stats.received < rate_received || stats.lost < rate_lost) {
+    // Jitter buffer reset for a new session: count from zero again
+    rate_received = stats.received;
+    rate_lost = stats.lost;
+    return;
+  }
+  uint32_t received = stats.received - rate_received;
+  uint32_t lost = stats.lost - rate_lost;
+  rate_received = stats.received;
+  rate_lost = stats.lost;
+  if (received + lost == 0) {
+    return;  // Far end silent: no evidence either way
+  }
+
+  RateFeedback feedback;
+  uint32_t fraction = lost * 256 / (received + lost);
+  feedback.fraction_lost = (uint8_t)(fraction > 255 ? 255 : fraction);
+  feedback.rtt_ms = 0;
+  feedback.jitter_ms = stats.jitter_ms;
+  if (rate_control_update(&rate_control, &feedback, now_us)) {
+    const RateSettings* settings = &rate_control.settings;
+    apply_rate_settings(settings);
+    ESP_LOGI(LOG_TAG, "Rate: bitrate=%lu frame=%lums loss=%lu%% fec=%d",
+             (unsigned long)settings->bitrate,
+             (unsigned long)settings->frame_ms,
+             (unsigned long)settings->loss_percent, settings->fec ? 1 : 0);
+  }
+}
+
+// Check the encode path against the frame deadline; once per window the
+// governor trades encoder complexity and the echo canceller for headroom
+static void encode_deadline(int64_t captured_us, int64_t start_us,
+                            size_t frames) {
+  int64_t budget_us =
+      (int64_t)(frames > 0 ? frames : 1) * FRAME_DURATION_MS * 1000;
+  if (!deadline_record(DEADLINE_ENCODE, captured_us, start_us,
+                       esp_timer_get_time(), budget_us)) {
+    return;
+  }
+
+  DeadlineStats stats;
+  deadline_stats(DEADLINE_ENCODE, &stats);
+  bool dsp_enabled = governor.dsp_enabled;
+  if (!deadline_governor_update(&governor, &stats)) {
+    return;
+  }
+  opus_encoder_ctl(opus_encoder, OPUS_SET_COMPLEXITY(governor.complexity));
+  if (governor.dsp_enabled && !dsp_enabled && aec_ready) {
+    aec_reset(&aec);  // Reference queue and echo path went stale meanwhile
+  }
+  if (governor.dsp_enabled && !dsp_enabled && noise_stage != NULL) {
+    ns_reset(&noise_suppressor);
+  }
+  ESP_LOGI(LOG_TAG,
+           "Governor: complexity=%d aec=%d load=%lu%% peak=%lu%% misses=%lu",
+           governor.complexity, governor.dsp_enabled ? 1 : 0,
+           (unsigned long)stats.load_percent,
+           (unsigned long)stats.peak_percent,
+           (unsigned long)stats.window_misses);
+}
 
-  // Read audio data from I2S
-  i2s_read(I2S_NUM_1, encoder_input_buffer, BUFFER_SAMPLES, &bytes_read,
-           portMAX_DELAY);
+// Add one frame to the current Opus packet (gate and AGC applied)
+// timed: false for pre-roll frames, which keep the packet out of the
+// latency figures
+static void encode_pack(const opus_int16* pcm, int64_t captured_us,
+                        bool timed) {
+  if (packet_frames == 0) {
+    packet_captured_us = captured_us;
+    packet_timed = true;
+  }
+  packet_timed = packet_timed && timed;
+  opus_int16* packet_frame = packet_pcm + packet_frames * FRAME_SAMPLES;
+  memcpy(packet_frame, pcm, FRAME_SAMPLES * sizeof(opus_int16));
+  dsp_chain_process(&voice_chain, packet_frame, FRAME_SAMPLES);
+  packet_frames++;
+}
+
+// Encode the packet into the uplink ring once it is complete. Speech waits
+// until the packet holds the controller's frame duration; comfort noise
+// and frames left over when speech ends go out at once. Frames encoded
+// out of the wake-word pre-roll (timed false) are kept out of the latency
+// and deadline figures: their capture times are up to WAKE_PREROLL_MS old
+static void encode_packet(int64_t captured_us, int64_t start_us, bool active,
+                          bool skip, bool timed) {
+  size_t target_frames =
+      active ? rate_control.settings.frame_ms / FRAME_DURATION_MS : 1;
+  if (packet_frames == 0 || (!skip && packet_frames < target_frames)) {
+    if (timed) {
+      encode_deadline(captured_us, start_us, 1);
+    }
+    return;
+  }
 
-  // Encode audio data using Opus
+  // Encode audio data using Opus, into the uplink ring when it has room
+  uint8_t* packet = packet_ring_acquire(&uplink_ring);
+  bool full = packet == NULL;
+  if (full) {
+    packet = encoder_output_buffer;  // Network task is behind: drop it
+  }
+  int64_t encode_start_us = esp_timer_get_time();
   auto encoded_size =
-      opus_encode(opus_encoder, encoder_input_buffer, BUFFER_SAMPLES / 2,
-                  encoder_output_buffer, OPUS_OUT_BUFFER_SIZE);
+      opus_encode(opus_encoder, packet_pcm, packet_frames * FRAME_SAMPLES,
+                  packet, OPUS_OUT_BUFFER_SIZE);
+  int64_t encoded_us = esp_timer_get_time();
+  size_t frames = packet_frames;
+  send_stats.encoded += frames;
+  send_stats.encode_us += encoded_us - encode_start_us;
+  packet_frames = 0;
 
-  // Send encoded audio through WebRTC
-  peer_connection_send_audio(peer_connection, encoder_output_buffer,
-                             encoded_size);
+  // Hand the packet to the WebRTC task (no capture time for pre-roll);
+  // Opus DTX packets of a byte or two are sent too, they keep the RTP
+  // timeline whole
+  if (encoded_size > 0) {
+    dtx_toc = packet[0] & 0xfc;  // Same configuration, code 0: one frame
+    dtx_ready = true;
+    if (full) {
+      uplink_ring.overruns.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      uint32_t slot = packet_ring_index(&uplink_ring, packet);
+      uplink_captured[slot] = packet_timed ? packet_captured_us : 0;
+      uplink_encoded[slot] = encoded_us;
+      packet_ring_commit(&uplink_ring, encoded_size);
+      xTaskNotifyGive(uplink_sender);
+    }
+  }
+
+  latency_record(LATENCY_ENCODE, encoded_us - encode_start_us);
+  if (packet_timed) {
+    latency_record(LATENCY_CAPTURE_TO_ENCODED,
+                   encoded_us - packet_captured_us);
+  }
+  if (timed) {
+    encode_deadline(captured_us, start_us, frames);
+  }
+}
+
+// Queue a TOC-only packet for a silent frame that was not encoded: a
+// zero-length frame, which the far end decodes as DTX. Every 20ms of capture
+// thus leaves as one RTP packet, matching libpeer's fixed timestamp step
+static void encode_dtx() {
+  uint8_t* packet = packet_ring_acquire(&uplink_ring);
+  if (packet == NULL) {
+    uplink_ring.overruns.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  uint32_t slot = packet_ring_index(&uplink_ring, packet);
+  packet[0] = dtx_toc;
+  uplink_captured[slot] = 0;  // Nothing was encoded: no latency to report
+  uplink_encoded[slot] = esp_timer_get_time();
+  packet_ring_commit(&uplink_ring, 1);
+  xTaskNotifyGive(uplink_sender);
+}
+
+// Mute the uplink until the next wake word
+static void wake_arm() {
+  wake_armed = true;
+  wake_head = 0;
+  wake_count = 0;
+  packet_frames = 0;
+  kws_reset(&wake_kws);
+}
+
+// Append a frame to the pre-roll FIFO; when full the oldest ages out
+static void wake_push(const opus_int16* pcm, int64_t captured_us) {
+  size_t slot = (wake_head + wake_count) % WAKE_PREROLL_FRAMES;
+  if (wake_count == WAKE_PREROLL_FRAMES) {
+    wake_head = (wake_head + 1) % WAKE_PREROLL_FRAMES;
+  } else {
+    wake_count++;
+  }
+  memcpy(wake_frames + slot * FRAME_SAMPLES, pcm,
+         FRAME_SAMPLES * sizeof(opus_int16));
+  wake_times[slot] = captured_us;
+}
+
+// Encode the oldest FIFO frame as speech, waiting for the WebRTC task
+// while the uplink ring is full so the burst is not dropped
+static void wake_flush(int64_t start_us) {
+  if (packet_ring_depth(&uplink_ring) == UPLINK_RING_SLOTS) {
+    vTaskDelay(1);
+    return;
+  }
+  const opus_int16* pcm = wake_frames + wake_head * FRAME_SAMPLES;
+  int64_t captured_us = wake_times[wake_head];
+  encode_pack(pcm, captured_us, false);
+  wake_head = (wake_head + 1) % WAKE_PREROLL_FRAMES;
+  wake_count--;
+  encode_packet(captured_us, start_us, true, false, false);
+}
+
+// Route a clean frame through the gate; true when the gate took it (muted
+// while armed, queued behind the pre-roll while it drains). Speech either
+// way keeps the gate open; WAKE_IDLE_MS without it arms the gate again
+static bool wake_listen(const opus_int16* pcm, int64_t captured_us,
+                        bool active) {
+  if (!wake_armed) {
+    uint32_t playout = playout_voiced.load(std::memory_order_relaxed);
+    if (active || playout != wake_playout) {
+      wake_heard_us = captured_us;
+      wake_playout = playout;
+    } else if (captured_us - wake_heard_us > WAKE_IDLE_MS * 1000LL) {
+      ESP_LOGI(LOG_TAG, "Wake word: idle, uplink muted");
+      wake_arm();
+    }
+  }
+  if (!wake_armed) {
+    if (wake_count == 0) {
+      return false;
+    }
+    wake_push(pcm, captured_us);
+    return true;
+  }
+
+  wake_push(pcm, captured_us);
+  send_stats.muted++;
+  if (!kws_process(&wake_kws, pcm)) {
+    return true;
+  }
+  ESP_LOGI(LOG_TAG, "Wake word: \"%s\" heard, sending %lums of pre-roll",
+           kws_model.keyword,
+           (unsigned long)(wake_count * FRAME_DURATION_MS));
+  send_stats.wakes++;
+  wake_armed = false;
+  wake_heard_us = captured_us;
+  wake_playout = playout_voiced.load(std::memory_order_relaxed);
+
+  // The pre-roll is sent as speech: no DTX until the VAD says otherwise
+  vad_active = true;
+  silent_frames = 0;
+  opus_encoder_ctl(opus_encoder, OPUS_SET_DTX(0));
+  return true;
+}
+
+// Encode stage: block until the capture stage has a full frame, pack it into
+// the current Opus packet and encode the packet into the uplink ring once it
+// is complete (silent frames are mostly skipped; with the wake-word gate,
+// nothing is encoded until the wake word is heard)
+void encode_audio() {
+  const opus_int16* frame = frame_ring_peek(&capture_ring);
+  if (frame == NULL) {
+    if (wake_count > 0 && !wake_armed) {
+      wake_flush(esp_timer_get_time());  // Catch up between frames
+      return;
+    }
+    // Two frame periods without a frame means capture stalled
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FRAME_DURATION_MS * 2)) == 0) {
+      capture_ring.underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    return;
+  }
+  if (!uplink_active.load(std::memory_order_acquire)) {
+    // Between sessions: keep the ring drained so the next session starts
+    // with fresh audio, and drop any partly collected packet
+    frame_ring_pop(&capture_ring);
+    packet_frames = 0;
+    if (wake_ready && (!wake_armed || wake_count > 0)) {
+      wake_arm();  // Every session starts muted
+    }
+    return;
+  }
+
+  int64_t captured_us = capture_times[frame_ring_index(&capture_ring, frame)];
+  int64_t start_us = esp_timer_get_time();
+
+  // Remove speaker echo, then background noise, before the VAD and the
+  // encoder (both shed first under CPU overload)
+  const opus_int16* pcm = frame;
+  if (governor.dsp_enabled) {
+    if (aec_ready) {
+      aec_process(&aec, frame, clean_frame, captured_us);
+    } else {
+      memcpy(clean_frame, frame, FRAME_SAMPLES * sizeof(opus_int16));
+    }
+    if (noise_stage != NULL) {
+      bool enabled = noise_requested.load(std::memory_order_relaxed);
+      if (enabled && !noise_stage->enabled) {
+        ns_reset(&noise_suppressor);  // Tracked noise is stale
+      }
+      noise_stage->enabled = enabled;
+    }
+    dsp_chain_process(&noise_chain, clean_frame, FRAME_SAMPLES);
+    pcm = clean_frame;
+  }
+
+  // Voice activity decides whether the frame is worth encoding. DTX is
+  // only enabled in silence so Opus never drops quiet speech on its own
+  bool active = vad_process(&vad, pcm, FRAME_SAMPLES);
+  if (active != vad_active) {
+    vad_active = active;
+    silent_frames = 0;
+    opus_encoder_ctl(opus_encoder, OPUS_SET_DTX(active ? 0 : 1));
+  }
+  send_stats.frames++;
+
+  if (wake_ready && wake_listen(pcm, captured_us, active)) {
+    frame_ring_pop(&capture_ring);
+    if (wake_armed) {
+      encode_deadline(captured_us, start_us, 1);
+    } else {
+      wake_flush(start_us);
+    }
+    return;
+  }
+
+  bool skip = !active && dtx_ready &&
+              silent_frames++ % COMFORT_NOISE_INTERVAL != 0;
+  if (skip) {
+    // Track levels on a throwaway copy (clean_frame is free after the VAD)
+    send_stats.skipped++;
+    if (pcm != clean_frame) {
+      memcpy(clean_frame, pcm, FRAME_SAMPLES * sizeof(opus_int16));
+    }
+    dsp_chain_process(&voice_chain, clean_frame, FRAME_SAMPLES);
+  } else {
+    encode_pack(pcm, captured_us, true);
+  }
+  frame_ring_pop(&capture_ring);
+
+  rate_control_poll(esp_timer_get_time());
+  encode_packet(captured_us, start_us, active, skip, true);
+  if (skip) {
+    encode_dtx();  // After any speech frames the skip flushed
+  }
+}
+
+// Start taking encoded audio for a connected session; the calling task
+// (the WebRTC task) is woken for every packet and sends it with send_audio
+void audio_uplink_start() {
+  uplink_sender = xTaskGetCurrentTaskHandle();
+  uplink_active.store(true, std::memory_order_release);
+}
+
+// Network stage: send every packet the encode stage has queued, from the
+// WebRTC task's loop. Packets encoded while no session is connected (the
+// last one of a closing session) are dropped
+void send_audio(PeerConnection* peer_connection) {
+  size_t length;
+  const uint8_t* packet;
+  while ((packet = packet_ring_peek(&uplink_ring, &length)) != NULL) {
+    if (!uplink_active.load(std::memory_order_acquire)) {
+      packet_ring_pop(&uplink_ring);
+      continue;
+    }
+    uint32_t slot = packet_ring_index(&uplink_ring, packet);
+    peer_connection_send_audio(peer_connection, packet, length);
+    int64_t sent_us = esp_timer_get_time();
+    sent_packets.fetch_add(1, std::memory_order_relaxed);
+    sent_bytes.fetch_add(length, std::memory_order_relaxed);
+    latency_record(LATENCY_ENCODED_TO_SENT, sent_us - uplink_encoded[slot]);
+    if (uplink_captured[slot] != 0) {
+      latency_record(LATENCY_MOUTH_TO_WIRE, sent_us - uplink_captured[slot]);
+    }
+    packet_ring_pop(&uplink_ring);
+  }
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "mem.h"
+
+#include <freertos/semphr.h>
+#include <sdkconfig.h>
+#include <stdlib.h>
+#include <string.h>
+#if !CONFIG_IDF_TARGET_LINUX
+#include <esp_heap_caps.h>
+#endif
+
+#define MEM_ROUND(size) (((size) + MEM_ALIGN - 1) & ~(size_t)(MEM_ALIGN - 1))
+
+// Chunk currently being carved for one region
+typedef struct {
+  uint8_t* chunk;
+  size_t offset;
+  size_t size;
+} MemArena;
+
+typedef struct {
+  TaskHandle_t handle;
+  const char* name;
+  MemRegion region;
+  uint32_t stack_size;
+} MemTask;
+
+static MemArena arenas[MEM_REGION_COUNT];
+static MemStats stats[MEM_REGION_COUNT];
+static MemTask tasks[MEM_MAX_TASKS];
+static size_t task_count = 0;
+static SemaphoreHandle_t mem_lock = NULL;
+
+static const char* region_names[MEM_REGION_COUNT] = {"dma", "internal",
+                                                     "psram"};
+
+#if !CONFIG_IDF_TARGET_LINUX
+static uint32_t mem_caps(MemRegion region) {
+  switch (region) {
+    case MEM_DMA:
+      return MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    case MEM_PSRAM:
+#if CONFIG_SPIRAM
+      return MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+#endif
+    default:
+      return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+  }
+}
+#endif
+
+// Aligned block straight from the heap, internal SRAM if region is full
+static void* mem_heap(MemRegion region, size_t size) {
+#if CONFIG_IDF_TARGET_LINUX
+  return aligned_alloc(MEM_ALIGN, MEM_ROUND(size));
+#else
+  void* block = heap_caps_aligned_alloc(MEM_ALIGN, size, mem_caps(region));
+  if (block == NULL && region != MEM_INTERNAL) {
+    block = heap_caps_aligned_alloc(MEM_ALIGN, size,
+                                    mem_caps(MEM_INTERNAL));
+    if (block != NULL) {
+      stats[region].fallbacks++;
+    }
+  }
+  return block;
+#endif
+}
+
+void mem_init() {
+  mem_lock = xSemaphoreCreateMutex();
+}
+
+void* mem_alloc(MemRegion region, size_t size) {
+  size = MEM_ROUND(size);
+  xSemaphoreTake(mem_lock, portMAX_DELAY);
+  MemArena* arena = &arenas[region];
+  uint8_t* block = NULL;
+  if (arena->chunk != NULL && arena->offset + size <= arena->size) {
+    block = arena->chunk + arena->offset;
+    arena->offset += size;
+  } else if (size > MEM_ARENA_CHUNK / 2) {
+    // Large enough to get its own block; the current chunk stays open
+    block = (uint8_t*)mem_heap(region, size);
+    if (block != NULL) {
+      stats[region].reserved += size;
+    }
+  } else {
+    // Start a new chunk, leaving the tail of the old one unused
+    uint8_t* chunk = (uint8_t*)mem_heap(region, MEM_ARENA_CHUNK);
+    if (chunk != NULL) {
+      arena->chunk = chunk;
+      arena->size = MEM_ARENA_CHUNK;
+      arena->offset = size;
+      stats[region].reserved += MEM_ARENA_CHUNK;
+      block = chunk;
+    }
+  }
+  if (block != NULL) {
+    stats[region].allocations++;
+    stats[region].used += size;
+  }
+  xSemaphoreGive(mem_lock);
+
+  if (block != NULL) {
+    memset(block, 0, size);
+  }
+  return block;
+}
+
+void mem_task_track(TaskHandle_t handle, const char* name, uint32_t stack,
+                    MemRegion region) {
+  xSemaphoreTake(mem_lock, portMAX_DELAY);
+  if (task_count < MEM_MAX_TASKS) {
+    MemTask* task = &tasks[task_count++];
+    task->handle = handle;
+    task->name = name;
+    task->region = region;
+    task->stack_size = stack;
+  }
+  xSemaphoreGive(mem_lock);
+}
+
+bool mem_task_create(TaskFunction_t fn, const char* name, uint32_t stack,
+                     void* arg, UBaseType_t priority, TaskHandle_t* handle,
+                     int core, MemRegion region) {
+  // The task control block has to be in internal SRAM wherever the stack is
+  StackType_t* stack_memory = (StackType_t*)mem_alloc(region, stack);
+  StaticTask_t* tcb = (StaticTask_t*)mem_alloc(MEM_INTERNAL,
+                                               sizeof(StaticTask_t));
+  if (stack_memory == NULL || tcb == NULL) {
+    return false;
+  }
+  TaskHandle_t task = xTaskCreateStaticPinnedToCore(
+      fn, name, stack, arg, priority, stack_memory, tcb, core);
+  if (task == NULL) {
+    return false;
+  }
+  if (handle != NULL) {
+    *handle = task;
+  }
+  mem_task_track(task, name, stack, region);
+  return true;
+}
+
+const char* mem_region_name(MemRegion region) {
+  return region_names[region];
+}
+
+void mem_region_stats(MemRegion region, MemStats* out) {
+  xSemaphoreTake(mem_lock, portMAX_DELAY);
+  *out = stats[region];
+  xSemaphoreGive(mem_lock);
+#if !CONFIG_IDF_TARGET_LINUX
+  uint32_t caps = mem_caps(region);
+  out->heap_free = heap_caps_get_free_size(caps);
+  out->heap_min_free = heap_caps_get_minimum_free_size(caps);
+  out->heap_largest = heap_caps_get_largest_free_block(caps);
+#endif
+}
+
+size_t mem_task_stats(MemTaskStats* out, size_t max) {
+  xSemaphoreTake(mem_lock, portMAX_DELAY);
+  size_t count = task_count < max ? task_count : max;
+  for (size_t i = 0; i < count; i++) {
+    out[i].name = tasks[i].name;
+    out[i].region = tasks[i].region;
+    out[i].stack_size = tasks[i].stack_size;
+#if CONFIG_IDF_TARGET_LINUX
+    out[i].stack_min_free = 0;  // Host threads have their own stacks
+#else
+    out[i].stack_min_free = uxTaskGetStackHighWaterMark(tasks[i].handle);
+#endif
+  }
+  xSemaphoreGive(mem_lock);
+  return count;
+}
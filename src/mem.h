@@ -0,0 +1,66 @@
+#ifndef MEM_H
+#define MEM_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Placement of the media path's long-lived memory. Every buffer, codec state
+// and task stack is tagged with the region it has to live in and carved from
+// a per-region arena: chunks are taken from the heap with the region's caps
+// and handed out in aligned pieces that are never freed. PSRAM accesses that
+// miss the cache are several times slower than internal SRAM and share the
+// bus with DMA, so only cold data goes there
+#define MEM_ARENA_CHUNK 16384  // Bytes taken from the heap at a time
+#define MEM_ALIGN 16           // Alignment of every allocation
+#define MEM_MAX_TASKS 8        // Tasks tracked for stack high-water marks
+
+typedef enum {
+  MEM_DMA,       // DMA-capable internal SRAM: frames I2S reads or writes
+  MEM_INTERNAL,  // Internal SRAM: codec state, filters, hot task stacks
+  MEM_PSRAM,     // PSRAM, internal SRAM without it: cold buffers
+  MEM_REGION_COUNT,
+} MemRegion;
+
+typedef struct {
+  uint32_t allocations;    // mem_alloc calls served
+  uint32_t used;           // Bytes handed out
+  uint32_t reserved;       // Bytes taken from the heap for the arena
+  uint32_t fallbacks;      // Allocations the region could not hold
+  uint32_t heap_free;      // Heap left with the region's caps
+  uint32_t heap_min_free;  // Lowest heap_free since boot
+  uint32_t heap_largest;   // Largest free block with the region's caps
+} MemStats;
+
+typedef struct {
+  const char* name;
+  MemRegion region;         // Where the stack lives
+  uint32_t stack_size;      // Bytes
+  uint32_t stack_min_free;  // Least stack ever left, 0 if unknown
+} MemTaskStats;
+
+// Create the arena lock; call before any other mem_ function
+void mem_init(void);
+
+// Zeroed, MEM_ALIGN-aligned memory in region that lives until reboot. A
+// region that is full (or absent) falls back to internal SRAM and counts a
+// fallback; returns NULL only when no heap is left at all
+void* mem_alloc(MemRegion region, size_t size);
+
+// xTaskCreatePinnedToCore with the stack (in bytes) placed in region
+bool mem_task_create(TaskFunction_t fn, const char* name, uint32_t stack,
+                     void* arg, UBaseType_t priority, TaskHandle_t* handle,
+                     int core, MemRegion region);
+
+// Include a task created elsewhere in the stack report
+void mem_task_track(TaskHandle_t handle, const char* name, uint32_t stack,
+                    MemRegion region);
+
+const char* mem_region_name(MemRegion region);
+void mem_region_stats(MemRegion region, MemStats* stats);
+
+// Stack figures of the tracked tasks, returns how many were written
+size_t mem_task_stats(MemTaskStats* tasks, size_t max);
+
+#endif  // MEM_H
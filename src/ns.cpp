@@ -0,0 +1,184 @@
+#include "ns.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem.h"
+
+#define NS_MAG_SHIFT 8              // Fraction bits of the per-bin magnitudes
+#define NS_MAG_MAX ((1 << 24) - 1)  // Magnitudes stay below 2^24 (Q8 ratios)
+
+static inline int16_t saturate16(int32_t v) {
+  if (v > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (v < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)v;
+}
+
+bool ns_init(NoiseSuppressor* ns, size_t block_samples) {
+  memset(ns, 0, sizeof(*ns));
+  ns->hop = block_samples / 2;
+  size_t size = 2;
+  while (size < ns->hop + ns->hop / 2) {
+    size <<= 1;
+  }
+  ns->overlap = size - ns->hop < ns->hop ? size - ns->hop : ns->hop;
+  if (!fft_init(&ns->fft, size)) {
+    return false;
+  }
+  ns->bins = size / 2 + 1;
+
+  size_t length = ns->hop + ns->overlap;
+  ns->window = (int16_t*)mem_alloc(MEM_INTERNAL, length * sizeof(int16_t));
+  ns->history =
+      (int16_t*)mem_alloc(MEM_INTERNAL, ns->overlap * sizeof(int16_t));
+  ns->tail = (int32_t*)mem_alloc(MEM_INTERNAL, ns->overlap * sizeof(int32_t));
+  ns->spectrum =
+      (FftComplex*)mem_alloc(MEM_INTERNAL, size * sizeof(FftComplex));
+  ns->smoothed =
+      (uint32_t*)mem_alloc(MEM_INTERNAL, ns->bins * sizeof(uint32_t));
+  ns->noise = (uint32_t*)mem_alloc(MEM_INTERNAL, ns->bins * sizeof(uint32_t));
+  ns->clean = (uint32_t*)mem_alloc(MEM_INTERNAL, ns->bins * sizeof(uint32_t));
+  if (ns->window == NULL || ns->history == NULL || ns->tail == NULL ||
+      ns->spectrum == NULL || ns->smoothed == NULL || ns->noise == NULL ||
+      ns->clean == NULL) {
+    return false;
+  }
+
+  // Ramps squared sum to one across the overlap, so analysis and synthesis
+  // with the same window reconstruct the input
+  for (size_t n = 0; n < length; n++) {
+    double w = 1.0;
+    if (n < ns->overlap) {
+      w = sin(M_PI / 2 * (n + 0.5) / ns->overlap);
+    } else if (n >= ns->hop) {
+      w = cos(M_PI / 2 * (n - ns->hop + 0.5) / ns->overlap);
+    }
+    ns->window[n] = (int16_t)fmin(32767.0, lrint(w * 32768));
+  }
+  ns_reset(ns);
+  return true;
+}
+
+void ns_reset(NoiseSuppressor* ns) {
+  memset(ns->history, 0, ns->overlap * sizeof(int16_t));
+  memset(ns->tail, 0, ns->overlap * sizeof(int32_t));
+  memset(ns->clean, 0, ns->bins * sizeof(uint32_t));
+  ns->hops = 0;
+}
+
+// Wiener gain for one bin from its magnitude, updating the bin's trackers
+static int32_t ns_gain(NoiseSuppressor* ns, size_t k, uint32_t magnitude) {
+  // Noise follows the minimum of the smoothed magnitude: down at once, up
+  // by a fraction per hop, so it stays under speech but learns a louder
+  // room within a few seconds. The first hop seeds both
+  if (ns->hops == 0) {
+    ns->smoothed[k] = magnitude;
+    ns->noise[k] = magnitude;
+  }
+  uint32_t smoothed = ns->smoothed[k];
+  smoothed = magnitude > smoothed
+                 ? smoothed + ((magnitude - smoothed) >> NS_SMOOTHING)
+                 : smoothed - ((smoothed - magnitude) >> NS_SMOOTHING);
+  ns->smoothed[k] = smoothed;
+  uint32_t noise = ns->noise[k];
+  if (smoothed < noise) {
+    noise = smoothed;
+  } else {
+    noise += (noise >> NS_NOISE_RISE) + 1;
+    noise = noise < smoothed ? noise : smoothed;
+  }
+  ns->noise[k] = noise;
+
+  // Posterior SNR of this hop and the decision-directed prior, Q8
+  uint32_t floor = noise + 1;
+  uint32_t ratio = (magnitude << 8) / floor;
+  uint32_t previous = (ns->clean[k] << 8) / floor;
+  ratio = ratio < NS_MAX_RATIO ? ratio : NS_MAX_RATIO;
+  previous = previous < NS_MAX_RATIO ? previous : NS_MAX_RATIO;
+  uint32_t posterior = ratio * ratio >> 8;
+  uint32_t excess = posterior > 256 ? posterior - 256 : 0;
+  uint32_t prior = ((previous * previous >> 8) * NS_DD_ALPHA +
+                    excess * (256 - NS_DD_ALPHA)) >>
+                   8;
+
+  // Wiener gain prior / (1 + prior), Q15
+  int32_t gain = 32768 - (int32_t)((1u << 23) / (prior + 256));
+  gain = gain > NS_GAIN_FLOOR ? gain : NS_GAIN_FLOOR;
+  ns->clean[k] = (uint32_t)(((uint64_t)magnitude * gain) >> 15);
+  return gain;
+}
+
+// One hop: analysis window over history + input, gains per bin, synthesis
+// window and overlap-add; writes hop samples delayed by the overlap
+static void ns_hop(NoiseSuppressor* ns, int16_t* pcm) {
+  size_t size = ns->fft.size;
+  size_t hop = ns->hop;
+  size_t overlap = ns->overlap;
+  size_t length = hop + overlap;
+  FftComplex* x = ns->spectrum;
+
+  int32_t peak = 0;
+  for (size_t n = 0; n < length; n++) {
+    int32_t sample = n < overlap ? ns->history[n] : pcm[n - overlap];
+    x[n].re = (sample * ns->window[n]) >> 15;
+    x[n].im = 0;
+    int32_t magnitude = x[n].re < 0 ? -x[n].re : x[n].re;
+    peak = magnitude > peak ? magnitude : peak;
+  }
+  memset(x + length, 0, (size - length) * sizeof(FftComplex));
+  memcpy(ns->history, pcm + hop - overlap, overlap * sizeof(int16_t));
+
+  // Normalize towards the FFT input limit; the shift also converts bin
+  // magnitudes back to the Q8 units the trackers keep across hops
+  int shift = FFT_INPUT_BITS - fft_bits((uint32_t)peak);
+  if (peak == 0) {
+    shift = FFT_INPUT_BITS - 1;
+  }
+  for (size_t n = 0; n < length; n++) {
+    x[n].re *= 1 << shift;
+  }
+  fft_forward(&ns->fft, x);
+
+  for (size_t k = 0; k < ns->bins; k++) {
+    // |X| by alpha max plus beta min (0.961, 0.398; within 4%)
+    uint32_t re = (uint32_t)abs(x[k].re) >> (shift - NS_MAG_SHIFT);
+    uint32_t im = (uint32_t)abs(x[k].im) >> (shift - NS_MAG_SHIFT);
+    uint32_t high = re > im ? re : im;
+    uint32_t low = re > im ? im : re;
+    uint32_t magnitude = (high * 123 + low * 51) >> 7;
+    magnitude = magnitude < NS_MAG_MAX ? magnitude : NS_MAG_MAX;
+    int32_t gain = ns_gain(ns, k, magnitude);
+    x[k].re = (int32_t)(((int64_t)x[k].re * gain) >> 15);
+    x[k].im = (int32_t)(((int64_t)x[k].im * gain) >> 15);
+    if (k > 0 && k < size / 2) {
+      x[size - k].re = x[k].re;
+      x[size - k].im = -x[k].im;
+    }
+  }
+  ns->hops++;
+
+  fft_inverse(&ns->fft, x);
+  int32_t round = 1 << (shift - 1);
+  for (size_t n = 0; n < length; n++) {
+    int32_t y = ((x[n].re + round) >> shift) * ns->window[n] >> 15;
+    if (n < overlap) {
+      pcm[n] = saturate16(ns->tail[n] + y);
+    } else if (n < hop) {
+      pcm[n] = saturate16(y);
+    } else {
+      ns->tail[n - hop] = y;
+    }
+  }
+}
+
+void ns_process(void* state, int16_t* pcm, size_t count) {
+  NoiseSuppressor* ns = (NoiseSuppressor*)state;
+  for (size_t offset = 0; offset + ns->hop <= count; offset += ns->hop) {
+    ns_hop(ns, pcm + offset);
+  }
+}
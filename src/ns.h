@@ -0,0 +1,56 @@
+#ifndef NS_H
+#define NS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fft.h"
+
+// STFT noise suppressor for the capture path
+// Each block is split into two hops; every hop is windowed together with
+// the tail of the previous one (square-root Hann ramps over the overlap,
+// flat in between, zero-padded to a power-of-two FFT), so a windowed
+// overlap-add gives the input back when no gain is applied. Per bin, a
+// minimum-tracking noise estimate on the smoothed magnitude feeds a Wiener
+// gain with decision-directed a priori SNR, floored so the background is
+// turned down rather than removed (no musical noise bursts). Per-bin math
+// is 32-bit with one hardware divide per ratio. Output lags the input by
+// the overlap (48 samples, 6ms at 8kHz)
+#define NS_GAIN_FLOOR 3277      // Q15 gain floor (-20dB)
+#define NS_DD_ALPHA 251         // Q8 weight of the previous hop's SNR (0.98)
+#define NS_SMOOTHING 1          // log2 magnitude smoothing per hop
+#define NS_NOISE_RISE 6         // log2 rise of the noise estimate per hop
+#define NS_MAX_RATIO (32 << 8)  // Q8 magnitude SNR clamp (30dB)
+
+typedef struct {
+  Fft fft;
+  size_t hop;      // Samples per hop, half a block
+  size_t overlap;  // Samples shared by consecutive hops
+  size_t bins;     // fft.size / 2 + 1
+
+  int16_t* window;       // Q15, hop + overlap samples
+  int16_t* history;      // Last overlap input samples
+  int32_t* tail;         // Overlap-add tail of the previous hop
+  FftComplex* spectrum;  // fft.size points
+
+  // Per bin, in Q8 units of |X|/size
+  uint32_t* smoothed;  // Smoothed magnitude
+  uint32_t* noise;     // Noise magnitude (minimum tracked)
+  uint32_t* clean;     // Previous hop's magnitude after the gain
+
+  uint32_t hops;  // Hops processed since init or reset
+} NoiseSuppressor;
+
+// Allocate state in internal SRAM for blocks of block_samples (two hops).
+// False when the hop needs an FFT larger than FFT_MAX_SIZE or memory runs
+// out
+bool ns_init(NoiseSuppressor* ns, size_t block_samples);
+
+// Forget the signal and the noise estimate
+void ns_reset(NoiseSuppressor* ns);
+
+// DspChain stage: suppress noise in count samples in place (a multiple of
+// the hop, normally one block)
+void ns_process(void* state, int16_t* pcm, size_t count);
+
+#endif  // NS_H
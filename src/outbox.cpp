@@ -0,0 +1,281 @@
+#include "outbox.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <string.h>
+
+#include "main.h"
+
+typedef struct {
+  char data[OUTBOX_SLOT_SIZE];
+  size_t length;
+  int64_t queued_us;  // esp_timer time the message was queued
+} OutboxSlot;
+
+// FIFO of slot indices for one priority
+typedef struct {
+  uint8_t slots[OUTBOX_SLOTS];
+  size_t head;
+  size_t count;
+} OutboxQueue;
+
+// Message being formatted into a reserved slot
+typedef struct {
+  int slot;
+  OutboxPriority priority;
+  char* data;
+  size_t length;
+  bool overflow;
+} OutboxWriter;
+
+// Slots are reserved and queued under outbox_lock; a reserved slot belongs
+// to its writer until committed, a queued one to the WebRTC task
+static OutboxSlot slots[OUTBOX_SLOTS];
+static uint8_t free_slots[OUTBOX_SLOTS];
+static size_t free_count = 0;
+static OutboxQueue queues[OUTBOX_PRIORITY_COUNT];
+static OutboxStats stats;
+static SemaphoreHandle_t outbox_lock = NULL;
+static TaskHandle_t outbox_sender = NULL;  // WebRTC task to wake
+
+void outbox_init() {
+  outbox_lock = xSemaphoreCreateMutex();
+  outbox_sender = xTaskGetCurrentTaskHandle();
+  for (int i = 0; i < OUTBOX_SLOTS; i++) {
+    free_slots[free_count++] = i;
+  }
+}
+
+// Take a free slot, keeping the reserve for urgent messages
+static bool outbox_begin(OutboxPriority priority, OutboxWriter* w) {
+  size_t reserve = priority == OUTBOX_URGENT ? 0 : OUTBOX_URGENT_RESERVE;
+  xSemaphoreTake(outbox_lock, portMAX_DELAY);
+  if (free_count <= reserve) {
+    stats.rejected++;
+    xSemaphoreGive(outbox_lock);
+    return false;
+  }
+  w->slot = free_slots[--free_count];
+  xSemaphoreGive(outbox_lock);
+
+  w->priority = priority;
+  w->data = slots[w->slot].data;
+  w->length = 0;
+  w->overflow = false;
+  return true;
+}
+
+// Queue the formatted message, or give the slot back if it did not fit
+static bool outbox_commit(OutboxWriter* w) {
+  OutboxSlot* slot = &slots[w->slot];
+  slot->length = w->length;
+  slot->queued_us = esp_timer_get_time();
+
+  xSemaphoreTake(outbox_lock, portMAX_DELAY);
+  if (w->overflow) {
+    stats.overflows++;
+    free_slots[free_count++] = w->slot;
+    xSemaphoreGive(outbox_lock);
+    return false;
+  }
+  OutboxQueue* queue = &queues[w->priority];
+  queue->slots[(queue->head + queue->count) % OUTBOX_SLOTS] = w->slot;
+  queue->count++;
+  stats.queued++;
+  stats.depth++;
+  if (stats.depth > stats.max_depth) {
+    stats.max_depth = stats.depth;
+  }
+  xSemaphoreGive(outbox_lock);
+  xTaskNotifyGive(outbox_sender);
+  return true;
+}
+
+static void outbox_raw(OutboxWriter* w, const char* text) {
+  size_t length = strlen(text);
+  if (w->length + length > OUTBOX_SLOT_SIZE) {
+    w->overflow = true;
+    return;
+  }
+  memcpy(w->data + w->length, text, length);
+  w->length += length;
+}
+
+// Quoted JSON string with the characters that need it escaped
+static void outbox_string(OutboxWriter* w, const char* text) {
+  static const char hex[] = "0123456789abcdef";
+  outbox_raw(w, "\"");
+  for (const char* p = text; *p != '\0' && !w->overflow; p++) {
+    char escape[7] = {'\\', 0, 0, 0, 0, 0, 0};
+    unsigned char c = (unsigned char)*p;
+    if (c == '"' || c == '\\') {
+      escape[1] = c;
+    } else if (c == '\n') {
+      escape[1] = 'n';
+    } else if (c == '\r') {
+      escape[1] = 'r';
+    } else if (c == '\t') {
+      escape[1] = 't';
+    } else if (c < 0x20) {
+      memcpy(escape + 1, "u00", 3);
+      escape[4] = hex[c >> 4];
+      escape[5] = hex[c & 0xf];
+    } else {
+      escape[0] = c;
+    }
+    outbox_raw(w, escape);
+  }
+  outbox_raw(w, "\"");
+}
+
+bool outbox_session_update(const char* instructions, const char* voice) {
+  OutboxWriter w;
+  if (!outbox_begin(OUTBOX_BULK, &w)) {
+    return false;
+  }
+  outbox_raw(&w, "{\"type\":\"session.update\",\"session\":{");
+  if (instructions != NULL) {
+    outbox_raw(&w, "\"instructions\":");
+    outbox_string(&w, instructions);
+  }
+  if (voice != NULL) {
+    outbox_raw(&w, instructions != NULL ? ",\"voice\":" : "\"voice\":");
+    outbox_string(&w, voice);
+  }
+  outbox_raw(&w, "}}");
+  return outbox_commit(&w);
+}
+
+bool outbox_response_create(const char* instructions) {
+  OutboxWriter w;
+  if (!outbox_begin(OUTBOX_BULK, &w)) {
+    return false;
+  }
+  outbox_raw(&w,
+             "{\"type\":\"response.create\",\"response\":{\"modalities\":"
+             "[\"audio\",\"text\"]");
+  if (instructions != NULL) {
+    outbox_raw(&w, ",\"instructions\":");
+    outbox_string(&w, instructions);
+  }
+  outbox_raw(&w, "}}");
+  return outbox_commit(&w);
+}
+
+bool outbox_response_cancel() {
+  OutboxWriter w;
+  if (!outbox_begin(OUTBOX_URGENT, &w)) {
+    return false;
+  }
+  outbox_raw(&w, "{\"type\":\"response.cancel\"}");
+  return outbox_commit(&w);
+}
+
+bool outbox_conversation_text(const char* text) {
+  OutboxWriter w;
+  if (!outbox_begin(OUTBOX_BULK, &w)) {
+    return false;
+  }
+  outbox_raw(&w,
+             "{\"type\":\"conversation.item.create\",\"item\":{\"type\":"
+             "\"message\",\"role\":\"user\",\"content\":[{\"type\":"
+             "\"input_text\",\"text\":");
+  outbox_string(&w, text);
+  outbox_raw(&w, "}]}}");
+  return outbox_commit(&w);
+}
+
+// Highest-priority queue with something in it, NULL if all are empty
+static OutboxQueue* outbox_next() {
+  for (int priority = 0; priority < OUTBOX_PRIORITY_COUNT; priority++) {
+    if (queues[priority].count > 0) {
+      return &queues[priority];
+    }
+  }
+  return NULL;
+}
+
+void outbox_drain(PeerConnection* peer) {
+  size_t budget = OUTBOX_TICK_BUDGET;
+  while (1) {
+    xSemaphoreTake(outbox_lock, portMAX_DELAY);
+    OutboxQueue* queue = outbox_next();
+    int index = queue != NULL ? queue->slots[queue->head] : -1;
+    xSemaphoreGive(outbox_lock);
+    if (index < 0) {
+      return;
+    }
+
+    // Only this task removes queued slots, so the head stays put while
+    // the lock is dropped for the send
+    OutboxSlot* slot = &slots[index];
+    if (slot->length > budget) {
+      return;  // Rest of this tick's budget is too small, next tick
+    }
+    if (peer_connection_datachannel_send(peer, slot->data, slot->length) <
+        0) {
+      // Congested or not yet open: keep it for next tick
+      xSemaphoreTake(outbox_lock, portMAX_DELAY);
+      stats.retries++;
+      xSemaphoreGive(outbox_lock);
+      return;
+    }
+    budget -= slot->length;
+
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - slot->queued_us);
+    xSemaphoreTake(outbox_lock, portMAX_DELAY);
+    queue->head = (queue->head + 1) % OUTBOX_SLOTS;
+    queue->count--;
+    free_slots[free_count++] = index;
+    stats.depth--;
+    stats.sent++;
+    stats.last_us = latency_us;
+    stats.total_us += latency_us;
+    if (latency_us > stats.max_us) {
+      stats.max_us = latency_us;
+    }
+    xSemaphoreGive(outbox_lock);
+  }
+}
+
+void outbox_reset() {
+  xSemaphoreTake(outbox_lock, portMAX_DELAY);
+  for (int priority = 0; priority < OUTBOX_PRIORITY_COUNT; priority++) {
+    OutboxQueue* queue = &queues[priority];
+    while (queue->count > 0) {
+      free_slots[free_count++] = queue->slots[queue->head];
+      queue->head = (queue->head + 1) % OUTBOX_SLOTS;
+      queue->count--;
+      stats.dropped++;
+      stats.depth--;
+    }
+  }
+  xSemaphoreGive(outbox_lock);
+}
+
+void outbox_stats(OutboxStats* out) {
+  xSemaphoreTake(outbox_lock, portMAX_DELAY);
+  *out = stats;
+  xSemaphoreGive(outbox_lock);
+}
+
+void outbox_dump() {
+  OutboxStats s;
+  outbox_stats(&s);
+  uint64_t mean_us = s.sent > 0 ? s.total_us / s.sent : 0;
+  ESP_LOGI(LOG_TAG,
+           "Outbox: queued=%lu sent=%lu rejected=%lu overflows=%lu "
+           "retries=%lu dropped=%lu",
+           (unsigned long)s.queued, (unsigned long)s.sent,
+           (unsigned long)s.rejected, (unsigned long)s.overflows,
+           (unsigned long)s.retries, (unsigned long)s.dropped);
+  ESP_LOGI(LOG_TAG,
+           "Outbox: depth=%lu max_depth=%lu latency last=%luus mean=%luus "
+           "max=%luus",
+           (unsigned long)s.depth, (unsigned long)s.max_depth,
+           (unsigned long)s.last_us, (unsigned long)mean_us,
+           (unsigned long)s.max_us);
+}
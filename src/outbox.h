@@ -0,0 +1,64 @@
+#ifndef OUTBOX_H
+#define OUTBOX_H
+
+#include <peer.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Outbound data-channel messages. Typed builders format Realtime client
+// events straight into fixed slots (no heap), any task may queue them, and
+// the WebRTC task drains the queue from its loop: urgent messages
+// (response.cancel) go before bulk ones, a send that fails because SCTP is
+// congested leaves the message queued for the next tick, and bulk messages
+// are refused while the queue is nearly full so a cancel always fits
+#define OUTBOX_SLOTS 8           // Messages queued at most
+#define OUTBOX_SLOT_SIZE 1024    // Largest formatted message in bytes
+#define OUTBOX_URGENT_RESERVE 2  // Slots bulk messages cannot take
+#define OUTBOX_TICK_BUDGET 4096  // Bytes sent per loop tick at most
+
+typedef enum {
+  OUTBOX_URGENT,  // Sent first, may use the reserved slots
+  OUTBOX_BULK,
+  OUTBOX_PRIORITY_COUNT,
+} OutboxPriority;
+
+typedef struct {
+  uint32_t queued;     // Messages accepted
+  uint32_t sent;       // Messages handed to SCTP
+  uint32_t rejected;   // Messages refused, queue full
+  uint32_t overflows;  // Messages larger than a slot
+  uint32_t retries;    // Sends that failed and were retried
+  uint32_t dropped;    // Messages discarded with their session
+  uint32_t depth;      // Messages waiting now
+  uint32_t max_depth;  // Most messages waiting at once
+  uint32_t last_us;    // Queue to send, last message
+  uint32_t max_us;     // Queue to send, worst message
+  uint64_t total_us;   // Queue to send, summed over sent messages
+} OutboxStats;
+
+// Create the queue lock; call once from the WebRTC task before anything is
+// queued. That task is woken with a task notification for every message
+void outbox_init(void);
+
+// session.update with new instructions and voice (either may be NULL)
+bool outbox_session_update(const char* instructions, const char* voice);
+
+// response.create for audio and text, with instructions (may be NULL)
+bool outbox_response_create(const char* instructions);
+
+// response.cancel of the response in progress, sent ahead of bulk messages
+bool outbox_response_cancel(void);
+
+// conversation.item.create with a user text message
+bool outbox_conversation_text(const char* text);
+
+// Send queued messages on peer, called from the WebRTC task's loop
+void outbox_drain(PeerConnection* peer);
+
+// Discard everything queued, for a session that is going away
+void outbox_reset(void);
+
+void outbox_stats(OutboxStats* stats);
+void outbox_dump(void);
+
+#endif  // OUTBOX_H
@@ -0,0 +1,383 @@
+#include "pcm.h"
+
+#ifdef ESP_PLATFORM
+#include <sdkconfig.h>
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#define PCM_USE_AES3 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PCM_USE_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PCM_USE_NEON 1
+#endif
+
+#define PCM_VECTOR 8  // Samples per 128-bit vector
+
+#if PCM_USE_AES3
+// PIE kernels in pcm_aes3.S: 16-byte aligned buffers, multiples of 8 samples
+extern "C" {
+void pcm_mul_q15_aes3(const int16_t* in, int16_t* out, size_t count,
+                      const int16_t* coeff);
+void pcm_double_sat_aes3(int16_t* samples, size_t count);
+void pcm_mono_to_stereo_aes3(const int16_t* mono, int16_t* stereo,
+                             size_t frames);
+void pcm_stereo_to_mono_aes3(const int16_t* stereo, int16_t* mono,
+                             size_t frames, const int16_t* half);
+int32_t pcm_dot_aes3(const int16_t* a, const int16_t* b, size_t count);
+}
+
+static inline bool aligned16(const void* p) {
+  return ((uintptr_t)p & 15) == 0;
+}
+#endif
+
+static inline int16_t saturate16(int32_t v) {
+  if (v > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (v < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)v;
+}
+
+// Integer square root (floor) of a 64-bit value
+static uint32_t isqrt64(uint64_t v) {
+  uint64_t result = 0;
+  uint64_t bit = 1ULL << 62;
+  while (bit > v) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (v >= result + bit) {
+      v -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)result;
+}
+
+// Scalar references
+
+void pcm_gain_ref(const int16_t* in, int16_t* out, size_t count,
+                  int32_t gain_q8) {
+  for (size_t i = 0; i < count; i++) {
+    out[i] = saturate16(((int32_t)in[i] * gain_q8) >> 8);
+  }
+}
+
+void pcm_mono_to_stereo_ref(const int16_t* mono, int16_t* stereo,
+                            size_t frames) {
+  for (size_t i = 0; i < frames; i++) {
+    stereo[i * 2] = mono[i];
+    stereo[i * 2 + 1] = mono[i];
+  }
+}
+
+void pcm_stereo_to_mono_ref(const int16_t* stereo, int16_t* mono,
+                            size_t frames) {
+  for (size_t i = 0; i < frames; i++) {
+    mono[i] = (int16_t)(((int32_t)stereo[i * 2] + stereo[i * 2 + 1]) >> 1);
+  }
+}
+
+void pcm_s16_to_s32_ref(const int16_t* in, int32_t* out, size_t count,
+                        int shift) {
+  for (size_t i = 0; i < count; i++) {
+    out[i] = (int32_t)((uint32_t)(int32_t)in[i] << shift);
+  }
+}
+
+void pcm_s32_to_s16_ref(const int32_t* in, int16_t* out, size_t count,
+                        int shift) {
+  for (size_t i = 0; i < count; i++) {
+    out[i] = saturate16(in[i] >> shift);
+  }
+}
+
+int32_t pcm_dot_ref(const int16_t* a, const int16_t* b, size_t count) {
+  int32_t sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    sum += (int32_t)a[i] * b[i];
+  }
+  return sum;
+}
+
+// Fold a block into running peak and sum of squares
+static void accumulate_level(const int16_t* in, size_t count, int32_t* peak,
+                             uint64_t* sum_squares) {
+  for (size_t i = 0; i < count; i++) {
+    int32_t v = in[i];
+    int32_t magnitude = v < 0 ? -v : v;
+    if (magnitude > *peak) {
+      *peak = magnitude;
+    }
+    *sum_squares += (uint32_t)(v * v);
+  }
+}
+
+void pcm_level_ref(const int16_t* in, size_t count, PcmLevel* level) {
+  int32_t peak = 0;
+  uint64_t sum_squares = 0;
+  accumulate_level(in, count, &peak, &sum_squares);
+  level->peak = peak;
+  level->rms = count ? (int32_t)isqrt64(sum_squares / count) : 0;
+}
+
+// Dispatching kernels
+
+void pcm_gain(const int16_t* in, int16_t* out, size_t count,
+              int32_t gain_q8) {
+  size_t i = 0;
+#if PCM_USE_AES3
+  // Split the gain into a Q15 fraction and saturating doublings:
+  // gain = fraction * 2^doublings, fraction < 1, so the multiply cannot
+  // overflow and saturation happens in the doublings. Rounding of the
+  // fraction product is amplified by 2^doublings (16 LSB at gain 16).
+  if (gain_q8 > 0 && gain_q8 <= INT16_MAX && aligned16(in) &&
+      aligned16(out)) {
+    int doublings = 0;
+    int32_t fraction = gain_q8 << 7;
+    while (fraction > INT16_MAX) {
+      doublings++;
+      fraction = (gain_q8 << 7) >> doublings;
+    }
+    int16_t coeff[PCM_VECTOR] __attribute__((aligned(16)));
+    for (int lane = 0; lane < PCM_VECTOR; lane++) {
+      coeff[lane] = (int16_t)fraction;
+    }
+    i = count & ~(size_t)(PCM_VECTOR - 1);
+    pcm_mul_q15_aes3(in, out, i, coeff);
+    for (int d = 0; d < doublings; d++) {
+      pcm_double_sat_aes3(out, i);
+    }
+  }
+#elif PCM_USE_SSE2
+  if (gain_q8 >= INT16_MIN && gain_q8 <= INT16_MAX) {
+    __m128i gain = _mm_set1_epi16((int16_t)gain_q8);
+    for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+      __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+      __m128i lo = _mm_mullo_epi16(x, gain);
+      __m128i hi = _mm_mulhi_epi16(x, gain);
+      __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 8);
+      __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 8);
+      _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(p0, p1));
+    }
+  }
+#elif PCM_USE_NEON
+  if (gain_q8 >= INT16_MIN && gain_q8 <= INT16_MAX) {
+    int16x4_t gain = vdup_n_s16((int16_t)gain_q8);
+    for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+      int16x8_t x = vld1q_s16(in + i);
+      int32x4_t p0 = vshrq_n_s32(vmull_s16(vget_low_s16(x), gain), 8);
+      int32x4_t p1 = vshrq_n_s32(vmull_s16(vget_high_s16(x), gain), 8);
+      vst1q_s16(out + i, vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1)));
+    }
+  }
+#endif
+  pcm_gain_ref(in + i, out + i, count - i, gain_q8);
+}
+
+void pcm_mono_to_stereo(const int16_t* mono, int16_t* stereo, size_t frames) {
+  size_t i = 0;
+#if PCM_USE_AES3
+  if (aligned16(mono) && aligned16(stereo)) {
+    i = frames & ~(size_t)(PCM_VECTOR - 1);
+    pcm_mono_to_stereo_aes3(mono, stereo, i);
+  }
+#elif PCM_USE_SSE2
+  for (; i + PCM_VECTOR <= frames; i += PCM_VECTOR) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(mono + i));
+    _mm_storeu_si128((__m128i*)(stereo + i * 2), _mm_unpacklo_epi16(x, x));
+    _mm_storeu_si128((__m128i*)(stereo + i * 2 + PCM_VECTOR),
+                     _mm_unpackhi_epi16(x, x));
+  }
+#elif PCM_USE_NEON
+  for (; i + PCM_VECTOR <= frames; i += PCM_VECTOR) {
+    int16x8x2_t pair;
+    pair.val[0] = vld1q_s16(mono + i);
+    pair.val[1] = pair.val[0];
+    vst2q_s16(stereo + i * 2, pair);
+  }
+#endif
+  pcm_mono_to_stereo_ref(mono + i, stereo + i * 2, frames - i);
+}
+
+void pcm_stereo_to_mono(const int16_t* stereo, int16_t* mono, size_t frames) {
+  size_t i = 0;
+#if PCM_USE_AES3
+  // (L >> 1) + (R >> 1): may differ from the reference by 1 LSB
+  if (aligned16(stereo) && aligned16(mono)) {
+    int16_t half[PCM_VECTOR] __attribute__((aligned(16)));
+    for (int lane = 0; lane < PCM_VECTOR; lane++) {
+      half[lane] = 1 << 14;
+    }
+    i = frames & ~(size_t)(PCM_VECTOR - 1);
+    pcm_stereo_to_mono_aes3(stereo, mono, i, half);
+  }
+#elif PCM_USE_SSE2
+  __m128i ones = _mm_set1_epi16(1);
+  for (; i + PCM_VECTOR <= frames; i += PCM_VECTOR) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(stereo + i * 2));
+    __m128i b = _mm_loadu_si128((const __m128i*)(stereo + i * 2 + PCM_VECTOR));
+    __m128i sum_a = _mm_srai_epi32(_mm_madd_epi16(a, ones), 1);
+    __m128i sum_b = _mm_srai_epi32(_mm_madd_epi16(b, ones), 1);
+    _mm_storeu_si128((__m128i*)(mono + i), _mm_packs_epi32(sum_a, sum_b));
+  }
+#elif PCM_USE_NEON
+  for (; i + PCM_VECTOR <= frames; i += PCM_VECTOR) {
+    int16x8x2_t pair = vld2q_s16(stereo + i * 2);
+    vst1q_s16(mono + i, vhaddq_s16(pair.val[0], pair.val[1]));
+  }
+#endif
+  pcm_stereo_to_mono_ref(stereo + i * 2, mono + i, frames - i);
+}
+
+void pcm_s16_to_s32(const int16_t* in, int32_t* out, size_t count,
+                    int shift) {
+  size_t i = 0;
+#if PCM_USE_SSE2
+  __m128i amount = _mm_cvtsi32_si128(shift);
+  for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+    _mm_storeu_si128((__m128i*)(out + i), _mm_sll_epi32(lo, amount));
+    _mm_storeu_si128((__m128i*)(out + i + 4), _mm_sll_epi32(hi, amount));
+  }
+#elif PCM_USE_NEON
+  int32x4_t amount = vdupq_n_s32(shift);
+  for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+    int16x8_t x = vld1q_s16(in + i);
+    vst1q_s32(out + i, vshlq_s32(vmovl_s16(vget_low_s16(x)), amount));
+    vst1q_s32(out + i + 4, vshlq_s32(vmovl_s16(vget_high_s16(x)), amount));
+  }
+#endif
+  // The S3 has no PIE widening path; the reference loop is used there
+  pcm_s16_to_s32_ref(in + i, out + i, count - i, shift);
+}
+
+void pcm_s32_to_s16(const int32_t* in, int16_t* out, size_t count,
+                    int shift) {
+  size_t i = 0;
+#if PCM_USE_SSE2
+  __m128i amount = _mm_cvtsi32_si128(shift);
+  for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+    __m128i lo = _mm_loadu_si128((const __m128i*)(in + i));
+    __m128i hi = _mm_loadu_si128((const __m128i*)(in + i + 4));
+    _mm_storeu_si128((__m128i*)(out + i),
+                     _mm_packs_epi32(_mm_sra_epi32(lo, amount),
+                                     _mm_sra_epi32(hi, amount)));
+  }
+#elif PCM_USE_NEON
+  int32x4_t amount = vdupq_n_s32(-shift);
+  for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+    int32x4_t lo = vshlq_s32(vld1q_s32(in + i), amount);
+    int32x4_t hi = vshlq_s32(vld1q_s32(in + i + 4), amount);
+    vst1q_s16(out + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+  }
+#endif
+  pcm_s32_to_s16_ref(in + i, out + i, count - i, shift);
+}
+
+int32_t pcm_dot(const int16_t* a, const int16_t* b, size_t count) {
+  size_t i = 0;
+  int32_t sum = 0;
+#if PCM_USE_AES3
+  if (aligned16(a) && aligned16(b)) {
+    i = count & ~(size_t)(PCM_VECTOR - 1);
+    sum = pcm_dot_aes3(a, b, i);
+  }
+#elif PCM_USE_SSE2
+  __m128i vsum = _mm_setzero_si128();
+  for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+    vsum = _mm_add_epi32(vsum, _mm_madd_epi16(x, y));
+  }
+  vsum = _mm_add_epi32(vsum, _mm_shuffle_epi32(vsum, 0x4e));
+  vsum = _mm_add_epi32(vsum, _mm_shuffle_epi32(vsum, 0xb1));
+  sum = _mm_cvtsi128_si32(vsum);
+#elif PCM_USE_NEON
+  int32x4_t vsum = vdupq_n_s32(0);
+  for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+    int16x8_t x = vld1q_s16(a + i);
+    int16x8_t y = vld1q_s16(b + i);
+    vsum = vmlal_s16(vsum, vget_low_s16(x), vget_low_s16(y));
+    vsum = vmlal_s16(vsum, vget_high_s16(x), vget_high_s16(y));
+  }
+  sum = vaddvq_s32(vsum);
+#endif
+  return sum + pcm_dot_ref(a + i, b + i, count - i);
+}
+
+size_t pcm_dot_alignment() {
+#if PCM_USE_AES3
+  return PCM_VECTOR;
+#else
+  return 1;
+#endif
+}
+
+void pcm_level(const int16_t* in, size_t count, PcmLevel* level) {
+  size_t i = 0;
+  int32_t peak = 0;
+  uint64_t sum_squares = 0;
+#if PCM_USE_SSE2
+  __m128i vmax = _mm_setzero_si128();
+  __m128i vmin = _mm_setzero_si128();
+  __m128i vsum = _mm_setzero_si128();  // Two 64-bit accumulators
+  __m128i zero = _mm_setzero_si128();
+  for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+    vmax = _mm_max_epi16(vmax, x);
+    vmin = _mm_min_epi16(vmin, x);
+    // Pairwise squares fit in an unsigned 32-bit lane (at most 2^31)
+    __m128i squares = _mm_madd_epi16(x, x);
+    vsum = _mm_add_epi64(vsum, _mm_unpacklo_epi32(squares, zero));
+    vsum = _mm_add_epi64(vsum, _mm_unpackhi_epi32(squares, zero));
+  }
+  int16_t lanes_max[PCM_VECTOR];
+  int16_t lanes_min[PCM_VECTOR];
+  uint64_t sums[2];
+  _mm_storeu_si128((__m128i*)lanes_max, vmax);
+  _mm_storeu_si128((__m128i*)lanes_min, vmin);
+  _mm_storeu_si128((__m128i*)sums, vsum);
+  for (int lane = 0; lane < PCM_VECTOR; lane++) {
+    if (lanes_max[lane] > peak) {
+      peak = lanes_max[lane];
+    }
+    if (-lanes_min[lane] > peak) {
+      peak = -lanes_min[lane];
+    }
+  }
+  sum_squares = sums[0] + sums[1];
+#elif PCM_USE_NEON
+  int16x8_t vmax = vdupq_n_s16(0);
+  int16x8_t vmin = vdupq_n_s16(0);
+  uint64x2_t vsum = vdupq_n_u64(0);
+  for (; i + PCM_VECTOR <= count; i += PCM_VECTOR) {
+    int16x8_t x = vld1q_s16(in + i);
+    vmax = vmaxq_s16(vmax, x);
+    vmin = vminq_s16(vmin, x);
+    int32x4_t lo = vmull_s16(vget_low_s16(x), vget_low_s16(x));
+    int32x4_t hi = vmull_s16(vget_high_s16(x), vget_high_s16(x));
+    vsum = vpadalq_u32(vsum, vreinterpretq_u32_s32(lo));
+    vsum = vpadalq_u32(vsum, vreinterpretq_u32_s32(hi));
+  }
+  int32_t high = vmaxvq_s16(vmax);
+  int32_t low = -(int32_t)vminvq_s16(vmin);
+  peak = high > low ? high : low;
+  sum_squares = vgetq_lane_u64(vsum, 0) + vgetq_lane_u64(vsum, 1);
+#endif
+  // Remaining samples (all of them on the S3, where the loop is cheap)
+  accumulate_level(in + i, count - i, &peak, &sum_squares);
+  level->peak = peak;
+  level->rms = count ? (int32_t)isqrt64(sum_squares / count) : 0;
+}
@@ -0,0 +1,58 @@
+#ifndef PCM_H
+#define PCM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 16-bit PCM kernels used on the capture and playout paths
+// Each kernel has a scalar reference (pcm_*_ref) and a dispatching version
+// that uses ESP32-S3 PIE vector instructions on target (pcm_aes3.S) and
+// SSE2/NEON on the host, falling back to the reference for unaligned data
+// and tails. Input and output may be the same buffer unless noted.
+
+#define PCM_GAIN_UNITY 256  // Gains are Q8 fixed point
+
+// Peak and RMS level of a block
+typedef struct {
+  int32_t peak;  // Largest absolute sample value (0..32768)
+  int32_t rms;   // Root mean square sample value
+} PcmLevel;
+
+// out = saturate(in * gain_q8 / 256)
+void pcm_gain(const int16_t* in, int16_t* out, size_t count, int32_t gain_q8);
+void pcm_gain_ref(const int16_t* in, int16_t* out, size_t count,
+                  int32_t gain_q8);
+
+// Duplicate a mono stream into interleaved L/R (must not alias)
+void pcm_mono_to_stereo(const int16_t* mono, int16_t* stereo, size_t frames);
+void pcm_mono_to_stereo_ref(const int16_t* mono, int16_t* stereo,
+                            size_t frames);
+
+// Average interleaved L/R into mono (mono may alias stereo)
+void pcm_stereo_to_mono(const int16_t* stereo, int16_t* mono, size_t frames);
+void pcm_stereo_to_mono_ref(const int16_t* stereo, int16_t* mono,
+                            size_t frames);
+
+// Widen: out = in << shift (shift 16 gives left-justified I2S slots)
+void pcm_s16_to_s32(const int16_t* in, int32_t* out, size_t count, int shift);
+void pcm_s16_to_s32_ref(const int16_t* in, int32_t* out, size_t count,
+                        int shift);
+
+// Narrow: out = saturate(in >> shift)
+void pcm_s32_to_s16(const int32_t* in, int16_t* out, size_t count, int shift);
+void pcm_s32_to_s16_ref(const int32_t* in, int16_t* out, size_t count,
+                        int shift);
+
+// Sum of a[i] * b[i], for FIR filters; the sum must fit in 32 bits
+int32_t pcm_dot(const int16_t* a, const int16_t* b, size_t count);
+int32_t pcm_dot_ref(const int16_t* a, const int16_t* b, size_t count);
+
+// Sample alignment both pcm_dot inputs need for the vector path: 8 where
+// vector loads must be 16-byte aligned (ESP32-S3), 1 where any address works
+size_t pcm_dot_alignment(void);
+
+// Peak and RMS of a block
+void pcm_level(const int16_t* in, size_t count, PcmLevel* level);
+void pcm_level_ref(const int16_t* in, size_t count, PcmLevel* level);
+
+#endif  // PCM_H
@@ -0,0 +1,141 @@
+#include "rate_control.h"
+
+#include <string.h>
+
+#define RATE_CONTROL_LOSS_DECAY 2  // log2 smoothing while the loss falls
+
+// Bitrate ladder, highest first. The low rungs use longer frames so the
+// ~50 bytes of IP/UDP/SRTP overhead per packet stop dominating the rate
+typedef struct {
+  uint32_t bitrate;
+  uint32_t frame_ms;
+} RateLevel;
+
+static const RateLevel rate_levels[] = {
+    {30000, 20}, {24000, 20}, {16000, 20}, {12000, 40}, {8000, 60},
+};
+#define RATE_LEVEL_COUNT (sizeof(rate_levels) / sizeof(rate_levels[0]))
+
+static void rate_control_apply_level(RateControl* rc) {
+  const RateLevel* level = &rate_levels[rc->level];
+  rc->settings.bitrate = level->bitrate;
+  rc->settings.frame_ms = level->frame_ms < RATE_CONTROL_MAX_FRAME_MS
+                              ? level->frame_ms
+                              : RATE_CONTROL_MAX_FRAME_MS;
+}
+
+void rate_control_init(RateControl* rc, int64_t now_us) {
+  rc->level = 0;
+  rc->settings.loss_percent = 0;
+  rc->settings.fec = false;
+  rate_control_apply_level(rc);
+  rc->loss_q8 = 0;
+  rc->min_rtt_ms = 0;
+  rc->last_decrease_us = now_us - RATE_CONTROL_HOLD_MS * 1000LL;
+  rc->last_increase_us = now_us;
+  rc->clean_since_us = now_us;
+  rc->probe_us = RATE_CONTROL_PROBE_MS * 1000LL;
+  rc->probing = false;
+  memset(&rc->stats, 0, sizeof(rc->stats));
+}
+
+// Expected loss and FEC follow the smoothed loss with hysteresis so a
+// single noisy report does not flip encoder settings back and forth
+static void rate_control_update_loss(RateControl* rc) {
+  uint32_t expected = (uint32_t)(rc->loss_q8 * 100 + 255) / 256;
+  if (expected > RATE_CONTROL_LOSS_PERC_MAX) {
+    expected = RATE_CONTROL_LOSS_PERC_MAX;
+  }
+  uint32_t current = rc->settings.loss_percent;
+  uint32_t change =
+      expected > current ? expected - current : current - expected;
+  if (change >= RATE_CONTROL_LOSS_PERC_STEP || (expected == 0 && current > 0)) {
+    rc->settings.loss_percent = expected;
+  }
+
+  if (!rc->settings.fec && expected >= RATE_CONTROL_FEC_ON) {
+    rc->settings.fec = true;
+    rc->stats.fec_changes++;
+  } else if (rc->settings.fec && expected <= RATE_CONTROL_FEC_OFF) {
+    rc->settings.fec = false;
+    rc->stats.fec_changes++;
+  }
+}
+
+bool rate_control_update(RateControl* rc, const RateFeedback* feedback,
+                         int64_t now_us) {
+  RateSettings before = rc->settings;
+  rc->stats.reports++;
+
+  // Loss estimate rises at once and decays over a few reports
+  int32_t lost = feedback->fraction_lost;
+  if (lost > rc->loss_q8) {
+    rc->loss_q8 = lost;
+  } else {
+    rc->loss_q8 += (lost - rc->loss_q8) >> RATE_CONTROL_LOSS_DECAY;
+  }
+  uint32_t loss_percent = (uint32_t)lost * 100 / 256;
+
+  // Queueing delay: round trip above the lowest one seen, or the jitter
+  // when the round trip is unknown (or smaller)
+  uint32_t delay_ms = feedback->jitter_ms;
+  if (feedback->rtt_ms > 0) {
+    if (rc->min_rtt_ms == 0 || feedback->rtt_ms < rc->min_rtt_ms) {
+      rc->min_rtt_ms = feedback->rtt_ms;
+    }
+    uint32_t queued_ms = feedback->rtt_ms - rc->min_rtt_ms;
+    if (queued_ms > delay_ms) {
+      delay_ms = queued_ms;
+    }
+  }
+
+  bool congested = loss_percent >= RATE_CONTROL_LOSS_HIGH ||
+                   delay_ms >= RATE_CONTROL_DELAY_HIGH_MS;
+  bool clean = loss_percent < RATE_CONTROL_LOSS_LOW &&
+               delay_ms < RATE_CONTROL_DELAY_HIGH_MS / 2;
+
+  // A step up that survived a whole probe period was right: relax the
+  // probe period again
+  if (rc->probing && now_us - rc->last_increase_us >= rc->probe_us) {
+    rc->probing = false;
+    rc->probe_us /= 2;
+    if (rc->probe_us < RATE_CONTROL_PROBE_MS * 1000LL) {
+      rc->probe_us = RATE_CONTROL_PROBE_MS * 1000LL;
+    }
+  }
+
+  if (congested) {
+    rc->clean_since_us = now_us;
+    if (rc->probing) {
+      // The last step up caused this: wait longer before the next one
+      rc->probing = false;
+      rc->probe_us *= 2;
+      if (rc->probe_us > RATE_CONTROL_PROBE_MAX_MS * 1000LL) {
+        rc->probe_us = RATE_CONTROL_PROBE_MAX_MS * 1000LL;
+      }
+      rc->stats.failed_probes++;
+    }
+    if (now_us - rc->last_decrease_us >= RATE_CONTROL_HOLD_MS * 1000LL &&
+        rc->level + 1 < RATE_LEVEL_COUNT) {
+      rc->level++;
+      rc->last_decrease_us = now_us;
+      rc->stats.decreases++;
+    }
+  } else if (!clean) {
+    rc->clean_since_us = now_us;
+  } else if (now_us - rc->clean_since_us >= rc->probe_us && rc->level > 0) {
+    rc->level--;
+    rc->last_increase_us = now_us;
+    rc->clean_since_us = now_us;
+    rc->probing = true;
+    rc->stats.increases++;
+  }
+
+  rate_control_apply_level(rc);
+  rate_control_update_loss(rc);
+
+  return before.bitrate != rc->settings.bitrate ||
+         before.frame_ms != rc->settings.frame_ms ||
+         before.loss_percent != rc->settings.loss_percent ||
+         before.fec != rc->settings.fec;
+}
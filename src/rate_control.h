@@ -0,0 +1,76 @@
+#ifndef RATE_CONTROL_H
+#define RATE_CONTROL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Adaptive bitrate and loss-resilience controller for the Opus encoder
+// Each feedback report (loss, round trip time, jitter) moves the encoder
+// along a ladder of bitrate/frame-duration levels: down at once on heavy
+// loss or queueing delay, up only after a clean probe period that doubles
+// every time a step up is followed by congestion. Expected loss drives
+// OPUS_SET_PACKET_LOSS_PERC and in-band FEC with separate on/off thresholds
+#define RATE_CONTROL_INTERVAL_MS 1000    // Feedback period (RTCP RR cadence)
+#define RATE_CONTROL_LOSS_HIGH 10        // Loss % that steps the bitrate down
+#define RATE_CONTROL_LOSS_LOW 2          // Loss % below which probing may start
+#define RATE_CONTROL_FEC_ON 3            // Expected loss % that enables FEC
+#define RATE_CONTROL_FEC_OFF 1           // Expected loss % that disables it
+#define RATE_CONTROL_LOSS_PERC_MAX 30    // Cap for OPUS_SET_PACKET_LOSS_PERC
+#define RATE_CONTROL_LOSS_PERC_STEP 2    // Smaller changes are not applied
+#define RATE_CONTROL_DELAY_HIGH_MS 150   // Queueing delay that steps down
+#define RATE_CONTROL_HOLD_MS 2000        // Minimum time between decreases
+#define RATE_CONTROL_PROBE_MS 4000       // Clean time before stepping up
+#define RATE_CONTROL_PROBE_MAX_MS 32000  // Probe period after failed probes
+// Longest Opus frame the ladder may use. libpeer advances the RTP timestamp
+// by a fixed 20ms per packet, so longer packets would run the receiver's
+// playout clock slow; the 40/60ms levels stay capped to 20ms until the
+// timestamp follows the packet's sample count (build with 60 to try them)
+#ifndef RATE_CONTROL_MAX_FRAME_MS
+#define RATE_CONTROL_MAX_FRAME_MS 20
+#endif
+
+// One network feedback report
+typedef struct {
+  uint8_t fraction_lost;  // Packets lost since the last report, x/256
+  uint32_t rtt_ms;        // Round trip time, 0 when unknown
+  uint32_t jitter_ms;     // Interarrival jitter
+} RateFeedback;
+
+// Encoder settings chosen by the controller
+typedef struct {
+  uint32_t bitrate;       // OPUS_SET_BITRATE
+  uint32_t loss_percent;  // OPUS_SET_PACKET_LOSS_PERC
+  bool fec;               // OPUS_SET_INBAND_FEC
+  uint32_t frame_ms;      // Opus frame duration, a multiple of 20ms
+} RateSettings;
+
+// Controller counters
+typedef struct {
+  uint32_t reports;        // Feedback reports processed
+  uint32_t decreases;      // Steps down the ladder
+  uint32_t increases;      // Steps up the ladder
+  uint32_t failed_probes;  // Increases followed by congestion
+  uint32_t fec_changes;    // In-band FEC toggles
+} RateControlStats;
+
+typedef struct {
+  RateSettings settings;
+  size_t level;              // Ladder index, 0 is the highest bitrate
+  int32_t loss_q8;           // Smoothed fraction lost, x/256
+  uint32_t min_rtt_ms;       // Lowest round trip seen (propagation delay)
+  int64_t last_decrease_us;  // Time of the last step down
+  int64_t last_increase_us;  // Time of the last step up
+  int64_t clean_since_us;    // Start of the current congestion-free run
+  int64_t probe_us;          // Clean time required before stepping up
+  bool probing;              // Last change was a step up not yet confirmed
+  RateControlStats stats;
+} RateControl;
+
+// Start at the top of the ladder with FEC off
+void rate_control_init(RateControl* rc, int64_t now_us);
+
+// Feed one report; returns true when rc->settings changed
+bool rate_control_update(RateControl* rc, const RateFeedback* feedback,
+                         int64_t now_us);
+
+#endif  // RATE_CONTROL_H
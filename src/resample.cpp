@@ -0,0 +1,194 @@
+#include "resample.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem.h"
+#include "pcm.h"
+
+// Filter length is given per period of the lower rate, so the transition
+// band (about (A - 8) / (14.36 * taps) of the lower rate for a stopband of
+// A dB) is the same whichever way the conversion goes; decimating by M
+// stretches each phase to M times as many taps. The -6dB cutoff is placed
+// so the transition band ends near the lower Nyquist frequency
+typedef struct {
+  const char* name;
+  size_t taps;    // Taps per phase at 1:1, per lower-rate period
+  double beta;    // Kaiser window shape
+  double cutoff;  // -6dB point as a fraction of the lower Nyquist
+} ResampleDesign;
+
+static const ResampleDesign designs[RESAMPLE_QUALITY_COUNT] = {
+    {"fast", 16, 5.0, 0.90},
+    {"medium", 32, 7.0, 0.94},
+    {"high", 64, 9.0, 0.96},
+};
+
+#define RESAMPLE_ROUND (1 << (RESAMPLE_COEF_SHIFT - 1))
+
+static int16_t design_taps[RESAMPLE_MAX_TAPS];  // One phase during design
+
+static inline int16_t saturate16(int32_t v) {
+  if (v > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (v < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)v;
+}
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+  while (b != 0) {
+    uint32_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Zeroth-order modified Bessel function of the first kind
+static double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 64 && term > 1e-12 * sum; k++) {
+    double half = x / (2.0 * k);
+    term *= half * half;
+    sum += term;
+  }
+  return sum;
+}
+
+// Prototype low-pass at L times the input rate, quantized per phase to Q14
+// with each phase summing to exactly 1.0 (no ripple at DC between phases),
+// then stored reversed in every alignment bank
+static void resample_design(Resampler* r, const ResampleDesign* design) {
+  size_t length = r->taps * r->up;
+  double center = (length - 1) / 2.0;
+  uint32_t lower = r->in_rate < r->out_rate ? r->in_rate : r->out_rate;
+  double cutoff = design->cutoff * lower / 2.0 / ((double)r->in_rate * r->up);
+  double window_norm = bessel_i0(design->beta);
+  double scale = (double)(1 << RESAMPLE_COEF_SHIFT) * r->up;
+
+  for (uint32_t p = 0; p < r->up; p++) {
+    int32_t sum = 0;
+    size_t largest = 0;
+    for (size_t j = 0; j < r->taps; j++) {
+      size_t n = p + j * r->up;
+      double x = n - center;
+      double sinc = x == 0 ? 1.0 : sin(2 * M_PI * cutoff * x) /
+                                       (2 * M_PI * cutoff * x);
+      double edge = 2.0 * n / (length - 1) - 1.0;
+      double window =
+          bessel_i0(design->beta * sqrt(fmax(0.0, 1.0 - edge * edge))) /
+          window_norm;
+      double h = 2 * cutoff * sinc * window * scale;
+      design_taps[j] = (int16_t)lrint(h);
+      sum += design_taps[j];
+      if (abs(design_taps[j]) > abs(design_taps[largest])) {
+        largest = j;
+      }
+    }
+    design_taps[largest] += (1 << RESAMPLE_COEF_SHIFT) - sum;
+
+    for (size_t a = 0; a < r->banks; a++) {
+      int16_t* bank = r->coeffs + (p * r->banks + a) * r->stride;
+      for (size_t j = 0; j < r->taps; j++) {
+        bank[a + j] = design_taps[r->taps - 1 - j];
+      }
+    }
+  }
+}
+
+bool resample_init(Resampler* r, uint32_t in_rate, uint32_t out_rate,
+                   ResampleQuality quality, size_t max_input) {
+  memset(r, 0, sizeof(*r));
+  r->in_rate = in_rate;
+  r->out_rate = out_rate;
+  r->max_input = max_input;
+  uint32_t divisor = gcd(in_rate, out_rate);
+  r->up = out_rate / divisor;
+  r->down = in_rate / divisor;
+  if (r->up == r->down) {
+    return true;  // Same rate: copied through
+  }
+  if (r->up > RESAMPLE_MAX_PHASES) {
+    return false;
+  }
+
+  const ResampleDesign* design = &designs[quality];
+  r->taps = design->taps * ((r->down + r->up - 1) / r->up);
+  if (r->taps > RESAMPLE_MAX_TAPS) {
+    return false;
+  }
+  r->banks = pcm_dot_alignment();
+  r->stride = (r->taps + r->banks - 1 + 7) & ~(size_t)7;
+
+  // Zeroed by mem_alloc: bank padding stays zero, so the window may run
+  // past the newest sample into stale history
+  r->coeffs = (int16_t*)mem_alloc(
+      MEM_INTERNAL, r->up * r->banks * r->stride * sizeof(int16_t));
+  r->history = (int16_t*)mem_alloc(
+      MEM_INTERNAL, (r->taps + max_input + r->stride) * sizeof(int16_t));
+  if (r->coeffs == NULL || r->history == NULL) {
+    return false;
+  }
+  resample_design(r, design);
+  return true;
+}
+
+void resample_reset(Resampler* r) {
+  if (r->taps > 0) {
+    memset(r->history, 0, (r->taps - 1) * sizeof(int16_t));
+  }
+  r->phase = 0;
+  r->position = 0;
+}
+
+size_t resample_output_max(const Resampler* r, size_t count) {
+  return (count * r->up + r->down - 1) / r->down + 1;
+}
+
+size_t resample_process(Resampler* r, const int16_t* in, size_t count,
+                        int16_t* out) {
+  if (r->taps == 0) {
+    memcpy(out, in, count * sizeof(int16_t));
+    return count;
+  }
+
+  // history[k] is input k - (taps - 1), so output windows are contiguous
+  size_t keep = r->taps - 1;
+  memcpy(r->history + keep, in, count * sizeof(int16_t));
+
+  size_t written = 0;
+  size_t k = r->position;
+  uint32_t p = r->phase;
+  while (k < count) {
+    // Start on the aligned sample at or before the window, in the bank
+    // whose leading zeros skip the difference
+    size_t a = k % r->banks;
+    const int16_t* bank = r->coeffs + (p * r->banks + a) * r->stride;
+    int32_t acc = pcm_dot(bank, r->history + k - a, r->stride);
+    out[written++] = saturate16((acc + RESAMPLE_ROUND) >> RESAMPLE_COEF_SHIFT);
+    p += r->down;
+    k += p / r->up;
+    p %= r->up;
+  }
+  r->position = k - count;
+  r->phase = p;
+  memmove(r->history, r->history + count, keep * sizeof(int16_t));
+  return written;
+}
+
+size_t resample_delay(const Resampler* r) {
+  if (r->taps == 0) {
+    return 0;
+  }
+  size_t length = r->taps * r->up;
+  return ((length - 1) / 2 + r->down / 2) / r->down;
+}
+
+const char* resample_quality_name(ResampleQuality quality) {
+  return designs[quality].name;
+}
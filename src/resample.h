@@ -0,0 +1,73 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-point polyphase sample rate converter between the I2S clock and the
+// Opus rate. The rate ratio is reduced to up/down (L/M); a windowed-sinc
+// low-pass designed at L times the input rate is split into L phases, and
+// each output sample is one pcm_dot of a phase against the newest input
+// samples. The cutoff sits below the lower of the two Nyquist frequencies,
+// so the same filter is the anti-alias filter when decimating and the
+// anti-image filter when interpolating. Streaming: any block size, state
+// carried across calls; blocks that hold a whole number of output periods
+// (20ms frames between 50Hz-multiple rates) give an exact output count
+#define RESAMPLE_MAX_PHASES 16  // Largest up factor L after reduction
+#define RESAMPLE_MAX_TAPS 512   // Taps per phase (48kHz to 8kHz at high: 384)
+#define RESAMPLE_COEF_SHIFT 14  // Coefficients are Q14 (phase sums of 1.0)
+
+// Measured alias rejection (bench_resample) is held near -70dB by the Q14
+// coefficients, so HIGH buys a flatter passband, not a deeper stopband
+typedef enum {
+  RESAMPLE_FAST,    // 16 taps per lower-rate period, about -60dB, 3dB ripple
+  RESAMPLE_MEDIUM,  // 32 taps, -65 to -70dB, 0.35dB ripple
+  RESAMPLE_HIGH,    // 64 taps, -67 to -72dB, 0.01dB ripple
+  RESAMPLE_QUALITY_COUNT,
+} ResampleQuality;
+
+typedef struct {
+  uint32_t in_rate;
+  uint32_t out_rate;
+  uint32_t up;    // L: interpolation factor after reduction
+  uint32_t down;  // M: decimation factor after reduction
+  size_t taps;    // Coefficients per phase, 0 when the rates are equal
+
+  // Coefficients by phase and alignment bank: bank a holds the phase's taps
+  // reversed behind a leading zeros, so every pcm_dot starts on an aligned
+  // sample (the PIE vector loads ignore the low address bits)
+  int16_t* coeffs;
+  size_t banks;   // pcm_dot_alignment()
+  size_t stride;  // Samples per bank, multiple of 8
+
+  // taps - 1 samples of the previous block followed by the current block
+  int16_t* history;
+  size_t max_input;  // Largest block accepted by resample_process
+
+  uint32_t phase;   // Phase of the next output, 0..L-1
+  size_t position;  // Input index ending the next output's window
+} Resampler;
+
+// Design the filter and allocate state in internal SRAM for blocks of up to
+// max_input samples. False when the reduced ratio needs more than
+// RESAMPLE_MAX_PHASES phases or RESAMPLE_MAX_TAPS taps, or memory runs out
+bool resample_init(Resampler* resampler, uint32_t in_rate, uint32_t out_rate,
+                   ResampleQuality quality, size_t max_input);
+
+// Forget past input, as at the start of a stream
+void resample_reset(Resampler* resampler);
+
+// Largest number of samples resample_process returns for count inputs
+size_t resample_output_max(const Resampler* resampler, size_t count);
+
+// Convert count samples (at most max_input), returns samples written to out
+// (in and out must not alias)
+size_t resample_process(Resampler* resampler, const int16_t* in, size_t count,
+                        int16_t* out);
+
+// Samples of delay the filter adds, at the output rate
+size_t resample_delay(const Resampler* resampler);
+
+const char* resample_quality_name(ResampleQuality quality);
+
+#endif  // RESAMPLE_H
@@ -0,0 +1,153 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+// Single-producer/single-consumer lock-free ring of fixed-size PCM frames
+// The producer fills a slot in place (acquire -> commit) and the consumer
+// drains it in place (peek -> pop), so no frame is ever copied twice
+// Slot count must be a power of two; head/tail are free-running counters
+typedef struct {
+  int16_t* frames;       // Storage for slots * frame_samples samples
+  size_t frame_samples;  // Samples per frame
+  uint32_t slots;        // Number of frames the ring can hold
+  std::atomic<uint32_t> head;       // Next slot to write (producer only)
+  std::atomic<uint32_t> tail;       // Next slot to read (consumer only)
+  std::atomic<uint32_t> overruns;   // Frames dropped because ring was full
+  std::atomic<uint32_t> underruns;  // Consumer waits that found no frame
+} FrameRing;
+
+// Attach caller-provided storage of slots * frame_samples samples
+static inline void frame_ring_init(FrameRing* ring, int16_t* storage,
+                                   uint32_t slots, size_t frame_samples) {
+  ring->frames = storage;
+  ring->frame_samples = frame_samples;
+  ring->slots = slots;
+  ring->head.store(0, std::memory_order_relaxed);
+  ring->tail.store(0, std::memory_order_relaxed);
+  ring->overruns.store(0, std::memory_order_relaxed);
+  ring->underruns.store(0, std::memory_order_relaxed);
+}
+
+// Number of committed frames waiting for the consumer
+static inline uint32_t frame_ring_depth(FrameRing* ring) {
+  return ring->head.load(std::memory_order_acquire) -
+         ring->tail.load(std::memory_order_acquire);
+}
+
+// Producer: slot to fill next, or NULL when the ring is full
+static inline int16_t* frame_ring_acquire(FrameRing* ring) {
+  uint32_t head = ring->head.load(std::memory_order_relaxed);
+  uint32_t tail = ring->tail.load(std::memory_order_acquire);
+  if (head - tail == ring->slots) {
+    return NULL;
+  }
+  return ring->frames + (head & (ring->slots - 1)) * ring->frame_samples;
+}
+
+// Producer: publish the slot returned by frame_ring_acquire
+static inline void frame_ring_commit(FrameRing* ring) {
+  uint32_t head = ring->head.load(std::memory_order_relaxed);
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+// Consumer: oldest committed frame, or NULL when the ring is empty
+static inline const int16_t* frame_ring_peek(FrameRing* ring) {
+  uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+  uint32_t head = ring->head.load(std::memory_order_acquire);
+  if (head == tail) {
+    return NULL;
+  }
+  return ring->frames + (tail & (ring->slots - 1)) * ring->frame_samples;
+}
+
+// Slot number of a frame pointer, for per-slot side data such as timestamps
+static inline uint32_t frame_ring_index(FrameRing* ring, const int16_t* frame) {
+  return (uint32_t)((frame - ring->frames) / ring->frame_samples);
+}
+
+// Consumer: release the frame returned by frame_ring_peek
+static inline void frame_ring_pop(FrameRing* ring) {
+  uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+  ring->tail.store(tail + 1, std::memory_order_release);
+}
+
+// Single-producer/single-consumer lock-free ring of variable-length packets
+// Each slot holds up to slot_size bytes; the producer writes a packet in
+// place and commits it with its length, the consumer sends it from the slot
+// Same rules as FrameRing: power-of-two slot count, free-running counters
+typedef struct {
+  uint8_t* packets;                // Storage for slots * slot_size bytes
+  uint16_t* lengths;               // Committed length of each slot
+  size_t slot_size;                // Largest packet in bytes
+  uint32_t slots;                  // Number of packets the ring can hold
+  std::atomic<uint32_t> head;      // Next slot to write (producer only)
+  std::atomic<uint32_t> tail;      // Next slot to read (consumer only)
+  std::atomic<uint32_t> overruns;  // Packets dropped because ring was full
+} PacketRing;
+
+// Attach caller-provided storage of slots * slot_size bytes and slots lengths
+static inline void packet_ring_init(PacketRing* ring, uint8_t* storage,
+                                    uint16_t* lengths, uint32_t slots,
+                                    size_t slot_size) {
+  ring->packets = storage;
+  ring->lengths = lengths;
+  ring->slot_size = slot_size;
+  ring->slots = slots;
+  ring->head.store(0, std::memory_order_relaxed);
+  ring->tail.store(0, std::memory_order_relaxed);
+  ring->overruns.store(0, std::memory_order_relaxed);
+}
+
+// Number of committed packets waiting for the consumer
+static inline uint32_t packet_ring_depth(PacketRing* ring) {
+  return ring->head.load(std::memory_order_acquire) -
+         ring->tail.load(std::memory_order_acquire);
+}
+
+// Producer: slot_size bytes to write the next packet into, NULL when full
+static inline uint8_t* packet_ring_acquire(PacketRing* ring) {
+  uint32_t head = ring->head.load(std::memory_order_relaxed);
+  uint32_t tail = ring->tail.load(std::memory_order_acquire);
+  if (head - tail == ring->slots) {
+    return NULL;
+  }
+  return ring->packets + (head & (ring->slots - 1)) * ring->slot_size;
+}
+
+// Producer: publish the slot returned by packet_ring_acquire
+static inline void packet_ring_commit(PacketRing* ring, size_t length) {
+  uint32_t head = ring->head.load(std::memory_order_relaxed);
+  ring->lengths[head & (ring->slots - 1)] = (uint16_t)length;
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+// Consumer: oldest committed packet and its length, or NULL when empty
+static inline const uint8_t* packet_ring_peek(PacketRing* ring,
+                                              size_t* length) {
+  uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+  uint32_t head = ring->head.load(std::memory_order_acquire);
+  if (head == tail) {
+    return NULL;
+  }
+  uint32_t slot = tail & (ring->slots - 1);
+  *length = ring->lengths[slot];
+  return ring->packets + slot * ring->slot_size;
+}
+
+// Slot number of a packet pointer, for per-slot side data
+static inline uint32_t packet_ring_index(PacketRing* ring,
+                                         const uint8_t* packet) {
+  return (uint32_t)((packet - ring->packets) / ring->slot_size);
+}
+
+// Consumer: release the packet returned by packet_ring_peek
+static inline void packet_ring_pop(PacketRing* ring) {
+  uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+  ring->tail.store(tail + 1, std::memory_order_release);
+}
+
+#endif  // RING_BUFFER_H
@@ -0,0 +1,115 @@
+#include "sched.h"
+
+#include <esp_log.h>
+#include <sdkconfig.h>
+#include <stdio.h>
+
+#include "main.h"
+#include "mem.h"
+
+static const SchedConfig configs[SCHED_TASK_COUNT] = {
+    {"audio_capture", 4096, SCHED_CAPTURE_PRIORITY, SCHED_MEDIA_CORE},
+    // Opus encodes on this stack every frame
+    {"audio_encode", 20000, SCHED_ENCODE_PRIORITY, SCHED_MEDIA_CORE},
+    // Opus decoder needs a deep stack
+    {"audio_playout", 16384, SCHED_PLAYOUT_PRIORITY, SCHED_MEDIA_CORE},
+    // app_main's task, stack set by CONFIG_ESP_MAIN_TASK_STACK_SIZE
+    {"main", 0, SCHED_NETWORK_PRIORITY, SCHED_NETWORK_CORE},
+};
+
+const SchedConfig* sched_config(SchedTask task) {
+  return &configs[task];
+}
+
+bool sched_start(SchedTask task, TaskFunction_t fn, TaskHandle_t* handle) {
+  const SchedConfig* config = &configs[task];
+  if (!mem_task_create(fn, config->name, config->stack, NULL,
+                       config->priority, handle, config->core,
+                       MEM_INTERNAL)) {
+    ESP_LOGE(LOG_TAG, "Failed to start %s", config->name);
+    return false;
+  }
+  return true;
+}
+
+void sched_adopt(SchedTask task) {
+  vTaskPrioritySet(NULL, configs[task].priority);
+}
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && !CONFIG_IDF_TARGET_LINUX
+// Run-time counter of a task at the previous dump
+typedef struct {
+  UBaseType_t number;  // xTaskNumber, never reused
+  uint32_t run_time;
+} SchedSample;
+
+static TaskStatus_t task_status[SCHED_MAX_TASKS];
+static SchedSample samples[SCHED_MAX_TASKS];
+static size_t sample_count = 0;
+static uint32_t sample_total = 0;  // Run-time clock at the previous dump
+
+static uint32_t sched_previous(UBaseType_t number) {
+  for (size_t i = 0; i < sample_count; i++) {
+    if (samples[i].number == number) {
+      return samples[i].run_time;
+    }
+  }
+  return 0;  // Task created since the previous dump
+}
+
+void sched_dump() {
+  uint32_t total = 0;
+  UBaseType_t count =
+      uxTaskGetSystemState(task_status, SCHED_MAX_TASKS, &total);
+  if (count == 0) {
+    ESP_LOGW(LOG_TAG, "CPU: more than %d tasks", SCHED_MAX_TASKS);
+    return;
+  }
+  uint32_t elapsed = total - sample_total;
+  if (elapsed == 0) {
+    return;
+  }
+
+  // Shares are of one core; a core's idle task shows what is left of it
+  uint32_t idle[portNUM_PROCESSORS] = {};
+  ESP_LOGI(LOG_TAG, "CPU over %lums:", (unsigned long)(elapsed / 1000));
+  ESP_LOGI(LOG_TAG, "%-16s %4s %4s %6s", "task", "core", "prio", "cpu");
+  for (UBaseType_t i = 0; i < count; i++) {
+    const TaskStatus_t* status = &task_status[i];
+    uint32_t delta =
+        status->ulRunTimeCounter - sched_previous(status->xTaskNumber);
+    uint32_t permille = (uint32_t)((uint64_t)delta * 1000 / elapsed);
+    char core[8] = "any";
+#if CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+    if (status->xCoreID != tskNO_AFFINITY) {
+      snprintf(core, sizeof(core), "%d", (int)status->xCoreID);
+    }
+#endif
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+      if (status->xHandle == xTaskGetIdleTaskHandleForCore(c)) {
+        idle[c] = permille;
+      }
+    }
+    ESP_LOGI(LOG_TAG, "%-16s %4s %4lu %4lu.%lu%%", status->pcTaskName, core,
+             (unsigned long)status->uxCurrentPriority,
+             (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+  }
+  for (int c = 0; c < portNUM_PROCESSORS; c++) {
+    uint32_t busy = idle[c] < 1000 ? 1000 - idle[c] : 0;
+    ESP_LOGI(LOG_TAG, "CPU: core%d busy=%lu.%lu%%", c,
+             (unsigned long)(busy / 10), (unsigned long)(busy % 10));
+  }
+
+  for (UBaseType_t i = 0; i < count; i++) {
+    samples[i].number = task_status[i].xTaskNumber;
+    samples[i].run_time = task_status[i].ulRunTimeCounter;
+  }
+  sample_count = count;
+  sample_total = total;
+}
+#else
+void sched_dump() {
+  ESP_LOGI(LOG_TAG,
+           "CPU: needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS on target");
+}
+#endif
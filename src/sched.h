@@ -0,0 +1,55 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdint.h>
+
+// Media task layout across the two cores. Capture, echo cancelling, encode
+// and playout share the media core; the WebRTC task (libpeer's sockets,
+// DTLS, SRTP and the data channel) runs on the network core next to the
+// Wi-Fi driver and lwIP. Capture hands frames to encode and encode hands
+// packets to the network task through lock-free rings, so the uplink never
+// waits on a lock held on the other core. Per-task CPU use comes from the
+// FreeRTOS run-time counters
+#ifndef SCHED_MEDIA_CORE
+#define SCHED_MEDIA_CORE 1  // Capture, encode, playout
+#endif
+#ifndef SCHED_NETWORK_CORE
+#define SCHED_NETWORK_CORE 0  // WebRTC task (CONFIG_ESP_MAIN_TASK_AFFINITY)
+#endif
+#define SCHED_CAPTURE_PRIORITY 9  // Only moves DMA frames into the ring
+#define SCHED_PLAYOUT_PRIORITY 8  // Must keep the speaker DMA fed
+#define SCHED_ENCODE_PRIORITY 7   // Longest job on the media core
+#define SCHED_NETWORK_PRIORITY 6  // Below Wi-Fi and lwIP, above boot phases
+#define SCHED_MAX_TASKS 32        // Tasks covered by the CPU report
+
+typedef enum {
+  SCHED_CAPTURE,  // I2S RX DMA into the capture ring
+  SCHED_ENCODE,   // AEC, VAD and Opus encode into the uplink ring
+  SCHED_PLAYOUT,  // Jitter buffer, Opus decode, I2S TX
+  SCHED_NETWORK,  // libpeer loop: SRTP send/receive, data channel
+  SCHED_TASK_COUNT,
+} SchedTask;
+
+typedef struct {
+  const char* name;
+  uint32_t stack;  // Bytes, 0 for a task created elsewhere
+  UBaseType_t priority;
+  int core;
+} SchedConfig;
+
+const SchedConfig* sched_config(SchedTask task);
+
+// Create task with its configured name, stack, priority and core; the
+// stack is placed in internal SRAM
+bool sched_start(SchedTask task, TaskFunction_t fn, TaskHandle_t* handle);
+
+// Give the calling task (created elsewhere, pinned by its creator) the
+// priority configured for task
+void sched_adopt(SchedTask task);
+
+// Print CPU use per task and per core since the previous call
+void sched_dump(void);
+
+#endif  // SCHED_H
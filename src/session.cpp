@@ -0,0 +1,101 @@
+#include "session.h"
+
+#include <esp_log.h>
+#include <string.h>
+
+#include "main.h"
+
+void session_init(Session* session, int64_t now_us) {
+  memset(session, 0, sizeof(*session));
+  session->state = SESSION_IDLE;
+  session->state_us = now_us;
+  session->retry_us = now_us;
+  session->backoff_ms = SESSION_BACKOFF_MIN_MS;
+}
+
+bool session_due(const Session* session, int64_t now_us) {
+  return session->state == SESSION_IDLE && now_us >= session->retry_us;
+}
+
+bool session_timed_out(const Session* session, int64_t now_us) {
+  return session->state == SESSION_CONNECTING &&
+         now_us - session->state_us > SESSION_CONNECT_TIMEOUT_MS * 1000LL;
+}
+
+void session_connecting(Session* session, int64_t now_us) {
+  session->state = SESSION_CONNECTING;
+  session->state_us = now_us;
+  session->stats.attempts++;
+}
+
+void session_connected(Session* session, int64_t now_us) {
+  session->state = SESSION_CONNECTED;
+  session->state_us = now_us;
+  session->backoff_ms = SESSION_BACKOFF_MIN_MS;
+  session->failed = 0;
+  session->stats.connects++;
+}
+
+uint32_t session_lost(Session* session, int64_t now_us) {
+  if (session->state == SESSION_CONNECTED) {
+    session->stats.drops++;
+    if (session->lost_us == 0) {
+      session->lost_us = now_us;
+    }
+  } else if (session->state == SESSION_CONNECTING) {
+    session->stats.failures++;
+    session->failed++;
+  }
+
+  uint32_t delay_ms = session->backoff_ms;
+  session->state = SESSION_IDLE;
+  session->state_us = now_us;
+  session->retry_us = now_us + delay_ms * 1000LL;
+  session->backoff_ms = delay_ms * 2 < SESSION_BACKOFF_MAX_MS
+                            ? delay_ms * 2
+                            : SESSION_BACKOFF_MAX_MS;
+  return delay_ms;
+}
+
+bool session_audio(Session* session, int64_t now_us) {
+  if (session->lost_us == 0 || session->state != SESSION_CONNECTED) {
+    return false;
+  }
+  uint32_t restore_ms = (uint32_t)((now_us - session->lost_us) / 1000);
+  session->lost_us = 0;
+  SessionStats* stats = &session->stats;
+  stats->restored++;
+  stats->last_restore_ms = restore_ms;
+  stats->total_restore_ms += restore_ms;
+  if (restore_ms > stats->max_restore_ms) {
+    stats->max_restore_ms = restore_ms;
+  }
+  return true;
+}
+
+uint32_t session_wait_ms(const Session* session, int64_t now_us) {
+  switch (session->state) {
+    case SESSION_IDLE: {
+      int64_t wait_us = session->retry_us - now_us;
+      return wait_us > 0 ? (uint32_t)((wait_us + 999) / 1000) : 0;
+    }
+    case SESSION_CONNECTING:
+    case SESSION_CONNECTED:
+    default:
+      return SESSION_POLL_MS;
+  }
+}
+
+void session_dump(const Session* session) {
+  const SessionStats* stats = &session->stats;
+  uint64_t mean_ms =
+      stats->restored > 0 ? stats->total_restore_ms / stats->restored : 0;
+  ESP_LOGI(LOG_TAG,
+           "Session: attempts=%lu connects=%lu failures=%lu drops=%lu",
+           (unsigned long)stats->attempts, (unsigned long)stats->connects,
+           (unsigned long)stats->failures, (unsigned long)stats->drops);
+  ESP_LOGI(LOG_TAG, "Session: restored=%lu last=%lums mean=%lums max=%lums",
+           (unsigned long)stats->restored,
+           (unsigned long)stats->last_restore_ms, (unsigned long)mean_ms,
+           (unsigned long)stats->max_restore_ms);
+}
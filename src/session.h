@@ -0,0 +1,79 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdint.h>
+
+// Reconnect state machine for the WebRTC session. When the PeerConnection
+// drops (or never gets connected) only the PeerConnection is torn down and
+// recreated; Wi-Fi, I2S and the Opus codecs stay up. Attempts are spaced by
+// an exponential backoff that resets once a session connects, and the time
+// from losing the session to hearing the far end again is recorded
+#define SESSION_BACKOFF_MIN_MS 250        // Delay before the first retry
+#define SESSION_BACKOFF_MAX_MS 30000      // Backoff cap
+#define SESSION_CONNECT_TIMEOUT_MS 15000  // Offer to CONNECTED, else retry
+#define SESSION_RESTART_FAILURES 20       // Failed attempts before a reboot
+
+// How long the WebRTC loop may sleep before libpeer has to be polled again.
+// libpeer keeps its sockets and timers to itself, so instead of waiting on
+// socket readiness the loop sleeps on a task notification (uplink packet or
+// outbound message) with a timeout that follows the session: short while
+// a PeerConnection exists, so the first downlink packet of a reply waits no
+// longer than under the old 15ms tick, and until the next attempt is due
+// while there is no session
+#define SESSION_POLL_MS 5  // Handshake running or connected
+
+typedef enum {
+  SESSION_IDLE,        // No PeerConnection, waiting for the next attempt
+  SESSION_CONNECTING,  // Offer sent, ICE/DTLS in progress
+  SESSION_CONNECTED,   // Media flowing
+} SessionState;
+
+// Reconnect counters
+typedef struct {
+  uint32_t attempts;          // PeerConnections created
+  uint32_t connects;          // Attempts that reached CONNECTED
+  uint32_t failures;          // Attempts that failed or timed out
+  uint32_t drops;             // Connected sessions lost
+  uint32_t restored;          // Drops followed by downlink audio again
+  uint32_t last_restore_ms;   // Loss to first audio, last recovery
+  uint32_t max_restore_ms;    // Loss to first audio, worst recovery
+  uint64_t total_restore_ms;  // Summed over all recoveries
+} SessionStats;
+
+typedef struct {
+  SessionState state;
+  int64_t state_us;     // When the current state was entered
+  int64_t retry_us;     // Earliest next attempt while idle
+  uint32_t backoff_ms;  // Delay after the next failure
+  uint32_t failed;      // Consecutive failed attempts
+  int64_t lost_us;      // When audio was lost, 0 while none is pending
+  SessionStats stats;
+} Session;
+
+// Start idle with the first attempt due at once
+void session_init(Session* session, int64_t now_us);
+
+// True when idle and the backoff has passed
+bool session_due(const Session* session, int64_t now_us);
+
+// True when an attempt has been connecting for too long
+bool session_timed_out(const Session* session, int64_t now_us);
+
+void session_connecting(Session* session, int64_t now_us);
+void session_connected(Session* session, int64_t now_us);
+
+// The PeerConnection failed, closed or timed out: go idle and schedule the
+// next attempt. Returns the delay before it in milliseconds
+uint32_t session_lost(Session* session, int64_t now_us);
+
+// Downlink audio arrived; returns true when this ends a recovery (the
+// restore time is then in stats.last_restore_ms)
+bool session_audio(Session* session, int64_t now_us);
+
+// Milliseconds the WebRTC loop may sleep before polling libpeer again
+uint32_t session_wait_ms(const Session* session, int64_t now_us);
+
+// Print the counters
+void session_dump(const Session* session);
+
+#endif  // SESSION_H
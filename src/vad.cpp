@@ -0,0 +1,78 @@
+#include "vad.h"
+
+#include <stdlib.h>
+
+// Decision thresholds, Q8 ratios against the noise floor
+#define VAD_SNR_HIGH 768       // 3.0x (~9.5 dB): speech on energy alone
+#define VAD_SNR_LOW 410        // 1.6x (~4 dB): speech if the spectrum moved
+#define VAD_TILT_DISTANCE 64   // Q8 tilt change that counts as a new source
+#define VAD_FLOOR_RISE 4       // log2 smoothing while the floor rises
+#define VAD_FLOOR_FALL 2       // log2 smoothing while the floor falls
+#define VAD_FLOOR_DRIFT 9      // log2 smoothing during speech
+#define VAD_TILT_SMOOTHING 4   // log2 smoothing of the noise tilt
+
+void vad_init(Vad* vad) {
+  vad->noise_floor = VAD_NOISE_AMPLITUDE;
+  vad->noise_tilt = 256;
+  vad->hangover = 0;
+  vad->frames = 0;
+  vad->speech = 0;
+}
+
+// Move a tracked value towards a new observation by 1/2^shift
+static int32_t smooth(int32_t tracked, int32_t value, int shift) {
+  return tracked + ((value - tracked) >> shift);
+}
+
+bool vad_process(Vad* vad, const int16_t* frame, size_t samples) {
+  int32_t level = 0;
+  int32_t change = 0;
+  int32_t previous = frame[0];
+  for (size_t i = 0; i < samples; i++) {
+    level += abs(frame[i]);
+    change += abs(frame[i] - previous);
+    previous = frame[i];
+  }
+  int32_t amplitude = level / (int32_t)samples;
+  int32_t tilt = level > 0 ? (int32_t)(((int64_t)change << 8) / level) : 0;
+
+  bool speech;
+  if (amplitude >= VAD_SPEECH_AMPLITUDE) {
+    speech = true;
+  } else if (amplitude < VAD_MIN_AMPLITUDE) {
+    speech = false;
+  } else {
+    int32_t snr = (int32_t)(((int64_t)amplitude << 8) / vad->noise_floor);
+    speech = snr >= VAD_SNR_HIGH ||
+             (snr >= VAD_SNR_LOW &&
+              abs(tilt - vad->noise_tilt) >= VAD_TILT_DISTANCE);
+  }
+
+  // Track the background: quickly down, slowly up, and only a slow upward
+  // drift while someone talks so a louder room is eventually learned
+  if (speech) {
+    if (amplitude > vad->noise_floor) {
+      vad->noise_floor +=
+          1 + ((amplitude - vad->noise_floor) >> VAD_FLOOR_DRIFT);
+    }
+  } else {
+    int shift = amplitude < vad->noise_floor ? VAD_FLOOR_FALL : VAD_FLOOR_RISE;
+    vad->noise_floor = smooth(vad->noise_floor, amplitude, shift);
+    vad->noise_tilt = smooth(vad->noise_tilt, tilt, VAD_TILT_SMOOTHING);
+  }
+  if (vad->noise_floor < VAD_MIN_AMPLITUDE) {
+    vad->noise_floor = VAD_MIN_AMPLITUDE;
+  }
+
+  vad->frames++;
+  if (speech) {
+    vad->speech++;
+    vad->hangover = VAD_HANGOVER_FRAMES;
+    return true;
+  }
+  if (vad->hangover > 0) {
+    vad->hangover--;
+    return true;
+  }
+  return false;
+}
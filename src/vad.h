@@ -0,0 +1,30 @@
+#ifndef VAD_H
+#define VAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Frame-level voice activity detector for the capture path
+// Energy: mean absolute amplitude (the INMP441/mic_test metric) against an
+// adaptive noise floor. Spectral: balance between first-difference and
+// plain amplitude, a cheap stand-in for spectral tilt, compared with the
+// tilt of the background noise so speech a few dB above a fan still counts
+#define VAD_NOISE_AMPLITUDE 500    // mic_test NOISE_THRESHOLD: initial floor
+#define VAD_SPEECH_AMPLITUDE 2000  // mic_test QUIET_THRESHOLD: always speech
+#define VAD_MIN_AMPLITUDE 40       // Below this the input is digital silence
+#define VAD_HANGOVER_FRAMES 30     // Frames kept active after speech ends
+
+typedef struct {
+  int32_t noise_floor;  // Mean absolute amplitude of the background
+  int32_t noise_tilt;   // Q8 difference/amplitude ratio of the background
+  uint32_t hangover;    // Frames left before declaring silence
+  uint32_t frames;      // Frames classified
+  uint32_t speech;      // Frames classified as speech (before hangover)
+} Vad;
+
+void vad_init(Vad* vad);
+
+// Classify one frame; true while speech is present or within the hangover
+bool vad_process(Vad* vad, const int16_t* frame, size_t samples);
+
+#endif  // VAD_H
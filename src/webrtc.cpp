@@ -1,47 +1,203 @@
-#include <driver/i2s.h>
 #include <esp_event.h>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <opus.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "boot.h"
+#include "deadline.h"
+#include "events.h"
 #include "main.h"
+#include "outbox.h"
+#include "pcm.h"
+#include "sched.h"
+#include "session.h"
 
 // External function declarations from media.cpp for audio handling
 void init_audio_encoder();
+void start_audio_capture();
+void encode_audio();
+void audio_uplink_start();
 void send_audio(PeerConnection* peer_connection);
 void audio_decode(uint8_t* data, size_t size);
 
 // External function declaration from http.cpp for fetching
-void http_request(char* offer, char* answer);
+char* http_request(char* offer);
 
 // Configuration constants
-#define LOG_DATACHANNEL_MESSAGES  // Enable logging of data channel messages
-#define TICK_INTERVAL 15          // WebRTC loop interval in milliseconds
-// Initial greeting message sent when data channel opens
-#define GREETING                                                             \
-  "{\"type\": \"response.create\", \"response\": {\"modalities\": "          \
-  "[\"audio\", \"text\"], \"instructions\": \" say 'Hello There, Im your "   \
-  "personal voice assistant, running on a ESP32-S3 embedded device,' Hello " \
-  "There, be a friendly assistant, speak english unless told "               \
-  "specifically'\"}}"
-
-// Global peer connection instance
+#define CAPTURE_STATS_INTERVAL 500  // Frames between capture stats logs (10s)
+#define SEND_STATS_INTERVAL 3000    // Frames between send stats logs (1 min)
+#define TRANSCRIPT_SIZE 512         // Assistant transcript collected per reply
+// Instructions of the greeting response requested when data channel opens
+#define GREETING                                                            \
+  " say 'Hello There, Im your personal voice assistant, running on a "      \
+  "ESP32-S3 embedded device,' Hello There, be a friendly assistant, speak " \
+  "english unless told specifically'"
+
+// Global peer connection instance, recreated for every session attempt
 PeerConnection* peer_connection = NULL;
 
-// Task configuration for audio publishing
-StaticTask_t task_buffer;
+static bool encoder_started = false;
+
+// Reconnect state, only touched by the WebRTC task (libpeer callbacks run
+// inside peer_connection_loop)
+static Session session;
+static bool session_failed = false;  // Set by callbacks, handled by the loop
+static bool channel_open = false;    // Data channel up, outbox may drain
+
+// WebRTC loop wakeups and how the time between them was spent
+typedef struct {
+  uint32_t wakes;     // Loop iterations
+  uint32_t notified;  // Woken by an uplink packet or outbound message
+  uint64_t busy_us;   // Polling libpeer and sending
+  uint64_t wait_us;   // Blocked waiting for work
+} LoopStats;
 
-// Audio publisher task - continuously sends audio data over WebRTC
-// Runs as a separate task to ensure real-time audio streaming
-void audio_publisher_task(void* user_data) {
+static LoopStats loop_stats;
+
+// Audio encode task - encode stage of the capture pipeline, on the media
+// core. Sleeps until the DMA-driven capture stage has a full frame ready and
+// leaves sending to the WebRTC task
+void audio_encode_task(void* user_data) {
   init_audio_encoder();
+  start_audio_capture();
 
+  uint32_t iterations = 0;
+  AudioSendStats last_send = {};
   while (1) {
-    send_audio(peer_connection);
-    vTaskDelay(pdMS_TO_TICKS(TICK_INTERVAL));
+    encode_audio();  // Drains capture while there is no session
+
+    // Per-minute cost of the uplink; encode time saved is estimated from
+    // the mean encode time of the frames that were encoded
+    AudioSendStats send;
+    audio_send_stats(&send);
+    if (send.frames - last_send.frames >= SEND_STATS_INTERVAL) {
+      uint32_t encoded = send.encoded - last_send.encoded;
+      uint32_t skipped = send.skipped - last_send.skipped;
+      uint64_t encode_us = send.encode_us - last_send.encode_us;
+      uint64_t saved_us = encoded > 0 ? encode_us * skipped / encoded : 0;
+      ESP_LOGI(LOG_TAG,
+               "Send/min: bytes=%lu packets=%lu dropped=%lu encoded=%lu "
+               "skipped=%lu encode=%llums saved=%llums gated=%lu "
+               "agc=%ld.%02ldx muted=%lu wakes=%lu",
+               (unsigned long)(send.bytes - last_send.bytes),
+               (unsigned long)(send.packets - last_send.packets),
+               (unsigned long)(send.dropped - last_send.dropped),
+               (unsigned long)encoded, (unsigned long)skipped,
+               (unsigned long long)(encode_us / 1000),
+               (unsigned long long)(saved_us / 1000),
+               (unsigned long)(send.gated - last_send.gated),
+               (long)(send.agc_gain / PCM_GAIN_UNITY),
+               (long)(send.agc_gain % PCM_GAIN_UNITY * 100 / PCM_GAIN_UNITY),
+               (unsigned long)(send.muted - last_send.muted),
+               (unsigned long)(send.wakes - last_send.wakes));
+      last_send = send;
+    }
+
+    if (++iterations % CAPTURE_STATS_INTERVAL == 0) {
+      AudioCaptureStats stats;
+      audio_capture_stats(&stats);
+      ESP_LOGI(LOG_TAG,
+               "Capture: frames=%lu depth=%lu overruns=%lu underruns=%lu",
+               (unsigned long)stats.frames, (unsigned long)stats.depth,
+               (unsigned long)stats.overruns, (unsigned long)stats.underruns);
+
+      AecStats aec;
+      audio_aec_stats(&aec);
+      ESP_LOGI(LOG_TAG,
+               "AEC: erle=%.1fdB delay=%lums far=%lu double_talk=%lu "
+               "rollbacks=%lu drops=%lu",
+               aec.erle_db, (unsigned long)aec.delay_ms,
+               (unsigned long)aec.far_frames, (unsigned long)aec.double_talk,
+               (unsigned long)aec.rollbacks,
+               (unsigned long)aec.reference_drops);
+
+      DeadlineStats encode;
+      deadline_stats(DEADLINE_ENCODE, &encode);
+      DeadlineStats decode;
+      deadline_stats(DEADLINE_DECODE, &decode);
+      ESP_LOGI(LOG_TAG,
+               "Deadline: encode load=%lu%% peak=%lu%% misses=%lu decode "
+               "load=%lu%% peak=%lu%% misses=%lu",
+               (unsigned long)encode.load_percent,
+               (unsigned long)encode.peak_percent,
+               (unsigned long)encode.misses,
+               (unsigned long)decode.load_percent,
+               (unsigned long)decode.peak_percent,
+               (unsigned long)decode.misses);
+    }
+  }
+}
+
+// Realtime events, handled on the WebRTC task straight from the libpeer
+// receive buffer. The assistant's transcript arrives as deltas and is
+// printed as one line when the reply's transcript is done. Speech from the
+// user while a response is in progress cancels it (barge-in)
+static char transcript[TRANSCRIPT_SIZE];
+static size_t transcript_length = 0;
+static bool responding = false;  // response.created seen, no response.done
+static EventStats event_stats;
+
+static void on_transcript_delta(const JsonSlice* fields, void* user_data) {
+  transcript_length += json_unescape(&fields[0], transcript + transcript_length,
+                                     sizeof(transcript) - transcript_length);
+}
+
+static void on_transcript_done(const JsonSlice* fields, void* user_data) {
+  ESP_LOGI(LOG_TAG, "Assistant: %s", transcript);
+  transcript_length = 0;
+  transcript[0] = '\0';
+}
+
+static void on_user_transcript(const JsonSlice* fields, void* user_data) {
+  char text[TRANSCRIPT_SIZE];
+  json_unescape(&fields[0], text, sizeof(text));
+  ESP_LOGI(LOG_TAG, "User: %s", text);
+}
+
+static void on_speech_started(const JsonSlice* fields, void* user_data) {
+  ESP_LOGI(LOG_TAG, "Speech started");
+  if (responding && outbox_response_cancel()) {
+    ESP_LOGI(LOG_TAG, "Barge-in, response cancelled");
   }
 }
 
+static void on_speech_stopped(const JsonSlice* fields, void* user_data) {
+  ESP_LOGI(LOG_TAG, "Speech stopped");
+}
+
+static void on_response_created(const JsonSlice* fields, void* user_data) {
+  responding = true;
+}
+
+static void on_response_done(const JsonSlice* fields, void* user_data) {
+  responding = false;
+  ESP_LOGI(LOG_TAG, "Response %.*s", (int)fields[0].length, fields[0].data);
+}
+
+static void on_error(const JsonSlice* fields, void* user_data) {
+  char message[128];
+  json_unescape(&fields[1], message, sizeof(message));
+  ESP_LOGE(LOG_TAG, "Realtime error %.*s: %s", (int)fields[0].length,
+           fields[0].data, message);
+}
+
+static const EventRoute event_routes[] = {
+    {"response.audio_transcript.delta", on_transcript_delta, {"delta"}},
+    {"response.audio_transcript.done", on_transcript_done, {}},
+    {"conversation.item.input_audio_transcription.completed",
+     on_user_transcript,
+     {"transcript"}},
+    {"input_audio_buffer.speech_started", on_speech_started, {}},
+    {"input_audio_buffer.speech_stopped", on_speech_stopped, {}},
+    {"response.created", on_response_created, {}},
+    {"response.done", on_response_done, {"response.status"}},
+    {"error", on_error, {"error.code", "error.message"}},
+};
+
 // Handles incoming messages on the data channel
 // msg: received message content
 // len: message length
@@ -50,8 +206,11 @@ void audio_publisher_task(void* user_data) {
 static void handle_datachannel_message(char* msg, size_t len, void* userdata,
                                        uint16_t sid) {
 #ifdef LOG_DATACHANNEL_MESSAGES
-  ESP_LOGI(LOG_TAG, "DataChannel Message: %s", msg);
+  ESP_LOGI(LOG_TAG, "DataChannel Message: %.*s", (int)len, msg);
 #endif
+  events_dispatch(event_routes,
+                  sizeof(event_routes) / sizeof(event_routes[0]), msg, len,
+                  &event_stats, NULL);
 }
 
 // Handles data channel open event
@@ -61,53 +220,74 @@ static void handle_datachannel_open(void* userdata) {
                                          0, 0, (char*)"events",
                                          (char*)"") != -1) {
     ESP_LOGI(LOG_TAG, "DataChannel created");
-    // Send initial greeting message
-    peer_connection_datachannel_send(peer_connection, (char*)GREETING,
-                                     strlen(GREETING));
+    channel_open = true;
+    // Queue the initial greeting, once per boot rather than per session
+    if (session.stats.connects == 1) {
+      outbox_response_create(GREETING);
+    }
   } else {
     ESP_LOGE(LOG_TAG, "Datachannel failed to create");
   }
 }
 
 // Handles WebRTC connection state changes
-// Restarts ESP on disconnect, starts audio task on connect
+// Flags a lost session for the loop, starts the audio uplink on connect
 static void handle_connection_state_change(PeerConnectionState state,
                                            void* user_data) {
   ESP_LOGI(LOG_TAG, "PeerConnectionState: %s",
            peer_connection_state_to_string(state));
 
   if (state == PEER_CONNECTION_DISCONNECTED ||
-      state == PEER_CONNECTION_CLOSED) {
-    esp_restart();  // Restart ESP on connection loss
+      state == PEER_CONNECTION_FAILED || state == PEER_CONNECTION_CLOSED) {
+    session_failed = true;  // Torn down by the loop, not inside libpeer
   } else if (state == PEER_CONNECTION_CONNECTED) {
-    // Create audio publisher task in PSRAM with high priority
-    StackType_t* stack_memory = (StackType_t*)heap_caps_malloc(
-        20000 * sizeof(StackType_t), MALLOC_CAP_SPIRAM);
-    xTaskCreateStaticPinnedToCore(audio_publisher_task, "audio_publisher",
-                                  20000, NULL, 7, stack_memory, &task_buffer,
-                                  0);
+    session_connected(&session, esp_timer_get_time());
+    boot_end(BOOT_CONNECT);
+    boot_begin(BOOT_FIRST_AUDIO);
+    audio_uplink_start();  // This task is woken for every encoded packet
+    if (encoder_started) {
+      return;
+    }
+    encoder_started = true;
+    sched_start(SCHED_ENCODE, audio_encode_task, NULL);
   }
 }
 
 // Handles ICE candidate events
 // Performs HTTP request for signaling and sets remote description
 static void handle_ice_candidate(char* description, void* user_data) {
-  char local_buffer[MAX_HTTP_OUTPUT_BUFFER + 1] = {0};
-  http_request(description, local_buffer);
-  peer_connection_set_remote_description(peer_connection, local_buffer);
+  char* answer = http_request(description);
+  if (answer == NULL) {
+    session_failed = true;  // Signaling failed: retry with a new offer
+    return;
+  }
+  peer_connection_set_remote_description(peer_connection, answer);
+  free(answer);
 }
 
-// Main WebRTC initialization and event loop
-void webrtc() {
+// Handles incoming audio; the first packet after a reconnect ends the
+// outage as far as the listener is concerned
+static void handle_audio_track(uint8_t* data, size_t size, void* userdata) {
+  audio_decode(data, size);
+  boot_end(BOOT_FIRST_AUDIO);  // Reports the boot timings the first time
+  if (session_audio(&session, esp_timer_get_time())) {
+    ESP_LOGI(LOG_TAG, "Session: audio restored after %lums",
+             (unsigned long)session.stats.last_restore_ms);
+  }
+}
+
+// Create a PeerConnection and send the offer; the answer comes back
+// through handle_ice_candidate. The first PeerConnection is created while
+// Wi-Fi is still associating so its DTLS key generation is off the critical
+// path
+static bool session_start() {
   // Configure WebRTC peer connection
   PeerConfiguration peer_connection_config = {
       .ice_servers = {},                   // No STUN/TURN servers needed
       .audio_codec = CODEC_OPUS,           // Using Opus for audio
       .video_codec = CODEC_NONE,           // No video support
       .datachannel = DATA_CHANNEL_STRING,  // Text-based data channel
-      .onaudiotrack = [](uint8_t* data, size_t size, void* userdata) -> void {
-        audio_decode(data, size);  // Handle incoming audio
-      },
+      .onaudiotrack = handle_audio_track,  // Handle incoming audio
       .onvideotrack = NULL,
       .on_request_keyframe = NULL,
       .user_data = NULL,
@@ -117,7 +297,7 @@ void webrtc() {
   peer_connection = peer_connection_create(&peer_connection_config);
   if (peer_connection == NULL) {
     ESP_LOGE(LOG_TAG, "peer connection failed to create");
-    esp_restart();
+    return false;
   }
 
   // Set up event handlers
@@ -126,13 +306,105 @@ void webrtc() {
   peer_connection_onicecandidate(peer_connection, handle_ice_candidate);
   peer_connection_ondatachannel(peer_connection, handle_datachannel_message,
                                 handle_datachannel_open, NULL);
+  boot_end(BOOT_PEER);
+
+  // The offer needs the network and signaling, and the answer needs the
+  // playout path; on the first session this is where boot phases join
+  boot_wait(BOOT_BIT(BOOT_AUDIO) | BOOT_BIT(BOOT_SIGNALING));
+  boot_begin(BOOT_CONNECT);
 
   // Start connection process
   peer_connection_create_offer(peer_connection);
+  return true;
+}
+
+// Destroy the PeerConnection only; Wi-Fi, I2S and the codecs stay up
+static void session_teardown() {
+  if (peer_connection != NULL) {
+    peer_connection_destroy(peer_connection);
+    peer_connection = NULL;
+  }
+  channel_open = false;
+  responding = false;
+  outbox_reset();
+  audio_session_reset();
+}
+
+void webrtc_dump() {
+  session_dump(&session);
+  ESP_LOGI(LOG_TAG,
+           "Events: messages=%lu handled=%lu unhandled=%lu malformed=%lu "
+           "bytes=%llu",
+           (unsigned long)event_stats.messages,
+           (unsigned long)event_stats.handled,
+           (unsigned long)event_stats.unhandled,
+           (unsigned long)event_stats.malformed,
+           (unsigned long long)event_stats.bytes);
+  outbox_dump();
 
-  // Main WebRTC event loop
+  LoopStats loop = loop_stats;
+  uint64_t total_us = loop.busy_us + loop.wait_us;
+  uint32_t busy = total_us > 0 ? (uint32_t)(loop.busy_us * 1000 / total_us) : 0;
+  uint64_t mean_wait_us = loop.wakes > 0 ? loop.wait_us / loop.wakes : 0;
+  ESP_LOGI(LOG_TAG,
+           "Loop: wakes=%lu notified=%lu busy=%lu.%lu%% mean_wait=%lluus",
+           (unsigned long)loop.wakes, (unsigned long)loop.notified,
+           (unsigned long)(busy / 10), (unsigned long)(busy % 10),
+           (unsigned long long)mean_wait_us);
+}
+
+// Main WebRTC loop: drives the PeerConnection and recreates it with
+// backoff whenever the session is lost. Runs on the network core and
+// sleeps until the encode stage or the outbox wakes it, or until libpeer
+// is due to be polled again (see session_wait_ms)
+void webrtc() {
+  sched_adopt(SCHED_NETWORK);
+  boot_begin(BOOT_PEER);
+  peer_init();  // Initialize WebRTC peer connection system
+  outbox_init();
+  session_init(&session, esp_timer_get_time());
+
+  int64_t woke_us = esp_timer_get_time();
   while (1) {
-    peer_connection_loop(peer_connection);
-    vTaskDelay(pdMS_TO_TICKS(TICK_INTERVAL));
+    int64_t now_us = esp_timer_get_time();
+    if (session_failed || session_timed_out(&session, now_us)) {
+      session_failed = false;
+      session_teardown();
+      uint32_t delay_ms = session_lost(&session, now_us);
+      if (session.failed >= SESSION_RESTART_FAILURES) {
+        ESP_LOGE(LOG_TAG, "Session failed %d times in a row, restarting",
+                 SESSION_RESTART_FAILURES);
+        esp_restart();  // Last resort, something below WebRTC is stuck
+      }
+      ESP_LOGW(LOG_TAG, "Session lost, reconnecting in %lums",
+               (unsigned long)delay_ms);
+    }
+    if (session_due(&session, now_us)) {
+      // The connect timeout runs from the offer, not from the boot wait
+      bool started = session_start();
+      session_connecting(&session, esp_timer_get_time());
+      if (!started) {
+        session_failed = true;
+      }
+    }
+
+    if (peer_connection != NULL) {
+      peer_connection_loop(peer_connection);
+      send_audio(peer_connection);
+      if (channel_open) {
+        outbox_drain(peer_connection);
+      }
+    }
+
+    int64_t wait_start_us = esp_timer_get_time();
+    uint32_t wait_ms =
+        session_failed ? 0 : session_wait_ms(&session, wait_start_us);
+    loop_stats.busy_us += wait_start_us - woke_us;
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms)) > 0) {
+      loop_stats.notified++;
+    }
+    woke_us = esp_timer_get_time();
+    loop_stats.wait_us += woke_us - wait_start_us;
+    loop_stats.wakes++;
   }
 }
@@ -1,15 +1,113 @@
 #include <assert.h>
 #include <esp_event.h>
 #include <esp_log.h>
+#include <esp_netif.h>
+#include <esp_timer.h>
 #include <esp_wifi.h>
+#include <nvs.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "boot.h"
 #include "main.h"
 
-// Global flag to track if we're connected to WiFi
-static bool g_wifi_connected = false;
+// Fast reconnect: the BSSID and channel of the last access point that gave
+// us an IP are kept in NVS and tried first (no scan, one channel). If that
+// attempt fails the next one scans all channels. Failed attempts back off
+// exponentially and never give up. The DHCP lease is persisted by lwIP
+// (CONFIG_LWIP_DHCP_RESTORE_LAST_IP), which re-requests the last address
+// instead of starting discovery. Set WIFI_STATIC_IP (and WIFI_GATEWAY,
+// optionally WIFI_NETMASK and WIFI_DNS) at build time to skip DHCP entirely
+#define WIFI_NVS_NAMESPACE "wifi"  // NVS namespace of the cached AP
+#define WIFI_NVS_AP "ap"           // NVS key of the cached AP
+#define WIFI_BACKOFF_MIN_MS 250    // Delay after the first failed scan
+#define WIFI_BACKOFF_MAX_MS 30000  // Backoff cap
+
+#ifdef WIFI_STATIC_IP
+#ifndef WIFI_NETMASK
+#define WIFI_NETMASK "255.255.255.0"
+#endif
+#ifndef WIFI_DNS
+#define WIFI_DNS WIFI_GATEWAY
+#endif
+#endif
+
+// Access point of the last successful connection
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t channel;
+} WifiCachedAp;
+
+// Connection state, shared by the event handler and the retry timer (the
+// timer is only armed while no attempt is in flight)
+static wifi_config_t wifi_config;
+static WifiCachedAp cached_ap;
+static bool cached_valid = false;
+static bool connected = false;
+static bool attempt_fast = false;  // Current attempt targets the cached AP
+static uint32_t attempt = 0;       // Attempts since the last connection
+static int64_t attempt_us = 0;     // Start of the current attempt
+static uint32_t backoff_ms = WIFI_BACKOFF_MIN_MS;
+static esp_timer_handle_t retry_timer = NULL;
+
+// Load the cached access point from NVS
+static void wifi_load_ap(void) {
+  nvs_handle_t handle;
+  if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+    return;
+  }
+  size_t size = sizeof(cached_ap);
+  cached_valid =
+      nvs_get_blob(handle, WIFI_NVS_AP, &cached_ap, &size) == ESP_OK &&
+      size == sizeof(cached_ap) && cached_ap.channel != 0;
+  nvs_close(handle);
+}
+
+// Remember the access point we are associated with, if it changed
+static void wifi_save_ap(void) {
+  wifi_ap_record_t record;
+  if (esp_wifi_sta_get_ap_info(&record) != ESP_OK) {
+    return;
+  }
+  WifiCachedAp ap;
+  memcpy(ap.bssid, record.bssid, sizeof(ap.bssid));
+  ap.channel = record.primary;
+  if (cached_valid && memcmp(&ap, &cached_ap, sizeof(ap)) == 0) {
+    return;
+  }
+  nvs_handle_t handle;
+  if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+    nvs_set_blob(handle, WIFI_NVS_AP, &ap, sizeof(ap));
+    nvs_commit(handle);
+    nvs_close(handle);
+  }
+  cached_ap = ap;
+  cached_valid = true;
+}
+
+// Start one connection attempt, to the cached AP if fast and known
+static void wifi_attempt(bool fast) {
+  attempt_fast = fast && cached_valid;
+  wifi_config.sta.bssid_set = attempt_fast;
+  if (attempt_fast) {
+    memcpy(wifi_config.sta.bssid, cached_ap.bssid, sizeof(cached_ap.bssid));
+    wifi_config.sta.channel = cached_ap.channel;
+    wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+  } else {
+    wifi_config.sta.channel = 0;
+    wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    wifi_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+  }
+  esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+  attempt++;
+  attempt_us = esp_timer_get_time();
+  esp_wifi_connect();
+}
+
+static void wifi_retry(void* arg) {
+  wifi_attempt(true);
+}
 
 // WiFi event handler - processes WiFi connection events and IP address
 // acquisition arg: unused context data event_base: type of event (WIFI_EVENT or
@@ -17,22 +115,43 @@ static bool g_wifi_connected = false;
 // with the event
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                                int32_t event_id, void* event_data) {
-  static int s_retry_num = 0;  // Counter for connection retry attempts
-
   // Handle WiFi disconnection events
   if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-    if (s_retry_num < 5) {  // Maximum 5 retry attempts
-      esp_wifi_connect();
-      s_retry_num++;
-      ESP_LOGI(LOG_TAG, "retry to connect to the Access Point");
+    wifi_event_sta_disconnected_t* event =
+        (wifi_event_sta_disconnected_t*)event_data;
+    if (connected) {
+      // Link lost: straight back to the same AP
+      ESP_LOGW(LOG_TAG, "Wi-Fi: link lost, reason %d", event->reason);
+      connected = false;
+      attempt = 0;
+      wifi_attempt(true);
+      return;
     }
-    ESP_LOGI(LOG_TAG, "connection to the Access Point failed");
+    ESP_LOGW(LOG_TAG, "Wi-Fi: attempt %lu (%s) failed after %lums, reason %d",
+             (unsigned long)attempt, attempt_fast ? "cached" : "scan",
+             (unsigned long)((esp_timer_get_time() - attempt_us) / 1000),
+             event->reason);
+    if (attempt_fast) {
+      wifi_attempt(false);  // AP gone or moved channel: scan now
+      return;
+    }
+    ESP_LOGI(LOG_TAG, "Wi-Fi: retrying in %lums", (unsigned long)backoff_ms);
+    esp_timer_start_once(retry_timer, backoff_ms * 1000ULL);
+    backoff_ms = backoff_ms * 2 < WIFI_BACKOFF_MAX_MS ? backoff_ms * 2
+                                                      : WIFI_BACKOFF_MAX_MS;
   }
   // Handle successful IP address acquisition
   else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
     ip_event_got_ip_t* event = (ip_event_got_ip_t*)event_data;
     ESP_LOGI(LOG_TAG, "obtained IP:" IPSTR, IP2STR(&event->ip_info.ip));
-    g_wifi_connected = true;  // Set global connection flag
+    ESP_LOGI(LOG_TAG, "Wi-Fi: connected in %lums (%s, attempt %lu)",
+             (unsigned long)((esp_timer_get_time() - attempt_us) / 1000),
+             attempt_fast ? "cached" : "scan", (unsigned long)attempt);
+    connected = true;
+    attempt = 0;
+    backoff_ms = WIFI_BACKOFF_MIN_MS;
+    wifi_save_ap();
+    boot_end(BOOT_NETWORK);  // Wake everything waiting for the network
   }
 }
 
@@ -40,29 +159,50 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
 // - Sets up WiFi in Station (STA) mode
 // - Registers event handlers for WiFi events
 // - Initializes TCP/IP stack and WiFi configuration
-// - Connects to the configured Access Point
-// - Blocks until connection is established
+// - Connects to the cached Access Point, or scans for it
+// - Returns at once; BOOT_NETWORK is signalled when an IP is obtained
 void wifi(void) {
+  boot_begin(BOOT_NETWORK);
+
   // Register event handlers for WiFi and IP events
   ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
                                              &wifi_event_handler, NULL));
   ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
                                              &wifi_event_handler, NULL));
+  esp_timer_create_args_t retry_args = {};
+  retry_args.callback = wifi_retry;
+  retry_args.name = "wifi_retry";
+  ESP_ERROR_CHECK(esp_timer_create(&retry_args, &retry_timer));
 
   // Initialize TCP/IP stack and create default WiFi station
   ESP_ERROR_CHECK(esp_netif_init());
   esp_netif_t* sta_netif = esp_netif_create_default_wifi_sta();
   assert(sta_netif);
 
-  // Initialize WiFi with default configuration
+#ifdef WIFI_STATIC_IP
+  // Fixed address: no DHCP round trips after association
+  ESP_ERROR_CHECK(esp_netif_dhcpc_stop(sta_netif));
+  esp_netif_ip_info_t ip_info = {};
+  ip_info.ip.addr = esp_ip4addr_aton(WIFI_STATIC_IP);
+  ip_info.gw.addr = esp_ip4addr_aton(WIFI_GATEWAY);
+  ip_info.netmask.addr = esp_ip4addr_aton(WIFI_NETMASK);
+  ESP_ERROR_CHECK(esp_netif_set_ip_info(sta_netif, &ip_info));
+  esp_netif_dns_info_t dns = {};
+  dns.ip.type = ESP_IPADDR_TYPE_V4;
+  dns.ip.u_addr.ip4.addr = esp_ip4addr_aton(WIFI_DNS);
+  ESP_ERROR_CHECK(esp_netif_set_dns_info(sta_netif, ESP_NETIF_DNS_MAIN, &dns));
+#endif
+
+  // Initialize WiFi with default configuration; the configuration changes
+  // per attempt, so keep it in RAM rather than rewriting flash every time
   wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
   ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+  ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
   ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));  // Set Station mode
   ESP_ERROR_CHECK(esp_wifi_start());
 
   // Configure WiFi connection parameters
   ESP_LOGI(LOG_TAG, "Connecting to WiFi SSID: %s", WIFI_SSID);
-  wifi_config_t wifi_config;
   memset(&wifi_config, 0,
          sizeof(wifi_config));  // Clear configuration structure
 
@@ -72,13 +212,7 @@ void wifi(void) {
   strncpy((char*)wifi_config.sta.password, (char*)WIFI_PASSWORD,
           sizeof(wifi_config.sta.password));
 
-  // Set WiFi configuration and initiate connection
-  ESP_ERROR_CHECK(esp_wifi_set_config(
-      static_cast<wifi_interface_t>(ESP_IF_WIFI_STA), &wifi_config));
-  ESP_ERROR_CHECK(esp_wifi_connect());
-
-  // Block until WiFi connection is established and IP is obtained
-  while (!g_wifi_connected) {
-    vTaskDelay(pdMS_TO_TICKS(200));  // 200ms delay between connection checks
-  }
+  // Initiate connection, to the cached AP when there is one
+  wifi_load_ap();
+  wifi_attempt(true);
 }